@@ -0,0 +1,111 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "AsyncLoader.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+AsyncLoader::~AsyncLoader()
+{
+    for(auto& running : _running)
+    {
+        running.first->cancelled.store(true, std::memory_order_relaxed);
+    }
+    for(auto& running : _running)
+    {
+        running.second.join();
+    }
+}
+
+void AsyncLoader::load(const std::string& filename, const LoadParameters& params)
+{
+    // the previous load is stale, stop it as soon as possible
+    if(_current)
+    {
+        _current->cancelled.store(true, std::memory_order_relaxed);
+    }
+    joinCompleted();
+
+    auto job = std::make_shared<Job>();
+    job->filename = filename;
+
+    LoadParameters jobParams = params;
+    // the callback may be called by several parsing threads, it only stores the last value
+    jobParams.progress = [rawJob = job.get()](std::size_t parsed, std::size_t total) {
+        rawJob->total.store(total, std::memory_order_relaxed);
+        auto current = rawJob->parsed.load(std::memory_order_relaxed);
+        while((parsed > current) && !rawJob->parsed.compare_exchange_weak(current, parsed, std::memory_order_relaxed))
+        {
+        }
+    };
+    // the thread holds a reference to the job, hence to its flag
+    jobParams.cancel = &job->cancelled;
+
+    std::thread worker([job, jobParams]() {
+        job->succeeded = job->model.load(job->filename, jobParams);
+        if(job->succeeded)
+        {
+            job->model.unitizeModel();
+        }
+        else if(!job->cancelled.load(std::memory_order_relaxed))
+        {
+            std::cerr << "error while opening the model " << job->filename << std::endl;
+        }
+        // publish the model to the thread calling take()
+        job->done.store(true, std::memory_order_release);
+    });
+    _running.emplace_back(job, std::move(worker));
+    _current = std::move(job);
+}
+
+bool AsyncLoader::loading() const
+{
+    return _current && !_current->done.load(std::memory_order_acquire);
+}
+
+LoadProgress AsyncLoader::progress() const
+{
+    LoadProgress p;
+    if(_current)
+    {
+        p.filename = _current->filename;
+        p.parsed = _current->parsed.load(std::memory_order_relaxed);
+        p.total = _current->total.load(std::memory_order_relaxed);
+    }
+    return p;
+}
+
+bool AsyncLoader::take(MeshModel& model)
+{
+    if(!_current || !_current->done.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // the worker has completed, the staging model can be moved without any other synchronization
+    const bool succeeded = _current->succeeded;
+    if(succeeded)
+    {
+        model = std::move(_current->model);
+    }
+    _current.reset();
+    joinCompleted();
+    return succeeded;
+}
+
+void AsyncLoader::joinCompleted()
+{
+    const auto completed = std::partition(_running.begin(), _running.end(), [](const auto& running) {
+        return !running.first->done.load(std::memory_order_acquire);
+    });
+    for(auto it = completed; it != _running.end(); ++it)
+    {
+        // the job is done, hence the thread is about to exit
+        it->second.join();
+    }
+    _running.erase(completed, _running.end());
+}
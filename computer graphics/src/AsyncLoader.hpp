@@ -0,0 +1,112 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "MeshModel.hpp"
+#include "objReader.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * The progress of a background load
+ */
+struct LoadProgress
+{
+    /// the name of the file being loaded
+    std::string filename{};
+    /// the number of bytes parsed so far
+    std::size_t parsed{0};
+    /// the size of the file, 0 if not known yet
+    std::size_t total{0};
+
+    LoadProgress() = default;
+};
+
+/**
+ * Load models in a background thread, so that the thread running the render loop is never
+ * blocked. Each model is loaded and unitized in its own staging MeshModel, that the render loop
+ * takes once it is complete. Requesting a new load cancels the previous ones: they stop at the
+ * next chunk of the file they are parsing, and their result is discarded.
+ */
+class AsyncLoader
+{
+public:
+    AsyncLoader() = default;
+
+    /**
+     * Cancel the background loads still running and wait for them to stop
+     */
+    ~AsyncLoader();
+
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    /**
+     * Start loading a model in background, it returns immediately and cancels the previous load
+     * @param[in] filename The name of the OBJ or PLY file
+     * @param[in] params The loading parameters, the progress callback and the cancel flag are replaced
+     */
+    void load(const std::string& filename, const LoadParameters& params = LoadParameters());
+
+    /**
+     * Return true if the last requested model is being loaded
+     * @return true if a load is in progress
+     */
+    [[nodiscard]] bool loading() const;
+
+    /**
+     * Return the progress of the last requested load
+     * @return the progress
+     */
+    [[nodiscard]] LoadProgress progress() const;
+
+    /**
+     * If the last requested model has been loaded, move it into the given model. It never
+     * waits for the load to complete.
+     * @param[out] model the model replaced by the loaded one
+     * @return true if the model has been replaced, false if the load is still in progress,
+     * has failed or there is nothing to take
+     */
+    bool take(MeshModel& model);
+
+private:
+    /**
+     * A background load
+     */
+    struct Job
+    {
+        /// the name of the file
+        std::string filename{};
+        /// the number of bytes parsed so far
+        std::atomic<std::size_t> parsed{0};
+        /// the size of the file
+        std::atomic<std::size_t> total{0};
+        /// set, once everything else has been written, when the load is complete
+        std::atomic<bool> done{false};
+        /// set when the load is no longer needed, to stop the parsing
+        std::atomic<bool> cancelled{false};
+        /// true if the model has been loaded successfully
+        bool succeeded{false};
+        /// the staging model
+        MeshModel model{};
+    };
+
+    /**
+     * Join the background threads whose job is complete, without waiting for the others
+     */
+    void joinCompleted();
+
+    /// the last requested job
+    std::shared_ptr<Job> _current{};
+    /// the jobs still referenced by a thread, with their thread
+    std::vector<std::pair<std::shared_ptr<Job>, std::thread>> _running{};
+};
@@ -0,0 +1,124 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "HalfEdgeMesh.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+
+/// the minimum number of half-edges paired by each thread
+constexpr std::size_t GRAIN{4096};
+
+}
+
+void HalfEdgeMesh::build(const std::vector<point3d>& vertices, const std::vector<face>& mesh, unsigned int threads)
+{
+    assert(3 * mesh.size() < INVALID);
+
+    _positions = vertices;
+    _origin.resize(3 * mesh.size());
+    parallelFor(
+        mesh.size(),
+        [&](std::size_t f) {
+            _origin[3 * f] = mesh[f].v1;
+            _origin[3 * f + 1] = mesh[f].v2;
+            _origin[3 * f + 2] = mesh[f].v3;
+        },
+        threads);
+
+    // the outgoing half-edges of each vertex are its corners, and the half-edges of each edge are
+    // known from the adjacency of the edges
+    VertexCorners corners;
+    corners.build(vertices.size(), mesh);
+    EdgeAdjacency adjacency;
+    adjacency.build(mesh, corners, 0, threads);
+    std::vector<idxtype> halfEdgesOf(adjacency.numEdges, 0);
+    for(const auto e : adjacency.index)
+    {
+        ++halfEdgesOf[e];
+    }
+
+    // a half-edge has a twin if its edge has only one other half-edge, going the other way
+    _twin.resize(_origin.size());
+    const auto numChunks = static_cast<unsigned int>(std::min<std::size_t>(threadCount(threads), std::max<std::size_t>(1, _origin.size() / GRAIN)));
+    std::vector<std::size_t> boundary(numChunks, 0);
+    std::vector<std::size_t> nonManifold(numChunks, 0);
+    parallelChunks(_origin.size(), numChunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; ++i)
+        {
+            const auto h = static_cast<idxtype>(i);
+            _twin[h] = INVALID;
+            if(_origin[h] == target(h))
+            {
+                ++nonManifold[chunk];
+                continue;
+            }
+            const auto count = halfEdgesOf[adjacency.index[h]];
+            if(count == 1)
+            {
+                ++boundary[chunk];
+                continue;
+            }
+            // the other half-edge is in another face, or else in the same (degenerate) face
+            auto other = (adjacency.first[h] == h) ? adjacency.second[h] : adjacency.first[h];
+            if(other == EdgeAdjacency::NONE)
+                other = (adjacency.index[next(h)] == adjacency.index[h]) ? next(h) : prev(h);
+            if(count == 2 && _origin[other] == target(h))
+                _twin[h] = other;
+            else
+                ++nonManifold[chunk];
+        }
+    });
+    _boundaryHalfEdges = 0;
+    _nonManifoldHalfEdges = 0;
+    for(std::size_t chunk = 0; chunk < boundary.size(); ++chunk)
+    {
+        _boundaryHalfEdges += boundary[chunk];
+        _nonManifoldHalfEdges += nonManifold[chunk];
+    }
+
+    // the first outgoing half-edge of each vertex, or the first without a twin, as the traversal of the
+    // one-ring has to start from there to visit all the faces around a boundary vertex
+    _outgoing.resize(vertices.size());
+    parallelFor(
+        vertices.size(),
+        [&](std::size_t v) {
+            _outgoing[v] = INVALID;
+            for(auto c = corners.offsets[v]; c < corners.offsets[v + 1]; ++c)
+            {
+                const auto h = static_cast<idxtype>(corners.corners[c]);
+                if(_outgoing[v] == INVALID)
+                    _outgoing[v] = h;
+                if(_twin[h] == INVALID)
+                {
+                    _outgoing[v] = h;
+                    break;
+                }
+            }
+        },
+        threads);
+}
+
+void HalfEdgeMesh::exportMesh(std::vector<point3d>& vertices, std::vector<face>& mesh, unsigned int threads) const
+{
+    vertices = _positions;
+    mesh.resize(numFaces());
+    parallelFor(
+        mesh.size(),
+        [&](std::size_t f) { mesh[f] = face(_origin[3 * f], _origin[3 * f + 1], _origin[3 * f + 2]); },
+        threads);
+}
+
+std::size_t HalfEdgeMesh::valence(idxtype v) const
+{
+    std::size_t count{0};
+    forEachNeighbor(v, [&count](idxtype) { ++count; });
+    return count;
+}
@@ -0,0 +1,226 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/**
+ * An index-based half-edge representation of a triangle mesh, stored as a structure of arrays.
+ *
+ * The three half-edges of the face f are 3f, 3f+1 and 3f+2, in the order of its vertices, hence
+ * the next and previous half-edge and the face of a half-edge are implicit and only the origin
+ * vertex and the twin of each half-edge are stored, along with one outgoing half-edge for each
+ * vertex. The half-edge from u to v and the one from v to u are twins only if they are the only
+ * half-edges between u and v: the half-edges of the boundary edges, of the non-manifold edges
+ * (shared by more than two faces or by two faces with opposite orientation) and of the degenerate
+ * edges have no twin.
+ *
+ * The one-ring of a vertex is traversed in time proportional to its valence. For a boundary vertex
+ * the outgoing half-edge is a boundary one, so that the traversal covers its whole fan of faces;
+ * a non-manifold vertex (eg the apex of two cones) is traversed only in one of its fans.
+ */
+class HalfEdgeMesh
+{
+public:
+    /// the index of a missing half-edge (eg the twin of a boundary half-edge) or vertex
+    static constexpr idxtype INVALID{std::numeric_limits<idxtype>::max( )};
+
+    HalfEdgeMesh( ) = default;
+
+    /**
+     * Build the half-edge structure of a mesh, in linear time
+     * @param[in] vertices the list of vertices
+     * @param[in] mesh the list of faces
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void build( const std::vector<point3d> &vertices, const std::vector<face> &mesh, unsigned int threads = 0 );
+
+    /**
+     * Export the mesh as a list of vertices and a list of faces, in the same order used to build it
+     * @param[out] vertices the list of vertices
+     * @param[out] mesh the list of faces
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void exportMesh( std::vector<point3d> &vertices, std::vector<face> &mesh, unsigned int threads = 0 ) const;
+
+    /**
+     * Return the number of vertices
+     * @return the number of vertices
+     */
+    [[nodiscard]] std::size_t numVertices( ) const { return _positions.size( ); }
+
+    /**
+     * Return the number of faces
+     * @return the number of faces
+     */
+    [[nodiscard]] std::size_t numFaces( ) const { return _origin.size( ) / 3; }
+
+    /**
+     * Return the number of half-edges, three per face
+     * @return the number of half-edges
+     */
+    [[nodiscard]] std::size_t numHalfEdges( ) const { return _origin.size( ); }
+
+    /**
+     * Return the number of half-edges without a twin because they lie on the boundary
+     * @return the number of boundary half-edges
+     */
+    [[nodiscard]] std::size_t numBoundaryHalfEdges( ) const { return _boundaryHalfEdges; }
+
+    /**
+     * Return the number of half-edges without a twin because their edge is not manifold or degenerate
+     * @return the number of non-manifold half-edges
+     */
+    [[nodiscard]] std::size_t numNonManifoldHalfEdges( ) const { return _nonManifoldHalfEdges; }
+
+    /**
+     * Return true if every edge is shared by at most two faces with a consistent orientation
+     * @return true if the mesh is an (edge) manifold
+     */
+    [[nodiscard]] bool isManifold( ) const { return _nonManifoldHalfEdges == 0; }
+
+    /**
+     * Return true if the mesh has no boundary edges and it is a manifold
+     * @return true if the mesh is closed
+     */
+    [[nodiscard]] bool isClosed( ) const { return isManifold( ) && _boundaryHalfEdges == 0; }
+
+    /**
+     * Return the position of a vertex
+     * @param[in] v the vertex
+     * @return the position of the vertex
+     */
+    [[nodiscard]] const point3d &position( idxtype v ) const { return _positions[v]; }
+
+    /**
+     * Return the next half-edge in the same face
+     * @param[in] h the half-edge
+     * @return the next half-edge
+     */
+    [[nodiscard]] static idxtype next( idxtype h ) { return ( h % 3 == 2 ) ? h - 2 : h + 1; }
+
+    /**
+     * Return the previous half-edge in the same face
+     * @param[in] h the half-edge
+     * @return the previous half-edge
+     */
+    [[nodiscard]] static idxtype prev( idxtype h ) { return ( h % 3 == 0 ) ? h + 2 : h - 1; }
+
+    /**
+     * Return the face containing a half-edge
+     * @param[in] h the half-edge
+     * @return the index of the face
+     */
+    [[nodiscard]] static idxtype faceOf( idxtype h ) { return h / 3; }
+
+    /**
+     * Return the opposite half-edge
+     * @param[in] h the half-edge
+     * @return the twin half-edge, INVALID if the half-edge has no twin
+     */
+    [[nodiscard]] idxtype twin( idxtype h ) const { return _twin[h]; }
+
+    /**
+     * Return the vertex a half-edge starts from
+     * @param[in] h the half-edge
+     * @return the origin vertex
+     */
+    [[nodiscard]] idxtype origin( idxtype h ) const { return _origin[h]; }
+
+    /**
+     * Return the vertex a half-edge points to
+     * @param[in] h the half-edge
+     * @return the target vertex
+     */
+    [[nodiscard]] idxtype target( idxtype h ) const { return _origin[next( h )]; }
+
+    /**
+     * Return a half-edge starting from a vertex, a boundary one for the boundary vertices
+     * @param[in] v the vertex
+     * @return the outgoing half-edge, INVALID for an isolated vertex
+     */
+    [[nodiscard]] idxtype outgoing( idxtype v ) const { return _outgoing[v]; }
+
+    /**
+     * Return true if the half-edge has no twin, ie it is on the boundary or it is not manifold
+     * @param[in] h the half-edge
+     * @return true if the half-edge has no twin
+     */
+    [[nodiscard]] bool isBoundary( idxtype h ) const { return _twin[h] == INVALID; }
+
+    /**
+     * Return true if the vertex is on the boundary (or it is isolated)
+     * @param[in] v the vertex
+     * @return true if the vertex is on the boundary
+     */
+    [[nodiscard]] bool isBoundaryVertex( idxtype v ) const
+    {
+        return ( _outgoing[v] == INVALID ) || isBoundary( _outgoing[v] );
+    }
+
+    /**
+     * Call fn(h) for each half-edge starting from the vertex v, turning around the vertex from its
+     * outgoing half-edge
+     * @param[in] v the vertex
+     * @param[in] fn the function
+     */
+    template <typename Function>
+    void forEachOutgoing( idxtype v, Function &&fn ) const
+    {
+        const auto start = _outgoing[v];
+        if ( start == INVALID )
+            return;
+        auto h = start;
+        do
+        {
+            fn( h );
+            h = _twin[prev( h )];
+        } while ( h != INVALID && h != start );
+    }
+
+    /**
+     * Call fn(u) for each vertex u adjacent to the vertex v, turning around the vertex
+     * @param[in] v the vertex
+     * @param[in] fn the function
+     */
+    template <typename Function>
+    void forEachNeighbor( idxtype v, Function &&fn ) const
+    {
+        forEachOutgoing( v, [this, &fn]( idxtype h ) {
+            fn( target( h ) );
+            // the last face of the fan of a boundary vertex adds the other end of its boundary edge
+            const auto p = prev( h );
+            if ( _twin[p] == INVALID )
+                fn( _origin[p] );
+        } );
+    }
+
+    /**
+     * Return the number of vertices adjacent to a vertex
+     * @param[in] v the vertex
+     * @return the valence of the vertex
+     */
+    [[nodiscard]] std::size_t valence( idxtype v ) const;
+
+private:
+    /// the position of each vertex
+    std::vector<point3d> _positions{};
+    /// the origin vertex of each half-edge
+    std::vector<idxtype> _origin{};
+    /// the twin of each half-edge, INVALID if it has no twin
+    std::vector<idxtype> _twin{};
+    /// an outgoing half-edge of each vertex
+    std::vector<idxtype> _outgoing{};
+    /// the number of boundary half-edges
+    std::size_t _boundaryHalfEdges{0};
+    /// the number of half-edges of the non-manifold edges
+    std::size_t _nonManifoldHalfEdges{0};
+};
@@ -0,0 +1,126 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define HAVE_MMAP 0
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        _buffer = std::move(other._buffer);
+        _data = other._mapped ? other._data : _buffer.data();
+        _size = other._size;
+        _mapped = other._mapped;
+        other._data = nullptr;
+        other._size = 0;
+        other._mapped = false;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& filename, bool useMapping)
+{
+    close();
+#if HAVE_MMAP
+    if(useMapping)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            return false;
+        }
+        struct stat st
+        {
+        };
+        if(::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        _size = static_cast<std::size_t>(st.st_size);
+        // an empty file cannot be mapped, but it is a valid (empty) content
+        if(_size == 0)
+        {
+            ::close(fd);
+            return true;
+        }
+        void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        if(addr != MAP_FAILED)
+        {
+            ::madvise(addr, _size, MADV_SEQUENTIAL);
+            _data = static_cast<const char*>(addr);
+            _mapped = true;
+            return true;
+        }
+        // fall back to the buffered read
+        _size = 0;
+    }
+#else
+    (void) useMapping;
+#endif
+    return readBuffer(filename);
+}
+
+void MappedFile::close()
+{
+#if HAVE_MMAP
+    if(_mapped)
+    {
+        ::munmap(const_cast<char*>(_data), _size);
+    }
+#endif
+    _buffer.clear();
+    _buffer.shrink_to_fit();
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+}
+
+bool MappedFile::readBuffer(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+    {
+        return false;
+    }
+    const auto size = static_cast<std::streamsize>(file.tellg());
+    file.seekg(0);
+    _buffer.resize(static_cast<std::size_t>(size));
+    if(!file.read(_buffer.data(), size))
+    {
+        _buffer.clear();
+        return false;
+    }
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return true;
+}
@@ -0,0 +1,79 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A read-only view of the whole content of a file. When the platform supports it the
+ * file is memory mapped, so that its content can be parsed in place without any copy;
+ * otherwise (or if the mapping fails) the file is read in a single buffer.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Open the file and make its content available
+     * @param[in] filename the name of the file
+     * @param[in] useMapping if true try to memory map the file, otherwise read it in a buffer
+     * @return true if everything went well, false otherwise
+     */
+    bool open(const std::string& filename, bool useMapping = true);
+
+    /**
+     * Release the mapping or the buffer
+     */
+    void close();
+
+    /**
+     * Return the content of the file
+     * @return a view on the content of the file, valid until the file is closed
+     */
+    [[nodiscard]] std::string_view view() const { return {_data, _size}; }
+
+    /**
+     * Return the size of the file in bytes
+     * @return the size of the file
+     */
+    [[nodiscard]] std::size_t size() const { return _size; }
+
+    /**
+     * Return true if the content is memory mapped, false if it has been read in a buffer
+     * @return true if the content is memory mapped
+     */
+    [[nodiscard]] bool isMapped() const { return _mapped; }
+
+private:
+    /**
+     * Read the whole file in the internal buffer
+     * @param[in] filename the name of the file
+     * @return true if everything went well, false otherwise
+     */
+    bool readBuffer(const std::string& filename);
+
+    /// the beginning of the content
+    const char* _data{nullptr};
+    /// the size of the content
+    std::size_t _size{0};
+    /// true if _data points to a memory mapping
+    bool _mapped{false};
+    /// the buffer used when the file is not mapped
+    std::vector<char> _buffer{};
+};
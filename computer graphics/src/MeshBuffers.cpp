@@ -0,0 +1,460 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "MeshBuffers.hpp"
+#include "geometry.hpp"
+#include "rendering.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+static_assert(std::is_trivially_copyable_v<point3d> && (sizeof(point3d) == 3 * sizeof(GLfloat)),
+              "the vertices must be copied as they are in the buffers");
+static_assert(std::is_trivially_copyable_v<face> && (sizeof(face) == 3 * sizeof(GLuint)),
+              "the faces must be copied as they are in the buffers");
+static_assert(sizeof(edge) == 2 * sizeof(GLuint), "the edges must be copied as they are in the buffers");
+
+#ifdef _WIN32
+// windows only provides OpenGL 1.1, the buffer objects have to be loaded at runtime
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#define GL_WRITE_ONLY 0x88B9
+#endif
+
+namespace
+{
+
+using GenBuffersProc = void(APIENTRY*)(GLsizei, GLuint*);
+using DeleteBuffersProc = void(APIENTRY*)(GLsizei, const GLuint*);
+using BindBufferProc = void(APIENTRY*)(GLenum, GLuint);
+using BufferDataProc = void(APIENTRY*)(GLenum, std::ptrdiff_t, const void*, GLenum);
+using MapBufferProc = void*(APIENTRY*)(GLenum, GLenum);
+using UnmapBufferProc = GLboolean(APIENTRY*)(GLenum);
+
+GenBuffersProc glGenBuffers{nullptr};
+DeleteBuffersProc glDeleteBuffers{nullptr};
+BindBufferProc glBindBuffer{nullptr};
+BufferDataProc glBufferData{nullptr};
+MapBufferProc glMapBuffer{nullptr};
+UnmapBufferProc glUnmapBuffer{nullptr};
+
+/**
+ * Load the functions of the buffer objects, the first time it is called
+ * @return true if all the functions are available
+ */
+bool loadBufferFunctions()
+{
+    static const bool loaded = [] {
+        glGenBuffers = reinterpret_cast<GenBuffersProc>(wglGetProcAddress("glGenBuffers"));
+        glDeleteBuffers = reinterpret_cast<DeleteBuffersProc>(wglGetProcAddress("glDeleteBuffers"));
+        glBindBuffer = reinterpret_cast<BindBufferProc>(wglGetProcAddress("glBindBuffer"));
+        glBufferData = reinterpret_cast<BufferDataProc>(wglGetProcAddress("glBufferData"));
+        glMapBuffer = reinterpret_cast<MapBufferProc>(wglGetProcAddress("glMapBuffer"));
+        glUnmapBuffer = reinterpret_cast<UnmapBufferProc>(wglGetProcAddress("glUnmapBuffer"));
+        return glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glMapBuffer && glUnmapBuffer;
+    }();
+    return loaded;
+}
+
+}  // namespace
+#else
+namespace
+{
+
+/**
+ * The functions of the buffer objects are linked directly
+ * @return true
+ */
+bool loadBufferFunctions()
+{
+    return true;
+}
+
+}  // namespace
+#endif
+
+namespace
+{
+
+/// the offset of the normal of a vertex in the vertex buffer
+constexpr std::size_t NORMAL_OFFSET{sizeof(point3d)};
+/// the distance between two vertices in the vertex buffer
+constexpr GLsizei VERTEX_STRIDE{static_cast<GLsizei>(sizeof(point3d) + sizeof(vec3d))};
+
+/**
+ * Return an offset in the bound buffer as the pointer expected by the OpenGL functions
+ * @param[in] offset the offset in bytes
+ * @return the pointer
+ */
+const void* bufferOffset(std::size_t offset)
+{
+    return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(offset));
+}
+
+/**
+ * Copy some data into a buffer object, creating it if needed
+ * @param[in] target the target to bind the buffer to
+ * @param[in,out] buffer the buffer
+ * @param[in] bytes the size of the data
+ * @param[in] data the data, if null the content of the buffer is undefined
+ */
+void fillBuffer(GLenum target, GLuint& buffer, std::size_t bytes, const void* data)
+{
+    if(buffer == 0)
+    {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(target, buffer);
+    glBufferData(target, static_cast<std::ptrdiff_t>(bytes), data, GL_STATIC_DRAW);
+    glBindBuffer(target, 0);
+}
+
+/**
+ * Fill a vertex buffer with the positions and the normals of some vertices, interleaved, creating
+ * the buffer if needed. The vertices are written in place, without any copy in main memory.
+ * @param[in,out] buffer the buffer
+ * @param[in] count the number of vertices
+ * @param[in] vertexAt the function returning the position and the normal of the i-th vertex as pointers
+ * @return true if the vertices have been written
+ */
+template <typename Function>
+bool writeVertices(GLuint& buffer, std::size_t count, Function&& vertexAt)
+{
+    fillBuffer(GL_ARRAY_BUFFER, buffer, count * static_cast<std::size_t>(VERTEX_STRIDE), nullptr);
+    if(count == 0)
+    {
+        return true;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    auto* data = static_cast<unsigned char*>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+    bool written{false};
+    if(data)
+    {
+        for(std::size_t i = 0; i < count; ++i, data += VERTEX_STRIDE)
+        {
+            const auto [position, normal] = vertexAt(i);
+            std::memcpy(data, position, sizeof(point3d));
+            std::memcpy(data + NORMAL_OFFSET, normal, sizeof(vec3d));
+        }
+        // the content is lost if the memory of the buffer has been lost meanwhile
+        written = (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return written;
+}
+
+/**
+ * Discard the pending OpenGL errors, so that the next ones can be attributed to the calls that follow
+ */
+void clearErrors()
+{
+    // the errors are at most one per kind
+    for(int i = 0; (i < 8) && (glGetError() != GL_NO_ERROR); ++i)
+    {
+    }
+}
+
+}  // namespace
+
+MeshBuffers::~MeshBuffers()
+{
+    release();
+}
+
+MeshBuffers::MeshBuffers(MeshBuffers&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MeshBuffers& MeshBuffers::operator=(MeshBuffers&& other) noexcept
+{
+    if(this != &other)
+    {
+        // once released the members are all null, hence the other buffers end up empty
+        release();
+        std::swap(_vertexBuffer, other._vertexBuffer);
+        std::swap(_indexBuffer, other._indexBuffer);
+        std::swap(_edgeBuffer, other._edgeBuffer);
+        std::swap(_flatBuffer, other._flatBuffer);
+        std::swap(_normalBuffer, other._normalBuffer);
+        std::swap(_numVertices, other._numVertices);
+        std::swap(_numIndices, other._numIndices);
+        std::swap(_numEdgeIndices, other._numEdgeIndices);
+        std::swap(_numFlatVertices, other._numFlatVertices);
+        std::swap(_numNormalPoints, other._numNormalPoints);
+        std::swap(_vertexBytes, other._vertexBytes);
+        std::swap(_indexBytes, other._indexBytes);
+        std::swap(_flatBytes, other._flatBytes);
+        std::swap(_normalBytes, other._normalBytes);
+    }
+    return *this;
+}
+
+bool MeshBuffers::supported()
+{
+    const auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int major{0};
+    int minor{0};
+    if(!version || (std::sscanf(version, "%d.%d", &major, &minor) != 2))
+    {
+        return false;
+    }
+    return ((major > 1) || ((major == 1) && (minor >= 5))) && loadBufferFunctions();
+}
+
+bool MeshBuffers::upload(const std::vector<point3d>& vertices,
+                         const std::vector<vec3d>& normals,
+                         const std::vector<face>& mesh,
+                         unsigned int threads)
+{
+    release();
+    if(mesh.empty() || vertices.empty())
+    {
+        return true;
+    }
+    if(!uploadVertices(vertices, normals) || !uploadMesh(vertices.size(), mesh, threads))
+    {
+        release();
+        return false;
+    }
+    return true;
+}
+
+bool MeshBuffers::uploadVertices(const std::vector<point3d>& vertices, const std::vector<vec3d>& normals)
+{
+    if(!empty() && (vertices.size() != _numVertices))
+    {
+        std::cerr << "The number of vertices does not match the faces in the buffer objects: " << vertices.size()
+                  << " instead of " << _numVertices << std::endl;
+        release();
+        return false;
+    }
+
+    // the vertices move, hence the flat shaded triangles and the normals are no longer valid
+    releaseFlatTriangles();
+    releaseNormalLines();
+
+    clearErrors();
+    const bool hasNormals = (normals.size() == vertices.size());
+    const vec3d none;
+    const bool written = writeVertices(_vertexBuffer, vertices.size(), [&](std::size_t i) {
+        return std::make_pair(&vertices[i], hasNormals ? &normals[i] : &none);
+    });
+    const auto error = glGetError();
+    if(!written || (error != GL_NO_ERROR))
+    {
+        std::cerr << "Unable to upload the vertices to the buffer objects, OpenGL error " << error << std::endl;
+        release();
+        return false;
+    }
+    _numVertices = vertices.size();
+    _vertexBytes = vertices.size() * static_cast<std::size_t>(VERTEX_STRIDE);
+    return true;
+}
+
+bool MeshBuffers::uploadFlatTriangles(const std::vector<point3d>& vertices,
+                                      const std::vector<face>& mesh,
+                                      const std::vector<vec3d>& faceNormals)
+{
+    releaseFlatTriangles();
+    if(faceNormals.size() != mesh.size())
+    {
+        std::cerr << "The number of normals does not match the faces: " << faceNormals.size() << " instead of "
+                  << mesh.size() << std::endl;
+        return false;
+    }
+    if(mesh.size() > static_cast<std::size_t>(std::numeric_limits<GLsizei>::max() / VERTICES_PER_TRIANGLE))
+    {
+        std::cerr << "The mesh is too large for the buffer objects: " << mesh.size() << " faces" << std::endl;
+        return false;
+    }
+
+    // the corners of each face, all with the normal of the face
+    clearErrors();
+    const auto numCorners = mesh.size() * static_cast<std::size_t>(VERTICES_PER_TRIANGLE);
+    const bool written = writeVertices(_flatBuffer, numCorners, [&](std::size_t c) {
+        const auto& f = mesh[c / 3];
+        const auto v = (c % 3 == 0) ? f.v1 : ((c % 3 == 1) ? f.v2 : f.v3);
+        return std::make_pair(&vertices[v], &faceNormals[c / 3]);
+    });
+    const auto error = glGetError();
+    if(!written || (error != GL_NO_ERROR))
+    {
+        std::cerr << "Unable to upload the flat shaded faces to the buffer objects, OpenGL error " << error << std::endl;
+        releaseFlatTriangles();
+        return false;
+    }
+    _numFlatVertices = static_cast<GLsizei>(numCorners);
+    _flatBytes = numCorners * static_cast<std::size_t>(VERTEX_STRIDE);
+    return true;
+}
+
+bool MeshBuffers::uploadMesh(std::size_t numVertices, const std::vector<face>& mesh, unsigned int threads)
+{
+    // there are at most as many edges as corners, each of them with 2 indices
+    if(mesh.size() > static_cast<std::size_t>(std::numeric_limits<GLsizei>::max() / (2 * VERTICES_PER_TRIANGLE)))
+    {
+        std::cerr << "The mesh is too large for the buffer objects: " << mesh.size() << " faces" << std::endl;
+        return false;
+    }
+
+    // the edges are only needed until they are uploaded
+    const auto edges = uniqueEdges(numVertices, mesh, threads);
+    const auto faceBytes = mesh.size() * sizeof(face);
+    const auto edgeBytes = edges.size() * sizeof(edge);
+    clearErrors();
+    fillBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer, faceBytes, mesh.data());
+    fillBuffer(GL_ELEMENT_ARRAY_BUFFER, _edgeBuffer, edgeBytes, edges.data());
+
+    const auto error = glGetError();
+    if(error != GL_NO_ERROR)
+    {
+        std::cerr << "Unable to upload the faces to the buffer objects, OpenGL error " << error << std::endl;
+        return false;
+    }
+    _numIndices = static_cast<GLsizei>(mesh.size()) * VERTICES_PER_TRIANGLE;
+    _numEdgeIndices = static_cast<GLsizei>(2 * edges.size());
+    _indexBytes = faceBytes + edgeBytes;
+    return true;
+}
+
+bool MeshBuffers::uploadNormalLines(const std::vector<point3d>& lines)
+{
+    releaseNormalLines();
+    if(lines.size() > static_cast<std::size_t>(std::numeric_limits<GLsizei>::max()))
+    {
+        std::cerr << "Too many normals for the buffer objects: " << lines.size() / 2 << std::endl;
+        return false;
+    }
+
+    clearErrors();
+    const auto bytes = lines.size() * sizeof(point3d);
+    fillBuffer(GL_ARRAY_BUFFER, _normalBuffer, bytes, lines.data());
+    const auto error = glGetError();
+    if(error != GL_NO_ERROR)
+    {
+        std::cerr << "Unable to upload the normals to the buffer objects, OpenGL error " << error << std::endl;
+        releaseNormalLines();
+        return false;
+    }
+    _numNormalPoints = static_cast<GLsizei>(lines.size());
+    _normalBytes = bytes;
+    return true;
+}
+
+void MeshBuffers::drawTriangles() const
+{
+    if(empty())
+    {
+        return;
+    }
+    bind(_vertexBuffer, _indexBuffer);
+    glDrawElements(GL_TRIANGLES, _numIndices, GL_UNSIGNED_INT, bufferOffset(0));
+    unbind();
+}
+
+void MeshBuffers::drawFlatTriangles() const
+{
+    if(!hasFlatTriangles())
+    {
+        return;
+    }
+    bind(_flatBuffer, 0);
+    glDrawArrays(GL_TRIANGLES, 0, _numFlatVertices);
+    unbind();
+}
+
+void MeshBuffers::drawEdges() const
+{
+    if(empty())
+    {
+        return;
+    }
+    bind(_vertexBuffer, _edgeBuffer);
+    glDrawElements(GL_LINES, _numEdgeIndices, GL_UNSIGNED_INT, bufferOffset(0));
+    unbind();
+}
+
+void MeshBuffers::drawNormalLines() const
+{
+    if(!hasNormalLines())
+    {
+        return;
+    }
+    // the segments have no normals
+    glBindBuffer(GL_ARRAY_BUFFER, _normalBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(COORD_PER_VERTEX, GL_FLOAT, 0, bufferOffset(0));
+    glDrawArrays(GL_LINES, 0, _numNormalPoints);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffers::release()
+{
+    releaseFlatTriangles();
+    releaseNormalLines();
+    for(auto* buffer : {&_vertexBuffer, &_indexBuffer, &_edgeBuffer})
+    {
+        if(*buffer != 0)
+        {
+            glDeleteBuffers(1, buffer);
+            *buffer = 0;
+        }
+    }
+    _numVertices = 0;
+    _numIndices = 0;
+    _numEdgeIndices = 0;
+    _vertexBytes = 0;
+    _indexBytes = 0;
+}
+
+void MeshBuffers::releaseFlatTriangles()
+{
+    if(_flatBuffer != 0)
+    {
+        glDeleteBuffers(1, &_flatBuffer);
+        _flatBuffer = 0;
+    }
+    _numFlatVertices = 0;
+    _flatBytes = 0;
+}
+
+void MeshBuffers::releaseNormalLines()
+{
+    if(_normalBuffer != 0)
+    {
+        glDeleteBuffers(1, &_normalBuffer);
+        _normalBuffer = 0;
+    }
+    _numNormalPoints = 0;
+    _normalBytes = 0;
+}
+
+void MeshBuffers::bind(GLuint vertices, GLuint indices) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vertices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(COORD_PER_VERTEX, GL_FLOAT, VERTEX_STRIDE, bufferOffset(0));
+    glNormalPointer(GL_FLOAT, VERTEX_STRIDE, bufferOffset(NORMAL_OFFSET));
+}
+
+void MeshBuffers::unbind() const
+{
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
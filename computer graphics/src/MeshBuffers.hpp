@@ -0,0 +1,199 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+#include "openglAll.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A mesh stored in the memory of the GPU: a buffer object with the vertices and their normals,
+ * interleaved, a buffer object with the 32-bit indices of the faces and one with the indices of
+ * the edges, each edge once. For flat shading, the corners of the faces can be stored as well, each
+ * with the normal of its face, in a buffer drawn without indices, and so can the segments showing
+ * the normals of the vertices. Once uploaded the mesh is drawn
+ * with a constant number of OpenGL calls, whatever its size. The vertices can be uploaded again
+ * alone, as long as the faces do not change. The buffers are OpenGL objects: they must be created, drawn and deleted by the thread
+ * owning the OpenGL context.
+ */
+class MeshBuffers
+{
+public:
+    MeshBuffers() = default;
+
+    ~MeshBuffers();
+
+    MeshBuffers(const MeshBuffers&) = delete;
+    MeshBuffers& operator=(const MeshBuffers&) = delete;
+
+    MeshBuffers(MeshBuffers&& other) noexcept;
+    MeshBuffers& operator=(MeshBuffers&& other) noexcept;
+
+    /**
+     * Return true if the current OpenGL context supports the buffer objects (OpenGL 1.5)
+     * @return true if the buffers can be used
+     */
+    [[nodiscard]] static bool supported();
+
+    /**
+     * Copy a mesh into the buffers, replacing their previous content
+     * @param[in] vertices the vertices
+     * @param[in] normals the normals of the vertices, if empty the normals are null
+     * @param[in] mesh the faces
+     * @param[in] threads the number of threads used to list the edges, 0 means as many as the hardware threads
+     * @return true if the mesh has been uploaded, false otherwise (the buffers are then empty)
+     */
+    bool upload(const std::vector<point3d>& vertices,
+                const std::vector<vec3d>& normals,
+                const std::vector<face>& mesh,
+                unsigned int threads = 0);
+
+    /**
+     * Copy new positions and normals of the vertices into the buffers, keeping the faces and the edges
+     * @param[in] vertices the vertices
+     * @param[in] normals the normals of the vertices, if empty the normals are null
+     * @return true if the vertices have been uploaded, false otherwise (the buffers are then empty)
+     */
+    bool uploadVertices(const std::vector<point3d>& vertices, const std::vector<vec3d>& normals);
+
+    /**
+     * Copy the corners of the faces into the buffers, each corner with the normal of its face, for
+     * flat shading. They are dropped as soon as the vertices change.
+     * @param[in] vertices the vertices
+     * @param[in] mesh the faces
+     * @param[in] faceNormals the normal of each face
+     * @return true if the corners have been uploaded, false otherwise
+     */
+    bool uploadFlatTriangles(const std::vector<point3d>& vertices,
+                             const std::vector<face>& mesh,
+                             const std::vector<vec3d>& faceNormals);
+
+    /**
+     * Copy the segments showing the normals into the buffers. They are dropped as soon as the vertices change.
+     * @param[in] lines the two extremities of each segment, see computeNormalLines()
+     * @return true if the segments have been uploaded, false otherwise
+     */
+    bool uploadNormalLines(const std::vector<point3d>& lines);
+
+    /**
+     * Draw the faces as triangles with the current OpenGL state
+     */
+    void drawTriangles() const;
+
+    /**
+     * Draw the faces as triangles from their corners with the normal of the face, with the current OpenGL state
+     */
+    void drawFlatTriangles() const;
+
+    /**
+     * Draw the edges of the faces, visible or not, as lines with the current OpenGL state
+     */
+    void drawEdges() const;
+
+    /**
+     * Draw the segments showing the normals as lines with the current OpenGL state
+     */
+    void drawNormalLines() const;
+
+    /**
+     * Delete the buffers
+     */
+    void release();
+
+    /**
+     * Return true if there is no mesh in the buffers
+     * @return true if nothing has been uploaded
+     */
+    [[nodiscard]] bool empty() const { return _numIndices == 0; }
+
+    /**
+     * Return true if the corners of the faces for flat shading are in the buffers
+     * @return true if drawFlatTriangles() can be used
+     */
+    [[nodiscard]] bool hasFlatTriangles() const { return _numFlatVertices > 0; }
+
+    /**
+     * Return true if the segments showing the normals are in the buffers
+     * @return true if drawNormalLines() can be used
+     */
+    [[nodiscard]] bool hasNormalLines() const { return _numNormalPoints > 0; }
+
+    /**
+     * Return the number of edges drawn by drawEdges()
+     * @return the number of edges
+     */
+    [[nodiscard]] std::size_t numEdges() const { return static_cast<std::size_t>(_numEdgeIndices / 2); }
+
+    /**
+     * Return the size of the buffers
+     * @return the number of bytes stored in the memory of the GPU
+     */
+    [[nodiscard]] std::size_t bytes() const { return _vertexBytes + _indexBytes + _flatBytes + _normalBytes; }
+
+private:
+    /**
+     * Copy the faces and their edges into the buffers
+     * @param[in] numVertices the number of vertices
+     * @param[in] mesh the faces
+     * @param[in] threads the number of threads used to list the edges
+     * @return true if the faces have been uploaded
+     */
+    bool uploadMesh(std::size_t numVertices, const std::vector<face>& mesh, unsigned int threads);
+
+    /**
+     * Delete the buffer of the corners of the faces
+     */
+    void releaseFlatTriangles();
+
+    /**
+     * Delete the buffer of the segments showing the normals
+     */
+    void releaseNormalLines();
+
+    /**
+     * Bind the buffers and set the vertex and normal arrays to them
+     * @param[in] vertices the buffer of the vertices to draw
+     * @param[in] indices the buffer of the indices to draw, 0 for none
+     */
+    void bind(GLuint vertices, GLuint indices) const;
+
+    /**
+     * Unbind the buffers and disable the arrays
+     */
+    void unbind() const;
+
+    /// the buffer with the interleaved vertices and normals
+    GLuint _vertexBuffer{0};
+    /// the buffer with the indices of the faces
+    GLuint _indexBuffer{0};
+    /// the buffer with the indices of the edges, two per edge
+    GLuint _edgeBuffer{0};
+    /// the buffer with the corners of the faces and the normals of the faces, interleaved
+    GLuint _flatBuffer{0};
+    /// the buffer with the extremities of the segments showing the normals
+    GLuint _normalBuffer{0};
+    /// the number of vertices in the vertex buffer
+    std::size_t _numVertices{0};
+    /// the number of indices of the faces
+    GLsizei _numIndices{0};
+    /// the number of indices of the edges
+    GLsizei _numEdgeIndices{0};
+    /// the number of corners in the flat shading buffer
+    GLsizei _numFlatVertices{0};
+    /// the number of extremities of the segments showing the normals
+    GLsizei _numNormalPoints{0};
+    /// the size of the vertex buffer
+    std::size_t _vertexBytes{0};
+    /// the size of the buffers of the indices
+    std::size_t _indexBytes{0};
+    /// the size of the flat shading buffer
+    std::size_t _flatBytes{0};
+    /// the size of the buffer of the segments showing the normals
+    std::size_t _normalBytes{0};
+};
@@ -7,146 +7,113 @@
 #include "geometry.hpp"
 #include "loop.hpp"
 #include "MeshModel.hpp"
-#include "objReader.hpp"
-#include <cassert>
-#include <cmath>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <string>
+#include <functional>
+#include <memory>
 #include <vector>
 
-bool MeshModel::load(const std::string& filename)
-{
-    return ::load(filename, _vertices, _mesh, _normals, _bb);
-}
-
-
 /**
 * Render the model according to the provided parameters
 * @param params The rendering parameters
 */
 void MeshModel::render( const RenderingParameters &params )
 {
-    // if we need to draw the original model
-    if ( !params.subdivision )
+    const auto level = displayedLevel( params );
+    const auto& vertices = level ? level->vertices : _vertices;
+    const auto& mesh = level ? level->mesh : _mesh;
+    const auto& normals = level ? level->normals : _normals;
+    // the flat shading needs the normals of the faces, computed once for each mesh
+    const bool flat = params.solid && !params.smooth;
+    const bool buffered = params.useBufferObjects && updateBuffers( level, flat );
+    if ( buffered )
     {
-        // draw it
-        draw( _vertices, _mesh, _normals, params );
-        // draw the normals
-        if ( params.normals )
+        if ( flat && !_buffers.hasFlatTriangles( ) )
+        {
+            draw( _buffers, vertices, mesh, normals, params, faceNormals( level ) );
+        }
+        else
         {
-            drawNormals( _vertices, _normals );
+            draw( _buffers, vertices, mesh, normals, params );
         }
     }
+    else if ( flat )
+    {
+        draw( vertices, mesh, normals, params, faceNormals( level ) );
+    }
     else
     {
-        PRINTVAR(params.subdivLevel);
-        PRINTVAR(_currentSubdivLevel);
-        // before drawing check the current level of subdivision and the required one
-        if ( ( _currentSubdivLevel == 0 ) || ( _currentSubdivLevel != params.subdivLevel ) )
+        draw( vertices, mesh, normals, params );
+    }
+    // draw the normals, the segments are computed once for each mesh
+    if ( params.normals )
+    {
+        if ( buffered && updateNormalLines( level, params ) )
         {
-            // if they are different apply the missing steps: either restart from the beginning
-            // if the required level is less than the current one or apply the missing
-            // steps starting from the current one
-            std::vector<point3d> tmpVert;        //!< a temporary list of vertices used in the iterations
-            std::vector<face> tmpMesh;           //!< a temporary mesh used in the iterations
-
-            if(( _currentSubdivLevel == 0 ) || ( _currentSubdivLevel > params.subdivLevel ) )
-            {
-                // start from the beginning
-                _currentSubdivLevel = 0;
-                tmpVert = _vertices;
-                tmpMesh = _mesh;
-            }
-            else
-            {
-                // start from the current level
-                tmpVert = _subVert;
-                tmpMesh = _subMesh;
-            }
-
-            // apply the proper subdivision iterations
-            for( ; _currentSubdivLevel < params.subdivLevel; ++_currentSubdivLevel)
-            {
-                std::cerr << "[Loop subdivision] iteration " << _currentSubdivLevel << std::endl;
-                loopSubdivision( tmpVert, tmpMesh, _subVert, _subMesh, _subNorm );
-                // swap unless it's the last iteration
-                if( _currentSubdivLevel < ( params.subdivLevel - 1) )
-                {
-                    tmpVert = _subVert;
-                    tmpMesh = _subMesh;
-                }
-            }
+            drawNormalLines( _buffers );
         }
-
-        draw( _subVert, _subMesh, _subNorm, params );
-        if ( params.normals )
+        else
         {
-            drawNormals( _subVert, _subNorm );
+            drawNormalLines( normalLines( level, params ) );
         }
     }
 }
 
-/**
- * It scales the model to unitary size by translating it to the origin and
- * scaling it to fit in a unit cube around the origin.
- *
- * @return the scale factor used to transform the model
- */
-float MeshModel::unitizeModel( )
+bool MeshModel::updateBuffers( const std::shared_ptr<const SubdivisionLevel>& level, bool flat )
 {
-    if ( _vertices.empty( ) || _mesh.empty( ) )
+    const auto& vertices = level ? level->vertices : _vertices;
+    const auto& normals = level ? level->normals : _normals;
+    if ( ( _buffersMeshRevision != _meshRevision ) || ( _buffersLevel != level ) )
     {
-        return .0f;
+        // if the upload fails the buffers remain empty and the model is drawn without them until it changes
+        if ( MeshBuffers::supported( ) )
+        {
+            _buffers.upload( vertices, normals, level ? level->mesh : _mesh );
+        }
+        else
+        {
+            _buffers.release( );
+        }
+        _buffersLevel = level;
+        _buffersMeshRevision = _meshRevision;
+        _buffersVerticesRevision = _verticesRevision;
+        _buffersFlatValid = false;
+        _buffersNormalsValid = false;
     }
-
-    //****************************************
-    // calculate model width, height, and
-    // depth using the bounding box
-    //****************************************
-    const float w = std::fabs( _bb.pmax.x - _bb.pmin.x );
-    const float h = std::fabs( _bb.pmax.y - _bb.pmin.y );
-    const float d = std::fabs( _bb.pmax.z - _bb.pmin.z );
-
-    std::cout << "size: w: " << w << " h " << h << " d " << d << std::endl;
-    //****************************************
-    // calculate center of the bounding box of the model
-    //****************************************
-    const point3d c = (_bb.pmax + _bb.pmin) * 0.5;
-
-    //****************************************
-    // calculate the unitizing scale factor as the
-    // maximum of the 3 dimensions
-    //****************************************
-    const auto scale = 2.f / std::max(std::max(w, h), d);
-
-    std::cout << "scale: " << scale << " cx " << c.x << " cy " << c.y << " cz " << c.z << std::endl;
-
-    // translate each vertex wrt to the center and then apply the scaling to the coordinate
-    for(auto& v : _vertices)
+    else if ( _buffersVerticesRevision != _verticesRevision )
     {
-        //****************************************
-        // translate the vertex
-        //****************************************
-        v.translate( -c.x, -c.y, -c.z );
-
-        //****************************************
-        // apply the scaling
-        //****************************************
-        v.scale( scale );
+        // the faces, hence the edges, are the same
+        if ( !_buffers.empty( ) )
+        {
+            _buffers.uploadVertices( vertices, normals );
+        }
+        _buffersVerticesRevision = _verticesRevision;
+        _buffersFlatValid = false;
+        _buffersNormalsValid = false;
     }
 
-    //****************************************
-    // update the bounding box, ie translate and scale the 6 coordinates
-    //****************************************
-    _bb.pmax = (_bb.pmax - c) * scale;
-    _bb.pmin = (_bb.pmin - c) * scale;
-
-
-    std::cout << "New bounding box : pmax=" << _bb.pmax << "  pmin=" << _bb.pmin << std::endl;
+    // the flat shaded triangles are uploaded the first time they are drawn
+    if ( flat && !_buffersFlatValid && !_buffers.empty( ) )
+    {
+        _buffers.uploadFlatTriangles( vertices, level ? level->mesh : _mesh, faceNormals( level ) );
+        _buffersFlatValid = true;
+    }
+    return !_buffers.empty( );
+}
 
-    return scale;
+bool MeshModel::updateNormalLines( const std::shared_ptr<const SubdivisionLevel>& level, const RenderingParameters& params )
+{
+    if ( !_buffersNormalsValid || !std::equal_to<float>( )( _buffersNormalLength, params.normalLength )
+         || ( _buffersNormalStride != params.normalStride ) )
+    {
+        // the segments are only kept in the buffers
+        std::vector<point3d> lines;
+        computeNormalLines( level ? level->vertices : _vertices, level ? level->normals : _normals, params.normalLength,
+                            params.normalStride, lines );
+        _buffers.uploadNormalLines( lines );
+        _buffersNormalLength = params.normalLength;
+        _buffersNormalStride = params.normalStride;
+        _buffersNormalsValid = true;
+    }
+    return _buffers.hasNormalLines( );
 }
 
 
@@ -156,17 +123,19 @@ float MeshModel::unitizeModel( )
 
 // to be deprecated
 
-void MeshModel::flatDraw( ) const
+void MeshModel::flatDraw( )
 {
     glShadeModel( GL_SMOOTH );
 
+    // the normals of the triangles, computed once
+    const auto& normals = faceNormals( nullptr );
+
     // for each triangle draw the vertices and the normals
-    for(const auto &face : _mesh)
+    for(std::size_t i = 0; i < _mesh.size( ); ++i)
     {
+        const auto& face = _mesh[i];
         glBegin( GL_TRIANGLES );
-        //compute the normal of the triangle
-        const vec3d n = computeNormal( _vertices[face.v1], _vertices[face.v2], _vertices[face.v3]);
-        glNormal3fv( (float*) &n );
+        glNormal3fv( (float*) &normals[i] );
 
         glVertex3fv( (float*) &_vertices[face.v1] );
 
@@ -234,9 +203,13 @@ void MeshModel::indexDraw( ) const
 // to be deprecated
 void MeshModel::drawSubdivision( )
 {
-    if ( _subMesh.empty( ) || _subNorm.empty( ) || _subVert.empty( ) )
+    auto sub = _subdivisionCache.find( 1 );
+    if ( !sub )
     {
-        loopSubdivision( _vertices, _mesh, _subVert, _subMesh, _subNorm );
+        auto level = std::make_shared<SubdivisionLevel>( );
+        loopSubdivision( _vertices, _mesh, level->vertices, level->mesh, level->normals );
+        _subdivisionCache.insert( 1, level );
+        sub = std::move( level );
     }
 
     glShadeModel( GL_SMOOTH );
@@ -244,14 +217,14 @@ void MeshModel::drawSubdivision( )
     glEnableClientState( GL_NORMAL_ARRAY );
     glEnableClientState( GL_VERTEX_ARRAY );
 
-    glNormalPointer( GL_FLOAT, 0, (float*) &_subNorm[0] );
-    glVertexPointer( COORD_PER_VERTEX, GL_FLOAT, 0, (float*) &_subVert[0] );
+    glNormalPointer( GL_FLOAT, 0, (float*) &sub->normals[0] );
+    glVertexPointer( COORD_PER_VERTEX, GL_FLOAT, 0, (float*) &sub->vertices[0] );
 
-    glDrawElements( GL_TRIANGLES, static_cast<GLsizei>(_subMesh.size( )) * VERTICES_PER_TRIANGLE, GL_UNSIGNED_SHORT, (idxtype*) & _subMesh[0] );
+    glDrawElements( GL_TRIANGLES, static_cast<GLsizei>(sub->mesh.size( )) * VERTICES_PER_TRIANGLE, GL_UNSIGNED_SHORT, (idxtype*) & sub->mesh[0] );
 
 
     glDisableClientState( GL_VERTEX_ARRAY ); // disable vertex arrays
     glDisableClientState( GL_NORMAL_ARRAY );
 
-    ::drawWireframe( _subVert, _subMesh, RenderingParameters( ) );
+    ::drawWireframe( sub->vertices, sub->mesh, RenderingParameters( ) );
 }
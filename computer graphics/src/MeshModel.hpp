@@ -7,52 +7,39 @@
 
 #pragma once
 
-#include "core.hpp"
-#include "objReader.hpp"
+#include "MeshBuffers.hpp"
+#include "Model.hpp"
 #include "rendering.hpp"
 
-#include <cmath>
-#include <optional>
-#include <ostream>
-#include <string>
-#include <vector>
+#include <cstddef>
+#include <memory>
 
 /**
- * The class containing and managing the 3D model 
+ * The class containing and managing the 3D model, drawn with OpenGL
  */
-class MeshModel
+class MeshModel : public Model
 {
 private:
-    /// Stores the vertex indices for the triangles
-    std::vector<face> _mesh{};
-    /// Stores the vertices
-    std::vector<point3d> _vertices{};
-    /// Stores the normals for the triangles
-    std::vector<vec3d> _normals{};
-
-    // Subdivision
-    /// Stores the vertex indices for the triangles
-    std::vector<face> _subMesh{};
-    /// Stores the vertices
-    std::vector<point3d> _subVert{};
-    /// Stores the normals for the triangles
-    std::vector<vec3d> _subNorm{};
-
-    /// the current bounding box of the model
-    BoundingBox _bb{};
-
-    /// the current subdivision level
-    unsigned short _currentSubdivLevel{};   
+    // Buffer objects
+    /// the mesh being displayed, in the memory of the GPU
+    MeshBuffers _buffers{};
+    /// the subdivision level in the buffers, none for the original model
+    std::shared_ptr<const SubdivisionLevel> _buffersLevel{};
+    /// the revision of the faces of _buffersLevel in the buffers, along with their edges, 0 for none
+    std::size_t _buffersMeshRevision{0};
+    /// the revision of the vertices of _buffersLevel in the buffers, 0 for none
+    std::size_t _buffersVerticesRevision{0};
+    /// true if the flat shaded triangles have been uploaded for the current vertices, or could not be
+    bool _buffersFlatValid{false};
+    /// true if the segments showing the normals have been uploaded for the current vertices, or could not be
+    bool _buffersNormalsValid{false};
+    /// the length of the segments showing the normals in the buffers
+    float _buffersNormalLength{};
+    /// the stride of the segments showing the normals in the buffers
+    std::size_t _buffersNormalStride{};
 
 public:
-  MeshModel() = default;
-
-    /**
-     * Load the OBJ data from file
-      * @param[in] filename The name of the OBJ file
-      * @return true if everything went well, false otherwise
-     */
-    bool load(const std::string& filename);
+    MeshModel() = default;
 
     /**
      * Render the model according to the provided parameters
@@ -60,22 +47,28 @@ public:
      */
     void render(const RenderingParameters &params = RenderingParameters());
 
-
+private:
     /**
-     * It scales the model to unitary size by translating it to the origin and
-     * scaling it to fit in a unit cube around the origin.
-     *
-     * @return the scale factor used to transform the model
+     * Upload the mesh to display to the buffer objects, unless it is already there
+     * @param[in] level the subdivision level to display, none for the original model
+     * @param[in] flat true if the faces are drawn with flat shading, their corners are uploaded as well
+     * @return true if the mesh can be drawn from the buffers, false if they are not supported
      */
-    float unitizeModel();
-
+    bool updateBuffers(const std::shared_ptr<const SubdivisionLevel>& level, bool flat);
 
-private:
+    /**
+     * Upload the segments showing the normals of the mesh to display to the buffer objects, unless they
+     * are already there; the mesh must be in the buffers
+     * @param[in] level the subdivision level to display, none for the original model
+     * @param[in] params the rendering parameters, with the length and the stride of the segments
+     * @return true if the segments can be drawn from the buffers
+     */
+    bool updateNormalLines(const std::shared_ptr<const SubdivisionLevel>& level, const RenderingParameters& params);
 
     /////////////////////////////
     // DEPRECATED METHODS
     [[deprecated]] void drawSubdivision();
     [[deprecated]] void indexDraw() const;
-    [[deprecated]] void flatDraw() const;
+    [[deprecated]] void flatDraw();
     [[deprecated]] void drawWireframe() const;
 };
\ No newline at end of file
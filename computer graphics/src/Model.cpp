@@ -0,0 +1,348 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "Model.hpp"
+#include "geometry.hpp"
+#include "loop.hpp"
+#include "meshCache.hpp"
+#include "objReader.hpp"
+#include "ScratchArena.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "weld.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool Model::load(const std::string& filename, const LoadParameters& params)
+{
+    // start from an empty model
+    _vertices.clear( );
+    _mesh.clear( );
+    _normals.clear( );
+    _texcoords.clear( );
+    resetSubdivision( );
+    _bb = BoundingBox( );
+    // the data drawn are computed again by the next rendering, the model may be loaded in another thread
+    ++_meshRevision;
+    ++_verticesRevision;
+    _faceNormals.clear( );
+    _faceNormalsValid = false;
+    _normalLines.clear( );
+    _normalLinesValid = false;
+    _edges.clear( );
+    _edgesValid = false;
+
+    // the binary cache, if valid, contains the model already parsed along its normals
+    if ( params.useCache && loadMeshCache( filename, _vertices, _mesh, _normals, _texcoords, _bb, params ) )
+    {
+        return true;
+    }
+
+    LoadStatistics stats;
+    const bool loaded = isPlyFile( filename ) ? loadPly( filename, _vertices, _mesh, _normals, _texcoords, _bb, stats, params )
+                                              : ::load( filename, _vertices, _mesh, _normals, _texcoords, _bb, stats, params );
+    if ( !loaded )
+    {
+        return false;
+    }
+
+    if ( params.weld )
+    {
+        // the epsilon is relative to the size of the model
+        const auto diagonal = ( _bb.pmax - _bb.pmin ).norm( );
+        const auto weld = weldVertices( _vertices, _mesh, params.weldEpsilon * diagonal, params.threads );
+        std::cerr << "Welded " << weld.mergedVertices << " vertices, removed " << weld.removedFaces << " degenerate faces" << std::endl;
+        if ( weld.mergedVertices > 0 )
+        {
+            // the texture coordinates of the merged vertices may differ, they are no longer meaningful
+            _texcoords.clear( );
+            computeVertexNormals( _vertices, _mesh, _normals, params.threads );
+        }
+    }
+
+    if ( params.useCache )
+    {
+        // not being able to write the cache is not an error, the model will be parsed again next time
+        saveMeshCache( filename, _vertices, _mesh, _normals, _texcoords, _bb, params );
+    }
+    return true;
+}
+
+void Model::rasterize( SoftwareRasterizer &rasterizer, const RenderingParameters &params )
+{
+    const auto level = displayedLevel( params );
+    const auto& vertices = level ? level->vertices : _vertices;
+    const auto& mesh = level ? level->mesh : _mesh;
+    const auto& normals = level ? level->normals : _normals;
+    // the normals of the faces and the edges are computed once for each mesh, as for the buffers
+    static const std::vector<vec3d> noFaceNormals;
+    static const std::vector<edge> noEdges;
+    rasterizer.draw( vertices, mesh, normals, params, ( params.solid && !params.smooth ) ? faceNormals( level ) : noFaceNormals,
+                     params.wireframe ? edges( level ) : noEdges );
+    if ( params.normals )
+    {
+        rasterizer.drawNormalLines( normalLines( level, params ) );
+    }
+}
+
+std::shared_ptr<const SubdivisionLevel> Model::displayedLevel( const RenderingParameters &params )
+{
+    // the subdivision level to draw, if any, otherwise the original model is drawn
+    if ( !params.subdivision )
+    {
+        return nullptr;
+    }
+    // before drawing check the current level of subdivision and the required one, this never
+    // waits for the subdivision: the best level available is drawn meanwhile
+    _subdivisionCache.setBudget( params.subdivisionBudget );
+    updateSubdivision( params.subdivLevel );
+    return _subdivided;
+}
+
+const std::vector<point3d>& Model::normalLines( const std::shared_ptr<const SubdivisionLevel>& level,
+                                                    const RenderingParameters& params )
+{
+    if ( !_normalLinesValid || ( _normalLinesLevel != level ) || !std::equal_to<float>( )( _normalLinesLength, params.normalLength )
+         || ( _normalLinesStride != params.normalStride ) )
+    {
+        computeNormalLines( level ? level->vertices : _vertices, level ? level->normals : _normals, params.normalLength,
+                            params.normalStride, _normalLines );
+        _normalLinesLevel = level;
+        _normalLinesLength = params.normalLength;
+        _normalLinesStride = params.normalStride;
+        _normalLinesValid = true;
+    }
+    return _normalLines;
+}
+
+const std::vector<vec3d>& Model::faceNormals( const std::shared_ptr<const SubdivisionLevel>& level )
+{
+    if ( !_faceNormalsValid || ( _faceNormalsLevel != level ) )
+    {
+        const auto& vertices = level ? level->vertices : _vertices;
+        const auto& mesh = level ? level->mesh : _mesh;
+        computeFaceNormals( vertices, mesh, _faceNormals );
+        _faceNormalsLevel = level;
+        _faceNormalsValid = true;
+    }
+    return _faceNormals;
+}
+
+const std::vector<edge>& Model::edges( const std::shared_ptr<const SubdivisionLevel>& level )
+{
+    if ( !_edgesValid || ( _edgesLevel != level ) )
+    {
+        const auto& vertices = level ? level->vertices : _vertices;
+        _edges = uniqueEdges( vertices.size( ), level ? level->mesh : _mesh );
+        _edgesLevel = level;
+        _edgesValid = true;
+    }
+    return _edges;
+}
+
+void Model::updateSubdivision( unsigned short level )
+{
+    // swap in the levels completed in background as soon as they get closer to the requested one
+    if ( _subdivider )
+    {
+        for ( auto& [completed, data] : _subdivider->take( ) )
+        {
+            _subdivisionCache.insert( completed, data );
+            if ( ( completed <= _requestedSubdivLevel ) && ( completed > _currentSubdivLevel ) )
+            {
+                _subdivided = data;
+                _currentSubdivLevel = completed;
+            }
+        }
+    }
+
+    if ( level == _requestedSubdivLevel )
+    {
+        return;
+    }
+    _requestedSubdivLevel = level;
+    if ( _subdivider )
+    {
+        // the previous request, if still running, is stale
+        _subdivider->cancel( );
+    }
+
+    // level 0 is the original model
+    auto hit = ( level > 0 ) ? _subdivisionCache.find( level ) : nullptr;
+    if ( hit || ( level == 0 ) )
+    {
+        _subdivided = std::move( hit );
+        _currentSubdivLevel = level;
+        return;
+    }
+
+    // display the closest level available: either a level in the cache, the one currently
+    // displayed (which may have been evicted) or the original model
+    unsigned short from{0};
+    auto start = _subdivisionCache.closestBelow( level, from );
+    if ( _subdivided && ( _currentSubdivLevel < level ) && ( _currentSubdivLevel > from ) )
+    {
+        from = _currentSubdivLevel;
+        start = _subdivided;
+    }
+    _subdivided = start;
+    _currentSubdivLevel = from;
+
+    // and compute the missing levels from there
+    if ( !start )
+    {
+        if ( !_subdivisionBase )
+        {
+            // the worker cannot read the model, which may change meanwhile: it gets its own copy,
+            // shared by all the requests until the model changes
+            auto original = std::make_shared<SubdivisionLevel>( );
+            original->vertices = _vertices;
+            original->mesh = _mesh;
+            _subdivisionBase = std::move( original );
+        }
+        start = _subdivisionBase;
+    }
+    if ( !_subdivider )
+    {
+        _subdivider = std::make_unique<SubdivisionWorker>( );
+    }
+    // a level too large for the cache is computed at once, patch by patch: the intermediate levels
+    // would fill the cache for nothing, and the peak memory is about the size of the level
+    const auto levels = static_cast<unsigned short>( level - from );
+    const bool direct = ( levels > 1 ) && ( start->subdividedBytes( levels ) > _subdivisionCache.budget( ) );
+    _subdivider->request( level, from, std::move( start ), 0, direct );
+}
+
+void Model::waitSubdivision( )
+{
+    if ( _subdivider )
+    {
+        _subdivider->wait( );
+        // swap in the levels completed
+        updateSubdivision( _requestedSubdivLevel );
+    }
+}
+
+void Model::resetSubdivision( )
+{
+    if ( _subdivider )
+    {
+        _subdivider->cancel( );
+    }
+    _subdivisionCache.clear( );
+    _subdivided.reset( );
+    _subdivisionBase.reset( );
+    _currentSubdivLevel = 0;
+    _requestedSubdivLevel = 0;
+}
+
+void Model::moveSubdivision( )
+{
+    // the level being computed starts from the old vertices
+    if ( _subdivider )
+    {
+        _subdivider->cancel( );
+    }
+    _subdivisionBase.reset( );
+
+    // each level follows the level below, which is updated first: the stencils giving a level from
+    // the faces of the level below are built only now, and forgotten once applied
+    unsigned short belowLevel{0};
+    std::shared_ptr<const SubdivisionLevel> below;
+    ScratchArena scratch;
+    _subdivisionCache.update( [&]( unsigned short level, const std::shared_ptr<const SubdivisionLevel>& ) {
+        std::shared_ptr<const SubdivisionLevel> moved;
+        if ( ( level == 1 ) || ( below && ( belowLevel + 1 == level ) ) )
+        {
+            const auto& belowVertices = ( level == 1 ) ? _vertices : below->vertices;
+            scratch.reset( );
+            LoopStencils stencils;
+            stencils.build( belowVertices.size( ), ( level == 1 ) ? _mesh : below->mesh, 1, 0, &scratch );
+            auto updated = std::make_shared<SubdivisionLevel>( );
+            stencils.apply( belowVertices, updated->vertices );
+            updated->mesh = stencils.takeMesh( );
+            computeVertexNormals( updated->vertices, updated->mesh, updated->normals, 0, &scratch );
+            moved = std::move( updated );
+        }
+        below = moved;
+        belowLevel = level;
+        return moved;
+    } );
+
+    // the level to display is looked up again
+    _subdivided.reset( );
+    _currentSubdivLevel = 0;
+    _requestedSubdivLevel = 0;
+}
+
+/**
+ * It scales the model to unitary size by translating it to the origin and
+ * scaling it to fit in a unit cube around the origin.
+ *
+ * @return the scale factor used to transform the model
+ */
+float Model::unitizeModel( )
+{
+    if ( _vertices.empty( ) || _mesh.empty( ) )
+    {
+        return .0f;
+    }
+
+    //****************************************
+    // calculate model width, height, and
+    // depth using the bounding box
+    //****************************************
+    const float w = std::fabs( _bb.pmax.x - _bb.pmin.x );
+    const float h = std::fabs( _bb.pmax.y - _bb.pmin.y );
+    const float d = std::fabs( _bb.pmax.z - _bb.pmin.z );
+
+    std::cout << "size: w: " << w << " h " << h << " d " << d << std::endl;
+    //****************************************
+    // calculate center of the bounding box of the model
+    //****************************************
+    const point3d c = (_bb.pmax + _bb.pmin) * 0.5;
+
+    //****************************************
+    // calculate the unitizing scale factor as the
+    // maximum of the 3 dimensions
+    //****************************************
+    const auto scale = 2.f / std::max(std::max(w, h), d);
+
+    std::cout << "scale: " << scale << " cx " << c.x << " cy " << c.y << " cz " << c.z << std::endl;
+
+    // translate each vertex wrt to the center and then apply the scaling to the coordinate
+    for(auto& v : _vertices)
+    {
+        //****************************************
+        // translate the vertex
+        //****************************************
+        v.translate( -c.x, -c.y, -c.z );
+
+        //****************************************
+        // apply the scaling
+        //****************************************
+        v.scale( scale );
+    }
+
+    //****************************************
+    // update the bounding box, ie translate and scale the 6 coordinates
+    //****************************************
+    _bb.pmax = (_bb.pmax - c) * scale;
+    _bb.pmin = (_bb.pmin - c) * scale;
+
+    // the subdivided models follow the vertices, the normals of the faces and the vertices drawn are no longer valid
+    moveSubdivision( );
+    ++_verticesRevision;
+    _faceNormalsValid = false;
+    _normalLinesValid = false;
+
+
+    std::cout << "New bounding box : pmax=" << _bb.pmax << "  pmin=" << _bb.pmin << std::endl;
+
+    return scale;
+}
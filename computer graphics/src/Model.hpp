@@ -0,0 +1,195 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+#include "objReader.hpp"
+#include "RenderingParameters.hpp"
+#include "SubdivisionCache.hpp"
+#include "SubdivisionWorker.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SoftwareRasterizer;
+
+/**
+ * The 3D model along with its subdivision levels, drawn on the CPU; it does not depend on OpenGL,
+ * see MeshModel to draw it with OpenGL
+ */
+class Model
+{
+protected:
+    /// Stores the vertex indices for the triangles
+    std::vector<face> _mesh{};
+    /// Stores the vertices
+    std::vector<point3d> _vertices{};
+    /// Stores the normals for the triangles
+    std::vector<vec3d> _normals{};
+    /// Stores the texture coordinates of the vertices, if provided by the file
+    std::vector<texcoord> _texcoords{};
+    /// the revision of the faces, incremented each time they change so that their copies (eg in the
+    /// memory of the GPU) can tell whether they are up to date; 0 is the revision of no copy
+    std::size_t _meshRevision{1};
+    /// the revision of the vertices, incremented each time they change
+    std::size_t _verticesRevision{1};
+
+    // Subdivision
+    /// the subdivision levels computed so far
+    SubdivisionCache _subdivisionCache{};
+    /// the subdivision level being displayed, if any
+    std::shared_ptr<const SubdivisionLevel> _subdivided{};
+    /// the copy of the original model the background subdivisions start from, made once when first needed
+    std::shared_ptr<const SubdivisionLevel> _subdivisionBase{};
+    /// the background thread computing the missing subdivision levels, created when first needed
+    std::unique_ptr<SubdivisionWorker> _subdivider{};
+    /// the last subdivision level requested for rendering
+    unsigned short _requestedSubdivLevel{};
+
+    // Flat shading
+    /// the normals of the faces of the mesh of _faceNormalsLevel, computed when first needed
+    std::vector<vec3d> _faceNormals{};
+    /// the subdivision level of the normals of the faces, none for the original model
+    std::shared_ptr<const SubdivisionLevel> _faceNormalsLevel{};
+    /// true if the normals of the faces are up to date
+    bool _faceNormalsValid{false};
+
+    // Normals
+    /// the segments showing the normals of the vertices of _normalLinesLevel, computed when first needed
+    std::vector<point3d> _normalLines{};
+    /// the subdivision level of the segments showing the normals, none for the original model
+    std::shared_ptr<const SubdivisionLevel> _normalLinesLevel{};
+    /// the length of the segments showing the normals
+    float _normalLinesLength{};
+    /// the stride of the segments showing the normals
+    std::size_t _normalLinesStride{};
+    /// true if the segments showing the normals are up to date
+    bool _normalLinesValid{false};
+
+    // Software rendering
+    /// the edges of the mesh of _edgesLevel, each once, computed when first needed
+    std::vector<edge> _edges{};
+    /// the subdivision level of the edges, none for the original model
+    std::shared_ptr<const SubdivisionLevel> _edgesLevel{};
+    /// true if the edges are up to date
+    bool _edgesValid{false};
+
+    /// the current bounding box of the model
+    BoundingBox _bb{};
+
+    /// the subdivision level being displayed, 0 for the original model
+    unsigned short _currentSubdivLevel{};   
+
+public:
+    Model() = default;
+
+    /**
+     * Load the model from file, either an OBJ or a PLY file according to its extension
+      * @param[in] filename The name of the OBJ or PLY file
+      * @param[in] params The loading parameters
+      * @return true if everything went well, false otherwise
+     */
+    bool load(const std::string& filename, const LoadParameters& params = LoadParameters());
+
+    /**
+     * Render the model on the CPU, as MeshModel::render() does with OpenGL
+     * @param rasterizer The software renderer, with the camera, the light and the material of the scene
+     * @param params The rendering parameters
+     */
+    void rasterize(SoftwareRasterizer &rasterizer, const RenderingParameters &params = RenderingParameters());
+
+
+    /**
+     * It scales the model to unitary size by translating it to the origin and
+     * scaling it to fit in a unit cube around the origin.
+     *
+     * @return the scale factor used to transform the model
+     */
+    float unitizeModel();
+
+    /**
+     * Return the statistics of the cache of the subdivision levels
+     * @return the statistics
+     */
+    [[nodiscard]] const SubdivisionCacheStatistics& subdivisionStatistics() const { return _subdivisionCache.statistics(); }
+
+    /**
+     * Return true if a subdivision level is being computed in background
+     * @return true if a subdivision is in progress
+     */
+    [[nodiscard]] bool subdividing() const { return _subdivider && _subdivider->busy(); }
+
+    /**
+     * Block until the subdivision level requested by the last rendering is computed, so that the
+     * next rendering displays it, eg when rendering a single image
+     */
+    void waitSubdivision();
+
+    /**
+     * Return the progress of the subdivision level being computed in background
+     * @return the progress
+     */
+    [[nodiscard]] SubdivisionProgress subdivisionProgress() const
+    {
+        return _subdivider ? _subdivider->progress() : SubdivisionProgress();
+    }
+
+
+protected:
+
+    /**
+     * Return the mesh to display according to the parameters, see updateSubdivision()
+     * @param[in] params the rendering parameters
+     * @return the subdivision level to display, none for the original model
+     */
+    std::shared_ptr<const SubdivisionLevel> displayedLevel(const RenderingParameters& params);
+
+    /**
+     * Select the subdivision level to display: take the levels completed in background, then, if the
+     * requested level changes, either get it from the cache or display the closest level available
+     * meanwhile and compute the missing levels in background from there
+     * @param[in] level the requested subdivision level
+     */
+    void updateSubdivision(unsigned short level);
+
+    /**
+     * Return the segments showing the normals of the mesh to display, they are computed only when the
+     * mesh or their length or stride change
+     * @param[in] level the subdivision level to display, none for the original model
+     * @param[in] params the rendering parameters, with the length and the stride of the segments
+     * @return the two extremities of each segment
+     */
+    const std::vector<point3d>& normalLines(const std::shared_ptr<const SubdivisionLevel>& level, const RenderingParameters& params);
+
+    /**
+     * Return the normals of the faces of the mesh to display, they are computed only when the mesh changes
+     * @param[in] level the subdivision level to display, none for the original model
+     * @return the normal of each face
+     */
+    const std::vector<vec3d>& faceNormals(const std::shared_ptr<const SubdivisionLevel>& level);
+
+    /**
+     * Return the edges of the mesh to display, each once, they are listed only when the mesh changes
+     * @param[in] level the subdivision level to display, none for the original model
+     * @return the edges
+     */
+    const std::vector<edge>& edges(const std::shared_ptr<const SubdivisionLevel>& level);
+
+    /**
+     * Stop computing subdivision levels and forget the ones computed so far, eg when the model changes
+     */
+    void resetSubdivision();
+
+    /**
+     * Compute the subdivision levels in the cache again from the vertices of the model once they have
+     * moved, applying to each level the stencils built from the level below (see LoopStencils); the
+     * levels whose level below is not in the cache are forgotten
+     */
+    void moveSubdivision();
+};
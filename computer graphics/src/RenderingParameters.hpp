@@ -0,0 +1,40 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * How to draw the model, either with OpenGL or with the software renderer
+ */
+struct RenderingParameters
+{
+    /// wireframe on/off
+    bool wireframe{true};
+    /// draw the mesh on/off
+    bool solid { true };
+    /// use opengl drawElements on/off
+    bool useIndexRendering{false};
+    /// keep the mesh in buffer objects on the GPU, when supported, on/off
+    bool useBufferObjects{true};
+    /// subdivision on/off
+    bool subdivision{false};
+    /// GL_SMOOTH on/off
+    bool smooth{false};
+    /// show normals on/off
+    bool normals{false};
+    /// the length of the segments showing the normals
+    float normalLength{.05f};
+    /// show the normal of one vertex every normalStride vertices
+    std::size_t normalStride{1};
+    /// number of subdivision level
+    unsigned short subdivLevel{1};
+    /// memory budget for the subdivision levels kept to switch between them, in bytes
+    std::size_t subdivisionBudget{std::size_t{512} << 20u};
+
+    RenderingParameters() = default;
+};
@@ -0,0 +1,129 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ScratchArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+
+/**
+ * Round a size up to a multiple of max_align_t, the allocations are padded to it so that the
+ * next one starts aligned and the last one can be given back regardless of its alignment
+ * @param[in] bytes the size
+ * @return the padded size
+ */
+constexpr std::size_t padded(std::size_t bytes)
+{
+    return (bytes + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+
+}  // namespace
+
+ScratchArena::ScratchArena(std::size_t initialSize, std::pmr::memory_resource* upstream)
+    : _upstream(upstream), _nextBlockSize(padded(std::max<std::size_t>(initialSize, 1)))
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+    release();
+}
+
+void ScratchArena::reset()
+{
+    if(_blocks.size() > 1)
+    {
+        const auto total = capacity();
+        release();
+        addBlock(total);
+    }
+    _current = 0;
+    _top = 0;
+}
+
+void ScratchArena::release()
+{
+    for(const auto& block : _blocks)
+    {
+        _upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+    }
+    _blocks.clear();
+    _current = 0;
+    _top = 0;
+}
+
+std::size_t ScratchArena::used() const
+{
+    std::size_t bytes{_top};
+    for(std::size_t b = 0; b < std::min(_current, _blocks.size()); ++b)
+    {
+        bytes += _blocks[b].size;
+    }
+    return bytes;
+}
+
+std::size_t ScratchArena::capacity() const
+{
+    std::size_t bytes{0};
+    for(const auto& block : _blocks)
+    {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+void* ScratchArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    // the first block with enough space from the current one on, the space left in the
+    // blocks skipped is lost until the next reset
+    for(; _current < _blocks.size(); ++_current, _top = 0)
+    {
+        const auto& block = _blocks[_current];
+        const auto address = reinterpret_cast<std::uintptr_t>(block.data) + _top;
+        const auto begin = _top + (alignment - address % alignment) % alignment;
+        if(begin + padded(bytes) <= block.size)
+        {
+            _top = begin + padded(bytes);
+            return block.data + begin;
+        }
+    }
+
+    // the blocks are aligned to max_align_t, larger alignments need some padding
+    addBlock(std::max(_nextBlockSize, padded(bytes) + std::max(alignment, alignof(std::max_align_t))));
+    _current = _blocks.size() - 1;
+    _top = 0;
+    return do_allocate(bytes, alignment);
+}
+
+void ScratchArena::do_deallocate(void* p, std::size_t bytes, std::size_t)
+{
+    if(_current < _blocks.size())
+    {
+        auto* data = _blocks[_current].data;
+        if(static_cast<std::byte*>(p) + padded(bytes) == data + _top)
+        {
+            _top = static_cast<std::size_t>(static_cast<std::byte*>(p) - data);
+        }
+    }
+}
+
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+void ScratchArena::addBlock(std::size_t size)
+{
+    Block block;
+    block.data = static_cast<std::byte*>(_upstream->allocate(size, alignof(std::max_align_t)));
+    block.size = size;
+    _blocks.push_back(block);
+    ++_blockAllocations;
+    _nextBlockSize = std::max(_nextBlockSize, 2 * size);
+}
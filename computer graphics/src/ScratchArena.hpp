@@ -0,0 +1,110 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * A monotonic memory resource for the temporary data of the geometry algorithms, which keeps its
+ * memory when it is reset, so that repeating the same computations does not allocate any more
+ * memory from the system. The memory is taken from blocks allocated on demand; deallocating the
+ * last allocation makes its memory available again (hence releasing the temporary lists in the
+ * reverse order of their allocation keeps the peak usage low), other deallocations are no-ops until
+ * the arena is reset. It can be used by the std::pmr containers. It is not thread safe: the
+ * allocations must be done by a single thread at a time.
+ */
+class ScratchArena : public std::pmr::memory_resource
+{
+public:
+    /**
+     * Create an arena
+     * @param[in] initialSize the size of the first block, allocated when first needed
+     * @param[in] upstream the resource used to allocate the blocks
+     */
+    explicit ScratchArena(std::size_t initialSize = DEFAULT_BLOCK_SIZE,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    ~ScratchArena() override;
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * Make all the memory available again, the memory allocated so far must not be used anymore.
+     * If the memory was split in several blocks, they are replaced by a single block as large as
+     * all of them, so that the next use does not need a new block.
+     */
+    void reset();
+
+    /**
+     * Return all the blocks to the upstream resource, the memory allocated so far must not be used anymore
+     */
+    void release();
+
+    /**
+     * Return the memory in use
+     * @return the number of bytes from the beginning of the first block to the end of the last allocation
+     */
+    [[nodiscard]] std::size_t used() const;
+
+    /**
+     * Return the memory owned by the arena
+     * @return the total size of the blocks, in bytes
+     */
+    [[nodiscard]] std::size_t capacity() const;
+
+    /**
+     * Return the number of blocks allocated from the upstream resource since the arena was created
+     * @return the number of allocations
+     */
+    [[nodiscard]] std::size_t blockAllocations() const { return _blockAllocations; }
+
+    /// the default size of the first block
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE{1u << 16};
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    /**
+     * A block of memory taken from the upstream resource
+     */
+    struct Block
+    {
+        /// the memory
+        std::byte* data{nullptr};
+        /// its size in bytes
+        std::size_t size{0};
+
+        Block() = default;
+    };
+
+    /**
+     * Allocate a block at the end of the list
+     * @param[in] size its size in bytes
+     */
+    void addBlock(std::size_t size);
+
+    /// the resource providing the blocks
+    std::pmr::memory_resource* _upstream{nullptr};
+    /// the size of the next block to allocate
+    std::size_t _nextBlockSize{DEFAULT_BLOCK_SIZE};
+    /// the blocks, those after the current one are free
+    std::vector<Block> _blocks{};
+    /// the block the memory is taken from
+    std::size_t _current{0};
+    /// the beginning of the free memory in the current block
+    std::size_t _top{0};
+    /// number of blocks allocated so far
+    std::size_t _blockAllocations{0};
+};
@@ -0,0 +1,720 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "SoftwareRasterizer.hpp"
+#include "geometry.hpp"
+#include "image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+
+/// the number of steps in a pixel of the positions of the vertices
+constexpr std::int32_t SUBPIXELS{16};
+/// the center of a pixel, in steps
+constexpr std::int32_t HALF_PIXEL{SUBPIXELS / 2};
+/// the distance from the center of the image beyond which the triangles are clipped, in pixels,
+/// so that the edge functions of a tile fit in 32 bits
+constexpr float GUARD_BAND{4096.f};
+/// the values of the edge functions at the start of a row are clamped to this magnitude: a row of a tile
+/// changes them by less, so that their sign is kept, and they fit in 32 bits
+constexpr std::int64_t EDGE_LIMIT{std::int64_t{1} << 30};
+/// the number of vertices or primitives processed by each task
+constexpr std::size_t GRAIN{4096};
+/// the lines are moved toward the eye by this fraction of their distance, so that the wireframe is
+/// drawn over its faces; it keeps them at the same place in the image
+constexpr float LINE_DEPTH_OFFSET{1e-3f};
+/// the flag of the clipped triangles in the bins
+constexpr std::uint32_t CLIPPED{1u << 31u};
+/// the opaque alpha of the pixels
+constexpr std::uint32_t OPAQUE{0xffu << 24u};
+/// the largest number of vertices of a triangle clipped by the 5 planes
+constexpr std::size_t MAX_CLIPPED_VERTICES{8};
+
+/**
+ * Return the largest integer smaller than or equal to a / SUBPIXELS
+ * @param[in] a the numerator
+ * @return the rounded quotient
+ */
+std::int32_t floorSubpixels(std::int32_t a)
+{
+    return (a >= 0) ? (a / SUBPIXELS) : -((-a + SUBPIXELS - 1) / SUBPIXELS);
+}
+
+/**
+ * Return the smallest integer larger than or equal to a / SUBPIXELS
+ * @param[in] a the numerator
+ * @return the rounded quotient
+ */
+std::int32_t ceilSubpixels(std::int32_t a)
+{
+    return -floorSubpixels(-a);
+}
+
+/**
+ * Pack a color in 32 bits
+ * @param[in] r the red component, clamped to [0, 1]
+ * @param[in] g the green component, clamped to [0, 1]
+ * @param[in] b the blue component, clamped to [0, 1]
+ * @return the opaque RGBA color, red in the lowest byte
+ */
+inline std::uint32_t packColor(float r, float g, float b)
+{
+    // written so that NaN gives 0
+    const auto channel = [](float c) { return static_cast<std::uint32_t>(std::min(std::max(0.f, c), 1.f) * 255.f + .5f); };
+    return channel(r) | (channel(g) << 8u) | (channel(b) << 16u) | OPAQUE;
+}
+
+/**
+ * Pack a color in 32 bits
+ * @param[in] c the color
+ * @return the opaque RGBA color, red in the lowest byte
+ */
+inline std::uint32_t packColor(const v3f& c)
+{
+    return packColor(c.x, c.y, c.z);
+}
+
+/**
+ * Return the product of the components of two colors
+ * @param[in] a the first color
+ * @param[in] b the second color
+ * @return the modulated color
+ */
+inline v3f modulate(const v3f& a, const v3f& b)
+{
+    return {a.x * b.x, a.y * b.y, a.z * b.z};
+}
+
+/// a vertex in clip coordinates, with its color
+struct ClipVertex
+{
+    /// x, y, z and w
+    std::array<float, 4> position{};
+    /// the color
+    v3f color{};
+};
+
+/**
+ * Return the vertex on a segment
+ * @param[in] a the first extremity
+ * @param[in] b the second extremity
+ * @param[in] t the parameter of the vertex, 0 for a, 1 for b
+ * @return the interpolated vertex
+ */
+ClipVertex interpolate(const ClipVertex& a, const ClipVertex& b, float t)
+{
+    ClipVertex v;
+    for(std::size_t i = 0; i < v.position.size(); ++i)
+    {
+        v.position[i] = a.position[i] + t * (b.position[i] - a.position[i]);
+    }
+    v.color = a.color + (b.color - a.color) * t;
+    return v;
+}
+
+}  // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(std::size_t width, std::size_t height, unsigned int threads) : _pool(threads)
+{
+    resize(width, height);
+}
+
+void SoftwareRasterizer::resize(std::size_t width, std::size_t height)
+{
+    _width = std::clamp<std::size_t>(width, 1, MAX_SIZE);
+    _height = std::clamp<std::size_t>(height, 1, MAX_SIZE);
+    _tilesX = (_width + TILE_SIZE - 1) / TILE_SIZE;
+    _tilesY = (_height + TILE_SIZE - 1) / TILE_SIZE;
+    _color.assign(_width * _height, 0);
+    _depth.assign(_width * _height, 1.f);
+    _bins.clear();
+    clear();
+}
+
+void SoftwareRasterizer::clear(const v3f& color)
+{
+    std::fill(_color.begin(), _color.end(), packColor(color));
+    std::fill(_depth.begin(), _depth.end(), 1.f);
+}
+
+SoftwareRasterizer::Transform SoftwareRasterizer::transform() const
+{
+    // M_PI is not standard C++
+    constexpr float pi{3.14159265358979323846f};
+    constexpr float degrees{pi / 180.f};
+    const auto cx = std::cos(_camera.angleX * degrees);
+    const auto sx = std::sin(_camera.angleX * degrees);
+    const auto cy = std::cos(_camera.angleY * degrees);
+    const auto sy = std::sin(_camera.angleY * degrees);
+
+    Transform t;
+    // the rotation around x times the rotation around y, as glRotatef applies them
+    t.rotation = {cy, 0.f, sy, sx * sy, cx, -sx * cy, -cx * sy, sx, cx * cy};
+    t.translation = vec3d(0.f, 0.f, -_camera.distance);
+
+    const auto aspect = static_cast<float>(_width) / static_cast<float>(_height);
+    const auto f = 1.f / std::tan(_camera.fieldOfView * degrees / 2.f);
+    t.xScale = f / aspect;
+    t.yScale = f;
+    t.zScale = (_camera.zFar + _camera.zNear) / (_camera.zNear - _camera.zFar);
+    t.zOffset = 2.f * _camera.zFar * _camera.zNear / (_camera.zNear - _camera.zFar);
+    t.xLimit = 2.f * GUARD_BAND / static_cast<float>(_width);
+    t.yLimit = 2.f * GUARD_BAND / static_cast<float>(_height);
+    return t;
+}
+
+v3f SoftwareRasterizer::shade(const point3d& position, vec3d normal) const
+{
+    // the equations of the fixed pipeline, without attenuation nor local viewer
+    auto color = modulate(_light.sceneAmbient, _material.ambient) + modulate(_light.ambient, _material.ambient);
+    normal.normalize();
+    auto toLight = _light.position - position;
+    toLight.normalize();
+    const auto diffuse = normal.dot(toLight);
+    if(diffuse > 0.f)
+    {
+        color += modulate(_light.diffuse, _material.diffuse) * diffuse;
+        auto halfway = toLight + vec3d(0.f, 0.f, 1.f);
+        halfway.normalize();
+        const auto specular = normal.dot(halfway);
+        if(specular > 0.f)
+        {
+            color += modulate(_light.specular, _material.specular) * std::pow(specular, _material.shininess);
+        }
+    }
+    return color;
+}
+
+std::array<int, 4> SoftwareRasterizer::tileBounds(std::size_t tile) const
+{
+    const auto x = (tile % _tilesX) * TILE_SIZE;
+    const auto y = (tile / _tilesX) * TILE_SIZE;
+    return {static_cast<int>(x), static_cast<int>(y), static_cast<int>(std::min(x + TILE_SIZE, _width)),
+            static_cast<int>(std::min(y + TILE_SIZE, _height))};
+}
+
+template <typename Bounds>
+void SoftwareRasterizer::bin(std::size_t count, const Bounds& bounds)
+{
+    // the last lists are for the clipped triangles, drawn after the others
+    const auto numChunks = std::min<std::size_t>(_pool.size(), std::max<std::size_t>(1, count / GRAIN));
+    const auto numTiles = _tilesX * _tilesY;
+    _bins.resize(std::max(_bins.size(), numChunks + 1));
+    _toClip.resize(std::max(_toClip.size(), numChunks));
+    for(auto& chunk : _bins)
+    {
+        chunk.resize(numTiles);
+        for(auto& tile : chunk)
+        {
+            tile.clear();
+        }
+    }
+
+    _pool.run(numChunks, [&](std::size_t chunk) {
+        auto& bins = _bins[chunk];
+        _toClip[chunk].clear();
+        const auto begin = (count * chunk) / numChunks;
+        const auto end = (count * (chunk + 1)) / numChunks;
+        std::array<int, 4> box{};
+        for(auto i = begin; i < end; ++i)
+        {
+            if(!bounds(chunk, i, box))
+            {
+                continue;
+            }
+            const auto id = static_cast<std::uint32_t>(i);
+            const auto tileSize = static_cast<int>(TILE_SIZE);
+            for(int ty = box[1] / tileSize; ty <= box[3] / tileSize; ++ty)
+            {
+                for(int tx = box[0] / tileSize; tx <= box[2] / tileSize; ++tx)
+                {
+                    bins[static_cast<std::size_t>(ty) * _tilesX + static_cast<std::size_t>(tx)].push_back(id);
+                }
+            }
+        }
+    });
+    // the faces to clip of the chunks not used this time
+    for(auto chunk = numChunks; chunk < _toClip.size(); ++chunk)
+    {
+        _toClip[chunk].clear();
+    }
+}
+
+void SoftwareRasterizer::drawTriangles(const std::vector<point3d>& vertices,
+                                       const std::vector<face>& mesh,
+                                       const std::vector<vec3d>& vertexNormals,
+                                       const std::vector<vec3d>& faceNormals,
+                                       bool smooth)
+{
+    smooth = smooth && (vertexNormals.size() == vertices.size());
+    const auto* normals = &faceNormals;
+    if(!smooth && (faceNormals.size() != mesh.size()))
+    {
+        computeFaceNormals(vertices, mesh, _faceNormals, _pool.size());
+        normals = &_faceNormals;
+    }
+    const auto t = transform();
+    const auto width = static_cast<float>(_width);
+    const auto height = static_cast<float>(_height);
+    const auto project = [&](const std::array<float, 4>& clip, const v3f& color) {
+        ScreenVertex v;
+        v.invW = 1.f / clip[3];
+        v.x = static_cast<std::int32_t>(std::lround((clip[0] * v.invW * .5f + .5f) * width * SUBPIXELS));
+        v.y = static_cast<std::int32_t>(std::lround((clip[1] * v.invW * .5f + .5f) * height * SUBPIXELS));
+        v.z = clip[2] * v.invW * .5f + .5f;
+        v.color = color;
+        return v;
+    };
+
+    // transform, light and project the vertices, the ones to clip are marked
+    _screenVertices.resize(vertices.size());
+    _pool.run((vertices.size() + GRAIN - 1) / GRAIN, [&](std::size_t task) {
+        const auto end = std::min(vertices.size(), (task + 1) * GRAIN);
+        for(auto i = task * GRAIN; i < end; ++i)
+        {
+            const auto eye = t.eye(vertices[i]);
+            const auto clip = t.clip(eye);
+            const auto color = smooth ? shade(eye, t.rotate(vertexNormals[i])) : v3f();
+            if((clip[2] >= -clip[3]) && (std::fabs(clip[0]) <= t.xLimit * clip[3]) && (std::fabs(clip[1]) <= t.yLimit * clip[3]))
+            {
+                _screenVertices[i] = project(clip, color);
+            }
+            else
+            {
+                _screenVertices[i] = ScreenVertex();
+                _screenVertices[i].color = color;
+            }
+        }
+    });
+
+    // the color of a face for flat shading, lit at its last vertex as with GL_FLAT
+    const auto faceColor = [&](std::size_t f) {
+        return packColor(shade(t.eye(vertices[mesh[f].v3]), t.rotate((*normals)[f])));
+    };
+    // the pixels whose center may be inside a triangle, false if there is none or if it is a back face
+    const auto triangleBounds = [this](const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c, std::array<int, 4>& box) {
+        const auto area = std::int64_t{b.x - a.x} * (c.y - a.y) - std::int64_t{c.x - a.x} * (b.y - a.y);
+        if(area <= 0)
+        {
+            return false;
+        }
+        box[0] = std::max(0, ceilSubpixels(std::min({a.x, b.x, c.x}) - HALF_PIXEL));
+        box[1] = std::max(0, ceilSubpixels(std::min({a.y, b.y, c.y}) - HALF_PIXEL));
+        box[2] = std::min(static_cast<int>(_width) - 1, floorSubpixels(std::max({a.x, b.x, c.x}) - HALF_PIXEL));
+        box[3] = std::min(static_cast<int>(_height) - 1, floorSubpixels(std::max({a.y, b.y, c.y}) - HALF_PIXEL));
+        return (box[0] <= box[2]) && (box[1] <= box[3]);
+    };
+
+    if(!smooth)
+    {
+        _faceColors.resize(mesh.size());
+    }
+    bin(mesh.size(), [&](std::size_t chunk, std::size_t f, std::array<int, 4>& box) {
+        const auto& a = _screenVertices[mesh[f].v1];
+        const auto& b = _screenVertices[mesh[f].v2];
+        const auto& c = _screenVertices[mesh[f].v3];
+        if(!(a.invW > 0.f) || !(b.invW > 0.f) || !(c.invW > 0.f))
+        {
+            _toClip[chunk].push_back(static_cast<std::uint32_t>(f));
+            return false;
+        }
+        if(!triangleBounds(a, b, c, box))
+        {
+            return false;
+        }
+        if(!smooth)
+        {
+            _faceColors[f] = faceColor(f);
+        }
+        return true;
+    });
+
+    // clip the triangles crossing the near plane or the guard band, usually none or a few
+    _clipped.clear();
+    auto& clippedBins = _bins.back();
+    for(const auto& list : _toClip)
+    {
+        for(const auto f : list)
+        {
+            const std::array<idxtype, 3> corners{mesh[f].v1, mesh[f].v2, mesh[f].v3};
+            std::array<ClipVertex, MAX_CLIPPED_VERTICES> polygon{};
+            std::array<ClipVertex, MAX_CLIPPED_VERTICES> next{};
+            std::size_t size{0};
+            for(const auto v : corners)
+            {
+                polygon[size].position = t.clip(t.eye(vertices[v]));
+                polygon[size++].color = _screenVertices[v].color;
+            }
+            // the distances to the near plane and to the sides of the guard band
+            const std::array<std::array<float, 4>, 5> planes{{{0.f, 0.f, 1.f, 1.f},
+                                                              {1.f, 0.f, 0.f, t.xLimit},
+                                                              {-1.f, 0.f, 0.f, t.xLimit},
+                                                              {0.f, 1.f, 0.f, t.yLimit},
+                                                              {0.f, -1.f, 0.f, t.yLimit}}};
+            for(const auto& plane : planes)
+            {
+                const auto distance = [&plane](const ClipVertex& v) {
+                    return plane[0] * v.position[0] + plane[1] * v.position[1] + plane[2] * v.position[2] + plane[3] * v.position[3];
+                };
+                std::size_t nextSize{0};
+                for(std::size_t i = 0; i < size; ++i)
+                {
+                    const auto& current = polygon[i];
+                    const auto& following = polygon[(i + 1) % size];
+                    const auto d0 = distance(current);
+                    const auto d1 = distance(following);
+                    if(d0 >= 0.f)
+                    {
+                        next[nextSize++] = current;
+                    }
+                    if((d0 >= 0.f) != (d1 >= 0.f))
+                    {
+                        next[nextSize++] = interpolate(current, following, d0 / (d0 - d1));
+                    }
+                }
+                std::swap(polygon, next);
+                size = nextSize;
+            }
+
+            const auto color = smooth ? 0u : faceColor(f);
+            for(std::size_t i = 1; i + 1 < size; ++i)
+            {
+                ClippedTriangle triangle;
+                triangle.vertices = {project(polygon[0].position, polygon[0].color), project(polygon[i].position, polygon[i].color),
+                                     project(polygon[i + 1].position, polygon[i + 1].color)};
+                triangle.color = color;
+                std::array<int, 4> box{};
+                if(!triangleBounds(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], box))
+                {
+                    continue;
+                }
+                const auto id = static_cast<std::uint32_t>(_clipped.size()) | CLIPPED;
+                _clipped.push_back(triangle);
+                const auto tileSize = static_cast<int>(TILE_SIZE);
+                for(int ty = box[1] / tileSize; ty <= box[3] / tileSize; ++ty)
+                {
+                    for(int tx = box[0] / tileSize; tx <= box[2] / tileSize; ++tx)
+                    {
+                        clippedBins[static_cast<std::size_t>(ty) * _tilesX + static_cast<std::size_t>(tx)].push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    // draw the tiles
+    _pool.run(_tilesX * _tilesY, [&](std::size_t tile) {
+        const auto bounds = tileBounds(tile);
+        for(const auto& chunk : _bins)
+        {
+            for(const auto id : chunk[tile])
+            {
+                if(id & CLIPPED)
+                {
+                    const auto& triangle = _clipped[id & ~CLIPPED];
+                    rasterizeTriangle(bounds, triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], smooth, triangle.color);
+                }
+                else
+                {
+                    const auto& f = mesh[id];
+                    rasterizeTriangle(bounds, _screenVertices[f.v1], _screenVertices[f.v2], _screenVertices[f.v3], smooth,
+                                      smooth ? 0u : _faceColors[id]);
+                }
+            }
+        }
+    });
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const std::array<int, 4>& tile,
+                                           const ScreenVertex& v0,
+                                           const ScreenVertex& v1,
+                                           const ScreenVertex& v2,
+                                           bool smooth,
+                                           std::uint32_t color)
+{
+    // the pixels of the tile whose center may be inside the triangle
+    const auto x0 = std::max(tile[0], ceilSubpixels(std::min({v0.x, v1.x, v2.x}) - HALF_PIXEL));
+    const auto y0 = std::max(tile[1], ceilSubpixels(std::min({v0.y, v1.y, v2.y}) - HALF_PIXEL));
+    const auto x1 = std::min(tile[2] - 1, floorSubpixels(std::max({v0.x, v1.x, v2.x}) - HALF_PIXEL));
+    const auto y1 = std::min(tile[3] - 1, floorSubpixels(std::max({v0.y, v1.y, v2.y}) - HALF_PIXEL));
+    if((x0 > x1) || (y0 > y1))
+    {
+        return;
+    }
+
+    // the edge functions, each one the weight of the opposite vertex, at the center of the first pixel
+    // and their steps from a pixel to the next one; the pixels on an edge belong to the triangle only
+    // if it is a top or a left edge
+    std::array<std::int64_t, 3> origin{};
+    std::array<std::int32_t, 3> stepX{};
+    std::array<std::int64_t, 3> stepY{};
+    const std::array<const ScreenVertex*, 3> corners{&v0, &v1, &v2};
+    for(std::size_t e = 0; e < 3; ++e)
+    {
+        const auto& p = *corners[(e + 1) % 3];
+        const auto& q = *corners[(e + 2) % 3];
+        const std::int64_t a = p.y - q.y;
+        const std::int64_t b = q.x - p.x;
+        const bool topLeft = (a > 0) || ((a == 0) && (b < 0));
+        origin[e] = a * (std::int64_t{x0} * SUBPIXELS + HALF_PIXEL - p.x) + b * (std::int64_t{y0} * SUBPIXELS + HALF_PIXEL - p.y) - (topLeft ? 0 : 1);
+        stepX[e] = static_cast<std::int32_t>(a * SUBPIXELS);
+        stepY[e] = b * SUBPIXELS;
+    }
+    // positive, the back faces are not binned
+    const auto area = std::int64_t{v1.x - v0.x} * (v2.y - v0.y) - std::int64_t{v2.x - v0.x} * (v1.y - v0.y);
+    const auto invArea = 1.f / static_cast<float>(area);
+
+    // the depth is interpolated linearly in the image, the colors with the perspective correction
+    const auto z0 = v0.z;
+    const auto dz1 = (v1.z - v0.z) * invArea;
+    const auto dz2 = (v2.z - v0.z) * invArea;
+    const auto w0 = v0.invW;
+    const auto w1 = v1.invW;
+    const auto w2 = v2.invW;
+
+    const auto n = x1 - x0 + 1;
+    for(auto y = y0; y <= y1; ++y)
+    {
+        std::array<std::int32_t, 3> row{};
+        for(std::size_t e = 0; e < 3; ++e)
+        {
+            row[e] = static_cast<std::int32_t>(std::clamp(origin[e] + (y - y0) * stepY[e], -EDGE_LIMIT, EDGE_LIMIT));
+        }
+        const auto offset = static_cast<std::size_t>(y) * _width + static_cast<std::size_t>(x0);
+        float* depthRow = _depth.data() + offset;
+        std::uint32_t* colorRow = _color.data() + offset;
+        const auto e0 = row[0];
+        const auto e1 = row[1];
+        const auto e2 = row[2];
+        const auto s0 = stepX[0];
+        const auto s1 = stepX[1];
+        const auto s2 = stepX[2];
+
+        // a whole row at once, without branches so that it is vectorized
+        if(smooth)
+        {
+            for(int i = 0; i < n; ++i)
+            {
+                const auto b0 = e0 + i * s0;
+                const auto b1 = e1 + i * s1;
+                const auto b2 = e2 + i * s2;
+                const auto z = z0 + static_cast<float>(b1) * dz1 + static_cast<float>(b2) * dz2;
+                const bool pass = ((b0 | b1 | b2) >= 0) & (z <= depthRow[i]);
+                const auto q0 = static_cast<float>(b0) * w0;
+                const auto q1 = static_cast<float>(b1) * w1;
+                const auto q2 = static_cast<float>(b2) * w2;
+                const auto norm = 1.f / (q0 + q1 + q2);
+                const auto shaded = packColor((q0 * v0.color.x + q1 * v1.color.x + q2 * v2.color.x) * norm,
+                                              (q0 * v0.color.y + q1 * v1.color.y + q2 * v2.color.y) * norm,
+                                              (q0 * v0.color.z + q1 * v1.color.z + q2 * v2.color.z) * norm);
+                depthRow[i] = pass ? z : depthRow[i];
+                colorRow[i] = pass ? shaded : colorRow[i];
+            }
+        }
+        else
+        {
+            for(int i = 0; i < n; ++i)
+            {
+                const auto b0 = e0 + i * s0;
+                const auto b1 = e1 + i * s1;
+                const auto b2 = e2 + i * s2;
+                const auto z = z0 + static_cast<float>(b1) * dz1 + static_cast<float>(b2) * dz2;
+                const bool pass = ((b0 | b1 | b2) >= 0) & (z <= depthRow[i]);
+                depthRow[i] = pass ? z : depthRow[i];
+                colorRow[i] = pass ? color : colorRow[i];
+            }
+        }
+    }
+}
+
+template <typename Endpoints>
+void SoftwareRasterizer::drawSegments(std::size_t count, const Endpoints& endpoints, const v3f& color, float width)
+{
+    const auto t = transform();
+    const auto lineWidth = std::max(1, static_cast<int>(std::lround(width)));
+    const auto packed = packColor(color);
+    const auto imageWidth = static_cast<float>(_width);
+    const auto imageHeight = static_cast<float>(_height);
+    const auto margin = static_cast<float>(lineWidth) * .5f + 1.f;
+    // the coordinates far outside the image are clamped before being converted to pixels
+    const auto toPixel = [](float coordinate, float size) { return static_cast<int>(std::floor(std::clamp(coordinate, -1.f, size))); };
+
+    // project the segments, clipped by the near plane, and sort them in the tiles
+    _lines.resize(count);
+    bin(count, [&](std::size_t, std::size_t i, std::array<int, 4>& box) {
+        const auto [first, second] = endpoints(i);
+        ClipVertex a;
+        ClipVertex b;
+        a.position = t.clip(t.eye(first) * (1.f - LINE_DEPTH_OFFSET));
+        b.position = t.clip(t.eye(second) * (1.f - LINE_DEPTH_OFFSET));
+        const auto da = a.position[2] + a.position[3];
+        const auto db = b.position[2] + b.position[3];
+        if(!(da >= 0.f) && !(db >= 0.f))
+        {
+            return false;
+        }
+        if(da < 0.f)
+        {
+            a = interpolate(a, b, da / (da - db));
+        }
+        else if(db < 0.f)
+        {
+            b = interpolate(b, a, db / (db - da));
+        }
+
+        auto& line = _lines[i];
+        line.x0 = (a.position[0] / a.position[3] * .5f + .5f) * imageWidth;
+        line.y0 = (a.position[1] / a.position[3] * .5f + .5f) * imageHeight;
+        line.z0 = a.position[2] / a.position[3] * .5f + .5f;
+        line.x1 = (b.position[0] / b.position[3] * .5f + .5f) * imageWidth;
+        line.y1 = (b.position[1] / b.position[3] * .5f + .5f) * imageHeight;
+        line.z1 = b.position[2] / b.position[3] * .5f + .5f;
+
+        box[0] = std::max(0, toPixel(std::min(line.x0, line.x1) - margin, imageWidth));
+        box[1] = std::max(0, toPixel(std::min(line.y0, line.y1) - margin, imageHeight));
+        box[2] = std::min(static_cast<int>(_width) - 1, toPixel(std::max(line.x0, line.x1) + margin, imageWidth));
+        box[3] = std::min(static_cast<int>(_height) - 1, toPixel(std::max(line.y0, line.y1) + margin, imageHeight));
+        return (box[0] <= box[2]) && (box[1] <= box[3]);
+    });
+
+    // draw the tiles
+    _pool.run(_tilesX * _tilesY, [&](std::size_t tile) {
+        const auto bounds = tileBounds(tile);
+        for(const auto& chunk : _bins)
+        {
+            for(const auto id : chunk[tile])
+            {
+                rasterizeLine(bounds, _lines[id], lineWidth, packed);
+            }
+        }
+    });
+}
+
+void SoftwareRasterizer::rasterizeLine(const std::array<int, 4>& tile, const ScreenLine& line, int width, std::uint32_t color)
+{
+    // as OpenGL, for each pixel along the major axis whose center is covered by the segment, a column of
+    // width pixels across it
+    const bool xMajor = std::fabs(line.x1 - line.x0) >= std::fabs(line.y1 - line.y0);
+    auto u0 = xMajor ? line.x0 : line.y0;
+    auto v0 = xMajor ? line.y0 : line.x0;
+    auto z0 = line.z0;
+    auto u1 = xMajor ? line.x1 : line.y1;
+    auto v1 = xMajor ? line.y1 : line.x1;
+    auto z1 = line.z1;
+    if(u1 < u0)
+    {
+        std::swap(u0, u1);
+        std::swap(v0, v1);
+        std::swap(z0, z1);
+    }
+    const auto length = u1 - u0;
+    if(!(length > 0.f))
+    {
+        return;
+    }
+
+    const auto uMin = xMajor ? tile[0] : tile[1];
+    const auto uMax = xMajor ? tile[2] : tile[3];
+    const auto vMin = xMajor ? tile[1] : tile[0];
+    const auto vMax = xMajor ? tile[3] : tile[2];
+    // the coordinates far outside the tile are clamped before being converted to pixels
+    const auto clamp = [](float coordinate, int lowest, int highest) {
+        return std::clamp(coordinate, static_cast<float>(lowest), static_cast<float>(highest));
+    };
+    const auto begin = static_cast<int>(std::ceil(clamp(u0 - .5f, uMin, uMax)));
+    const auto end = static_cast<int>(std::ceil(clamp(u1 - .5f, uMin, uMax)));
+    const auto slope = (v1 - v0) / length;
+    const auto dz = (z1 - z0) / length;
+    const auto halfWidth = static_cast<float>(width - 1) * .5f;
+
+    for(auto u = begin; u < end; ++u)
+    {
+        const auto du = static_cast<float>(u) + .5f - u0;
+        const auto z = z0 + du * dz;
+        // the first pixel across, below the center of the line
+        const auto first = static_cast<int>(std::floor(clamp(v0 + du * slope - halfWidth, vMin - width, vMax)));
+        for(auto v = std::max(first, vMin); v < std::min(first + width, vMax); ++v)
+        {
+            const auto index = xMajor ? static_cast<std::size_t>(v) * _width + static_cast<std::size_t>(u)
+                                      : static_cast<std::size_t>(u) * _width + static_cast<std::size_t>(v);
+            if(z <= _depth[index])
+            {
+                _depth[index] = z;
+                _color[index] = color;
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::drawEdges(const std::vector<point3d>& vertices, const std::vector<edge>& edges, const v3f& color, float width)
+{
+    drawSegments(
+        edges.size(), [&](std::size_t i) { return std::make_pair(vertices[edges[i].first], vertices[edges[i].second]); }, color, width);
+}
+
+void SoftwareRasterizer::drawLines(const std::vector<point3d>& points, const v3f& color, float width)
+{
+    drawSegments(
+        points.size() / 2, [&](std::size_t i) { return std::make_pair(points[2 * i], points[2 * i + 1]); }, color, width);
+}
+
+void SoftwareRasterizer::draw(const std::vector<point3d>& vertices,
+                              const std::vector<face>& mesh,
+                              const std::vector<vec3d>& vertexNormals,
+                              const RenderingParameters& params,
+                              const std::vector<vec3d>& faceNormals,
+                              const std::vector<edge>& edges)
+{
+    if(params.solid)
+    {
+        drawTriangles(vertices, mesh, vertexNormals, faceNormals, params.smooth);
+    }
+    if(params.wireframe)
+    {
+        std::vector<edge> listed;
+        if(edges.empty())
+        {
+            listed = uniqueEdges(vertices.size(), mesh, _pool.size());
+        }
+        const auto& wireframe = edges.empty() ? listed : edges;
+        // thick black lines over the faces, thin light ones alone
+        if(params.solid)
+        {
+            drawEdges(vertices, wireframe, v3f(0.f, 0.f, 0.f), 2.f);
+        }
+        else
+        {
+            drawEdges(vertices, wireframe, v3f(.8f, .8f, .8f), .21f);
+        }
+    }
+}
+
+void SoftwareRasterizer::drawNormalLines(const std::vector<point3d>& lines)
+{
+    drawLines(lines, v3f(.8f, 0.f, 0.f), 2.f);
+}
+
+std::vector<unsigned char> SoftwareRasterizer::image() const
+{
+    std::vector<unsigned char> pixels(_color.size() * 4);
+    for(std::size_t i = 0; i < _color.size(); ++i)
+    {
+        for(unsigned int c = 0; c < 4; ++c)
+        {
+            pixels[4 * i + c] = static_cast<unsigned char>((_color[i] >> (8u * c)) & 0xffu);
+        }
+    }
+    return pixels;
+}
+
+bool SoftwareRasterizer::save(const std::string& filename) const
+{
+    return writeImage(filename, _width, _height, image());
+}
@@ -0,0 +1,434 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+#include "RenderingParameters.hpp"
+#include "ThreadPool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The point of view, as set by display(): a perspective projection (gluPerspective) and the model
+ * translated away from the eye, then rotated around the x and y axes
+ */
+struct Camera
+{
+    /// the vertical field of view, in degrees
+    float fieldOfView{45.f};
+    /// the distance of the near clipping plane
+    float zNear{.25f};
+    /// the distance of the far clipping plane
+    float zFar{500.f};
+    /// the distance of the origin of the model from the eye
+    float distance{5.f};
+    /// the rotation around the x axis, in degrees
+    float angleX{0.f};
+    /// the rotation around the y axis, in degrees
+    float angleY{0.f};
+
+    Camera() = default;
+};
+
+/**
+ * A positional light in eye coordinates, as set by place_light(), along with the ambient light of the scene
+ */
+struct Light
+{
+    /// the position of the light, in eye coordinates
+    point3d position{0.f, 0.f, 140.f};
+    /// the ambient color of the light
+    v3f ambient{.2f, .2f, .2f};
+    /// the diffuse color of the light
+    v3f diffuse{1.f, 1.f, 1.f};
+    /// the specular color of the light
+    v3f specular{1.f, 1.f, 1.f};
+    /// the ambient light of the scene (GL_LIGHT_MODEL_AMBIENT)
+    v3f sceneAmbient{.2f, .2f, .2f};
+
+    Light() = default;
+};
+
+/**
+ * The material of the model, as set by define_material()
+ */
+struct Material
+{
+    /// the ambient color
+    v3f ambient{.2f, .2f, .2f};
+    /// the diffuse color
+    v3f diffuse{.8f, .8f, .8f};
+    /// the specular color
+    v3f specular{1.f, .8f, .8f};
+    /// the specular exponent
+    float shininess{100.f};
+
+    Material() = default;
+};
+
+/**
+ * A renderer running on the CPU, without any OpenGL context, into an RGBA and a depth buffer in the main
+ * memory. It draws the same scenes as the fixed pipeline of OpenGL with the settings of the visualizer:
+ * back faces culled, depth test GL_LEQUAL, lighting computed at the vertices by the OpenGL equations
+ * with a single positional light, interpolated with perspective correction for smooth shading or
+ * taken from the last vertex of each face for flat shading, unlit lines for the wireframe and the normals.
+ *
+ * Each draw call transforms the vertices, sorts the primitives into tiles of the image, then draws the
+ * tiles, all these steps being spread over a pool of threads. The tiles are independent, each one drawing
+ * its primitives in the order of the call. The triangles are drawn with edge functions in fixed point
+ * (1/16 of pixel, top-left filling rule), evaluated on whole rows of pixels at once so that the compiler
+ * vectorizes them. The triangles crossing the near plane or far outside the image are clipped first.
+ */
+class SoftwareRasterizer
+{
+public:
+    /**
+     * Create the image, cleared with the background of the visualizer
+     * @param[in] width the width of the image, in pixels
+     * @param[in] height the height of the image, in pixels
+     * @param[in] threads the number of threads drawing, 0 means as many as the hardware threads
+     */
+    SoftwareRasterizer(std::size_t width, std::size_t height, unsigned int threads = 0);
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    /**
+     * Change the size of the image, which is cleared; the size is limited to MAX_SIZE
+     * @param[in] width the width of the image, in pixels
+     * @param[in] height the height of the image, in pixels
+     */
+    void resize(std::size_t width, std::size_t height);
+
+    /**
+     * Clear the image and its depth
+     * @param[in] color the background color
+     */
+    void clear(const v3f& color = v3f(.5f, .5f, .75f));
+
+    /**
+     * Draw a list of triangles, lit by the light
+     * @param[in] vertices the vertices
+     * @param[in] mesh the faces, counterclockwise when seen from the front
+     * @param[in] vertexNormals the normals of the vertices, for smooth shading; if empty the faces are drawn with flat shading
+     * @param[in] faceNormals the normals of the faces, for flat shading; if empty they are computed
+     * @param[in] smooth true for smooth shading, false for flat shading
+     */
+    void drawTriangles(const std::vector<point3d>& vertices,
+                       const std::vector<face>& mesh,
+                       const std::vector<vec3d>& vertexNormals,
+                       const std::vector<vec3d>& faceNormals,
+                       bool smooth);
+
+    /**
+     * Draw the edges of a mesh as lines
+     * @param[in] vertices the vertices
+     * @param[in] edges the pairs of vertices to join
+     * @param[in] color the color of the lines
+     * @param[in] width the width of the lines, in pixels, rounded to the nearest integer but at least 1
+     */
+    void drawEdges(const std::vector<point3d>& vertices, const std::vector<edge>& edges, const v3f& color, float width);
+
+    /**
+     * Draw segments as lines
+     * @param[in] points the two extremities of each segment
+     * @param[in] color the color of the lines
+     * @param[in] width the width of the lines, in pixels, rounded to the nearest integer but at least 1
+     */
+    void drawLines(const std::vector<point3d>& points, const v3f& color, float width);
+
+    /**
+     * Draw the model as draw() does with OpenGL, the wireframe with the same colors and widths
+     * @param[in] vertices the vertices
+     * @param[in] mesh the faces
+     * @param[in] vertexNormals the normals of the vertices
+     * @param[in] params the rendering parameters
+     * @param[in] faceNormals the normals of the faces, for flat shading; if empty they are computed
+     * @param[in] edges the edges of the wireframe, each once; if empty they are listed
+     */
+    void draw(const std::vector<point3d>& vertices,
+              const std::vector<face>& mesh,
+              const std::vector<vec3d>& vertexNormals,
+              const RenderingParameters& params,
+              const std::vector<vec3d>& faceNormals = std::vector<vec3d>(),
+              const std::vector<edge>& edges = std::vector<edge>());
+
+    /**
+     * Draw the normals as drawNormalLines() does with OpenGL
+     * @param[in] lines the two extremities of each segment, see computeNormalLines()
+     */
+    void drawNormalLines(const std::vector<point3d>& lines);
+
+    /**
+     * Save the image in a PNG or a PPM file, according to the extension of its name
+     * @param[in] filename the name of the file
+     * @return true if everything went well, false otherwise
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * Return the image
+     * @return the RGBA pixels, row by row from the bottom one as read by glReadPixels
+     */
+    [[nodiscard]] std::vector<unsigned char> image() const;
+
+    /**
+     * Return the depth of the pixels
+     * @return the depth between 0 (near plane) and 1 (far plane), row by row from the bottom one
+     */
+    [[nodiscard]] const std::vector<float>& depth() const { return _depth; }
+
+    /**
+     * Return the width of the image
+     * @return the width in pixels
+     */
+    [[nodiscard]] std::size_t width() const { return _width; }
+
+    /**
+     * Return the height of the image
+     * @return the height in pixels
+     */
+    [[nodiscard]] std::size_t height() const { return _height; }
+
+    /**
+     * Return the number of threads drawing
+     * @return the number of threads
+     */
+    [[nodiscard]] unsigned int threads() const { return _pool.size(); }
+
+    /**
+     * Return the camera used by the draw calls
+     * @return the camera
+     */
+    [[nodiscard]] const Camera& camera() const { return _camera; }
+
+    /**
+     * Set the camera used by the next draw calls
+     * @param[in] camera the camera
+     */
+    void setCamera(const Camera& camera) { _camera = camera; }
+
+    /**
+     * Return the light used by the draw calls
+     * @return the light
+     */
+    [[nodiscard]] const Light& light() const { return _light; }
+
+    /**
+     * Set the light used by the next draw calls
+     * @param[in] light the light
+     */
+    void setLight(const Light& light) { _light = light; }
+
+    /**
+     * Return the material used by the draw calls
+     * @return the material
+     */
+    [[nodiscard]] const Material& material() const { return _material; }
+
+    /**
+     * Set the material used by the next draw calls
+     * @param[in] material the material
+     */
+    void setMaterial(const Material& material) { _material = material; }
+
+    /// the largest width and height of the image
+    static constexpr std::size_t MAX_SIZE{8192};
+    /// the width and the height of the tiles
+    static constexpr std::size_t TILE_SIZE{64};
+
+private:
+    /// a vertex projected on the image
+    struct ScreenVertex
+    {
+        /// the position in the image, in 1/16 of pixel
+        std::int32_t x{0};
+        std::int32_t y{0};
+        /// the depth, between 0 and 1
+        float z{0.f};
+        /// the inverse of w, 0 if the vertex must be clipped
+        float invW{0.f};
+        /// the color, for smooth shading
+        v3f color{};
+    };
+
+    /// a triangle cut by the clipping planes
+    struct ClippedTriangle
+    {
+        /// its vertices
+        std::array<ScreenVertex, 3> vertices{};
+        /// the color of the face, for flat shading
+        std::uint32_t color{0};
+    };
+
+    /// a segment projected on the image
+    struct ScreenLine
+    {
+        /// the first extremity, in pixels, and its depth
+        float x0{0.f};
+        float y0{0.f};
+        float z0{0.f};
+        /// the second extremity, in pixels, and its depth
+        float x1{0.f};
+        float y1{0.f};
+        float z1{0.f};
+    };
+
+    /// the transformation from the model to the clip coordinates
+    struct Transform
+    {
+        /// the rotation of the model, row by row
+        std::array<float, 9> rotation{};
+        /// the translation of the model
+        vec3d translation{};
+        /// the scale of x and y in the perspective projection
+        float xScale{0.f};
+        float yScale{0.f};
+        /// the coefficients of z in the perspective projection
+        float zScale{0.f};
+        float zOffset{0.f};
+        /// the limits of x/w and y/w beyond which the primitives are clipped
+        float xLimit{0.f};
+        float yLimit{0.f};
+
+        /**
+         * Rotate a vector, eg a normal, into eye coordinates
+         * @param[in] v the vector
+         * @return the rotated vector
+         */
+        [[nodiscard]] v3f rotate(const v3f& v) const
+        {
+            return {rotation[0] * v.x + rotation[1] * v.y + rotation[2] * v.z, rotation[3] * v.x + rotation[4] * v.y + rotation[5] * v.z,
+                    rotation[6] * v.x + rotation[7] * v.y + rotation[8] * v.z};
+        }
+
+        /**
+         * Transform a point of the model into eye coordinates
+         * @param[in] p the point
+         * @return the point in eye coordinates
+         */
+        [[nodiscard]] point3d eye(const point3d& p) const { return rotate(p) + translation; }
+
+        /**
+         * Project a point in eye coordinates
+         * @param[in] e the point in eye coordinates
+         * @return x, y, z and w in clip coordinates
+         */
+        [[nodiscard]] std::array<float, 4> clip(const point3d& e) const
+        {
+            return {xScale * e.x, yScale * e.y, zScale * e.z + zOffset, -e.z};
+        }
+    };
+
+    /**
+     * Compute the transformation of the current camera for the current image
+     * @return the transformation
+     */
+    [[nodiscard]] Transform transform() const;
+
+    /**
+     * Compute the color of a vertex lit by the light
+     * @param[in] position the position of the vertex, in eye coordinates
+     * @param[in] normal the normal of the vertex, in eye coordinates, not necessarily normalized
+     * @return the color
+     */
+    [[nodiscard]] v3f shade(const point3d& position, vec3d normal) const;
+
+    /**
+     * Sort the primitives in the tiles they may cover, the primitives being processed by consecutive
+     * chunks in parallel; each chunk has its own lists so that the order of the primitives is kept
+     * @param[in] count the number of primitives
+     * @param[in] bounds fn(primitive, xmin, ymin, xmax, ymax) returning false if the primitive covers no pixel, otherwise its bounds in pixels, clamped to the image
+     */
+    template <typename Bounds>
+    void bin(std::size_t count, const Bounds& bounds);
+
+    /**
+     * Draw a triangle in a tile
+     * @param[in] tile the bounds of the tile, xmin, ymin, xmax and ymax (excluded)
+     * @param[in] v0 the first vertex
+     * @param[in] v1 the second vertex
+     * @param[in] v2 the third vertex
+     * @param[in] smooth true to interpolate the colors of the vertices, false to use the color of the face
+     * @param[in] color the color of the face
+     */
+    void rasterizeTriangle(const std::array<int, 4>& tile,
+                           const ScreenVertex& v0,
+                           const ScreenVertex& v1,
+                           const ScreenVertex& v2,
+                           bool smooth,
+                           std::uint32_t color);
+
+    /**
+     * Draw a line in a tile
+     * @param[in] tile the bounds of the tile, xmin, ymin, xmax and ymax (excluded)
+     * @param[in] line the line
+     * @param[in] width the width of the line, in pixels
+     * @param[in] color the color of the line
+     */
+    void rasterizeLine(const std::array<int, 4>& tile, const ScreenLine& line, int width, std::uint32_t color);
+
+    /**
+     * Draw segments as lines
+     * @param[in] count the number of segments
+     * @param[in] endpoints fn(segment) returning the pair of extremities of a segment
+     * @param[in] color the color of the lines
+     * @param[in] width the width of the lines, in pixels
+     */
+    template <typename Endpoints>
+    void drawSegments(std::size_t count, const Endpoints& endpoints, const v3f& color, float width);
+
+    /**
+     * Return the bounds of a tile
+     * @param[in] tile the index of the tile
+     * @return xmin, ymin, xmax and ymax (excluded) in pixels
+     */
+    [[nodiscard]] std::array<int, 4> tileBounds(std::size_t tile) const;
+
+    /// the width of the image
+    std::size_t _width{0};
+    /// the height of the image
+    std::size_t _height{0};
+    /// the number of tiles along the width
+    std::size_t _tilesX{0};
+    /// the number of tiles along the height
+    std::size_t _tilesY{0};
+    /// the pixels, one RGBA color packed in 32 bits each, red in the lowest byte
+    std::vector<std::uint32_t> _color{};
+    /// the depth of the pixels
+    std::vector<float> _depth{};
+
+    /// the camera
+    Camera _camera{};
+    /// the light
+    Light _light{};
+    /// the material
+    Material _material{};
+
+    /// the threads drawing
+    ThreadPool _pool;
+
+    // The data of the current draw call, kept between the calls so that they are allocated once
+    /// the vertices projected on the image
+    std::vector<ScreenVertex> _screenVertices{};
+    /// the colors of the faces, for flat shading
+    std::vector<std::uint32_t> _faceColors{};
+    /// the normals of the faces, when not given
+    std::vector<vec3d> _faceNormals{};
+    /// the triangles clipped
+    std::vector<ClippedTriangle> _clipped{};
+    /// the segments projected on the image
+    std::vector<ScreenLine> _lines{};
+    /// for each chunk of primitives, the primitives to draw in each tile
+    std::vector<std::vector<std::vector<std::uint32_t>>> _bins{};
+    /// for each chunk of faces, the faces to clip
+    std::vector<std::vector<std::uint32_t>> _toClip{};
+};
@@ -0,0 +1,130 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "SubdivisionCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::size_t SubdivisionLevel::bytes() const
+{
+    return vertices.size() * sizeof(point3d) + mesh.size() * sizeof(face) + normals.size() * sizeof(vec3d);
+}
+
+std::size_t SubdivisionLevel::subdividedBytes(unsigned short levels) const
+{
+    // computed in floating point, as the number of faces overflows for high levels
+    const auto faces = static_cast<double>(mesh.size()) * std::pow(4., levels);
+    const auto numVertices = static_cast<double>(vertices.size()) + (faces - static_cast<double>(mesh.size())) / 2;
+    const auto estimate = faces * static_cast<double>(sizeof(face)) + numVertices * static_cast<double>(sizeof(point3d) + sizeof(vec3d));
+    constexpr auto maximum = static_cast<double>(std::numeric_limits<std::size_t>::max());
+    return (estimate >= maximum) ? std::numeric_limits<std::size_t>::max() : static_cast<std::size_t>(estimate);
+}
+
+std::ostream& operator<<(std::ostream& os, const SubdivisionCacheStatistics& s)
+{
+    return os << s.hits << " hits, " << s.misses << " misses, " << s.evictions << " evictions, " << s.levels << " levels in "
+              << (s.residentBytes >> 10u) << " KiB";
+}
+
+void SubdivisionCache::setBudget(std::size_t budget)
+{
+    _budget = budget;
+    evict();
+}
+
+std::shared_ptr<const SubdivisionLevel> SubdivisionCache::find(unsigned short level)
+{
+    const auto it = std::find_if(_levels.begin(), _levels.end(), [level](const auto& l) { return l.first == level; });
+    if(it == _levels.end())
+    {
+        ++_stats.misses;
+        return nullptr;
+    }
+    ++_stats.hits;
+    // move it in front, as the most recently used
+    _levels.splice(_levels.begin(), _levels, it);
+    return _levels.front().second;
+}
+
+std::shared_ptr<const SubdivisionLevel> SubdivisionCache::closestBelow(unsigned short level, unsigned short& found) const
+{
+    found = 0;
+    std::shared_ptr<const SubdivisionLevel> closest;
+    for(const auto& l : _levels)
+    {
+        if(l.first < level && l.first > found)
+        {
+            found = l.first;
+            closest = l.second;
+        }
+    }
+    return closest;
+}
+
+void SubdivisionCache::insert(unsigned short level, std::shared_ptr<const SubdivisionLevel> data)
+{
+    const auto it = std::find_if(_levels.begin(), _levels.end(), [level](const auto& l) { return l.first == level; });
+    if(it != _levels.end())
+    {
+        _stats.residentBytes -= it->second->bytes();
+        _levels.erase(it);
+    }
+    // a level larger than the whole budget would evict all the others for nothing
+    if(data->bytes() > _budget)
+    {
+        _stats.levels = _levels.size();
+        return;
+    }
+    _stats.residentBytes += data->bytes();
+    _levels.emplace_front(level, std::move(data));
+    evict();
+}
+
+void SubdivisionCache::update(const Update& update)
+{
+    std::vector<decltype(_levels)::iterator> byLevel;
+    for(auto it = _levels.begin(); it != _levels.end(); ++it)
+    {
+        byLevel.push_back(it);
+    }
+    std::sort(byLevel.begin(), byLevel.end(), [](const auto& a, const auto& b) { return a->first < b->first; });
+
+    for(const auto& it : byLevel)
+    {
+        _stats.residentBytes -= it->second->bytes();
+        auto data = update(it->first, it->second);
+        if(data && (data->bytes() <= _budget))
+        {
+            _stats.residentBytes += data->bytes();
+            it->second = std::move(data);
+        }
+        else
+        {
+            _levels.erase(it);
+        }
+    }
+    evict();
+}
+
+void SubdivisionCache::clear()
+{
+    _levels.clear();
+    _stats.levels = 0;
+    _stats.residentBytes = 0;
+}
+
+void SubdivisionCache::evict()
+{
+    while(!_levels.empty() && _stats.residentBytes > _budget)
+    {
+        _stats.residentBytes -= _levels.back().second->bytes();
+        _levels.pop_back();
+        ++_stats.evictions;
+    }
+    _stats.levels = _levels.size();
+}
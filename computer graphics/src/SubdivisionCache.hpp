@@ -0,0 +1,163 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * A level of subdivision of a model
+ */
+struct SubdivisionLevel
+{
+    /// the vertices
+    std::vector<point3d> vertices{};
+    /// the vertex indices of the triangles
+    std::vector<face> mesh{};
+    /// the normals of the vertices
+    std::vector<vec3d> normals{};
+
+    SubdivisionLevel() = default;
+
+    /**
+     * Return the memory used by the level
+     * @return the size of the lists, in bytes
+     */
+    [[nodiscard]] std::size_t bytes() const;
+
+    /**
+     * Return an estimate of the memory used by a level subdivided from this one, along with its normals:
+     * each step splits each face in four and adds about one vertex for every two new faces
+     * @param[in] levels the number of subdivision steps
+     * @return the estimated size of the lists of the subdivided level, in bytes, saturated to the
+     * maximum value of std::size_t
+     */
+    [[nodiscard]] std::size_t subdividedBytes(unsigned short levels) const;
+};
+
+/**
+ * Some statistics about the use of the cache of the subdivision levels
+ */
+struct SubdivisionCacheStatistics
+{
+    /// number of levels found in the cache
+    std::size_t hits{0};
+    /// number of levels not found in the cache, hence computed
+    std::size_t misses{0};
+    /// number of levels removed to stay within the budget
+    std::size_t evictions{0};
+    /// number of levels in the cache
+    std::size_t levels{0};
+    /// memory used by the levels in the cache, in bytes
+    std::size_t residentBytes{0};
+
+    SubdivisionCacheStatistics() = default;
+};
+
+/**
+ * Print the statistics of the cache on a stream
+ * @param[in,out] os the stream
+ * @param[in] s the statistics
+ * @return the stream
+ */
+std::ostream& operator<<(std::ostream& os, const SubdivisionCacheStatistics& s);
+
+/**
+ * A cache of the subdivision levels of a model, within a memory budget: when the levels in the cache
+ * exceed the budget the least recently used ones are removed. The levels are shared, a level removed
+ * from the cache stays valid as long as someone holds it.
+ */
+class SubdivisionCache
+{
+public:
+    /// the default memory budget, in bytes
+    static constexpr std::size_t DEFAULT_BUDGET{std::size_t{512} << 20u};
+
+    /**
+     * Constructor
+     * @param[in] budget the maximum memory used by the levels in the cache, in bytes
+     */
+    explicit SubdivisionCache(std::size_t budget = DEFAULT_BUDGET) : _budget(budget) { }
+
+    /**
+     * Change the memory budget, removing the least recently used levels if needed
+     * @param[in] budget the maximum memory used by the levels in the cache, in bytes
+     */
+    void setBudget(std::size_t budget);
+
+    /**
+     * Return the memory budget
+     * @return the maximum memory used by the levels in the cache, in bytes
+     */
+    [[nodiscard]] std::size_t budget() const { return _budget; }
+
+    /**
+     * Look up a level, which becomes the most recently used one. It counts as a hit or a miss.
+     * @param[in] level the subdivision level
+     * @return the level, or nullptr if it is not in the cache
+     */
+    std::shared_ptr<const SubdivisionLevel> find(unsigned short level);
+
+    /**
+     * Look up the highest level in the cache below a given one, eg to compute the given level
+     * from there. It does not count as a hit or a miss.
+     * @param[in] level the subdivision level
+     * @param[out] found the highest level in the cache less than level, 0 if there is none
+     * @return the level found, or nullptr if there is none
+     */
+    std::shared_ptr<const SubdivisionLevel> closestBelow(unsigned short level, unsigned short& found) const;
+
+    /**
+     * Add a level (or replace it) as the most recently used one, removing the least recently used
+     * levels if the budget is exceeded. A level larger than the whole budget is not kept.
+     * @param[in] level the subdivision level
+     * @param[in] data the subdivided model
+     */
+    void insert(unsigned short level, std::shared_ptr<const SubdivisionLevel> data);
+
+    /// a function giving the new data of a level from its number and its current data
+    using Update = std::function<std::shared_ptr<const SubdivisionLevel>(unsigned short, const std::shared_ptr<const SubdivisionLevel>&)>;
+
+    /**
+     * Replace the data of all the levels, which keep their order of use, eg when the vertices of the
+     * model move. It does not count as a hit or a miss.
+     * @param[in] update called for each level by increasing level, it returns the new data of the
+     * level or nullptr to remove the level; a level grown larger than the whole budget is removed too
+     */
+    void update(const Update& update);
+
+    /**
+     * Remove all the levels, eg when the model changes. The counters of hits and misses are kept.
+     */
+    void clear();
+
+    /**
+     * Return the statistics of the cache
+     * @return the statistics
+     */
+    [[nodiscard]] const SubdivisionCacheStatistics& statistics() const { return _stats; }
+
+private:
+    /**
+     * Remove the least recently used levels until the cache is within the budget
+     */
+    void evict();
+
+    /// the levels in the cache, the most recently used first
+    std::list<std::pair<unsigned short, std::shared_ptr<const SubdivisionLevel>>> _levels{};
+    /// the maximum memory used by the levels, in bytes
+    std::size_t _budget{DEFAULT_BUDGET};
+    /// the statistics
+    SubdivisionCacheStatistics _stats{};
+};
@@ -0,0 +1,146 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "SubdivisionWorker.hpp"
+#include "loop.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+SubdivisionWorker::~SubdivisionWorker()
+{
+    // the threads are detached, each of them keeps its job alive until it exits
+    for(auto& running : _running)
+    {
+        running->cancelled.store(true, std::memory_order_relaxed);
+    }
+}
+
+void SubdivisionWorker::request(unsigned short level,
+                                unsigned short fromLevel,
+                                std::shared_ptr<const SubdivisionLevel> start,
+                                unsigned int threads,
+                                bool direct)
+{
+    cancel();
+    forgetCompleted();
+
+    auto job = std::make_shared<Job>();
+    job->targetLevel = level;
+    job->fromLevel = fromLevel;
+    job->direct = direct;
+    job->completedLevel.store(fromLevel, std::memory_order_relaxed);
+    job->start = std::move(start);
+    if(!_scratch || !_running.empty())
+    {
+        // the arena of a cancelled job may still be in use by its thread
+        _scratch = std::make_shared<ScratchArena>();
+    }
+    job->scratch = _scratch;
+
+    std::thread worker([job, threads]() {
+        try
+        {
+            auto current = job->start;
+            for(auto l = job->fromLevel; (l < job->targetLevel) && !job->cancelled.load(std::memory_order_relaxed);)
+            {
+                const auto levels = static_cast<unsigned short>(job->direct ? job->targetLevel - l : 1);
+                auto next = std::make_shared<SubdivisionLevel>();
+                job->scratch->reset();
+                if(!loopSubdivision(current->vertices, current->mesh, levels, next->vertices, next->mesh, next->normals, threads,
+                                    job->scratch.get(), &job->cancelled))
+                {
+                    break;
+                }
+                l = static_cast<unsigned short>(l + levels);
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->results.emplace_back(l, next);
+                }
+                job->completedLevel.store(l, std::memory_order_relaxed);
+                current = std::move(next);
+            }
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << "error while subdividing the model: " << e.what() << std::endl;
+        }
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->done.store(true, std::memory_order_release);
+        }
+        job->finished.notify_all();
+    });
+    worker.detach();
+    _running.push_back(job);
+    _current = std::move(job);
+}
+
+void SubdivisionWorker::cancel()
+{
+    if(_current)
+    {
+        _current->cancelled.store(true, std::memory_order_relaxed);
+        _current.reset();
+    }
+}
+
+bool SubdivisionWorker::busy() const
+{
+    // the job is released by take() once complete and all its levels taken
+    return static_cast<bool>(_current);
+}
+
+SubdivisionProgress SubdivisionWorker::progress() const
+{
+    SubdivisionProgress p;
+    if(busy())
+    {
+        p.targetLevel = _current->targetLevel;
+        p.fromLevel = _current->fromLevel;
+        p.completedLevel = _current->completedLevel.load(std::memory_order_relaxed);
+    }
+    return p;
+}
+
+void SubdivisionWorker::wait()
+{
+    if(_current)
+    {
+        const auto job = _current;
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&job]() { return job->done.load(std::memory_order_acquire); });
+    }
+}
+
+std::vector<SubdivisionWorker::Result> SubdivisionWorker::take()
+{
+    std::vector<Result> results;
+    if(_current)
+    {
+        // the levels are published before the job is marked as done, so once done everything is taken
+        const bool done = _current->done.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(_current->mutex);
+            results.swap(_current->results);
+        }
+        if(done)
+        {
+            _current.reset();
+        }
+    }
+    forgetCompleted();
+    return results;
+}
+
+void SubdivisionWorker::forgetCompleted()
+{
+    _running.erase(std::remove_if(_running.begin(), _running.end(),
+                                  [](const auto& running) { return running->done.load(std::memory_order_acquire); }),
+                   _running.end());
+}
@@ -0,0 +1,149 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "ScratchArena.hpp"
+#include "SubdivisionCache.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * The progress of a background subdivision
+ */
+struct SubdivisionProgress
+{
+    /// the level being computed, 0 if nothing is being computed
+    unsigned short targetLevel{0};
+    /// the level the subdivision started from
+    unsigned short fromLevel{0};
+    /// the last level completed so far
+    unsigned short completedLevel{0};
+
+    SubdivisionProgress() = default;
+};
+
+/**
+ * Compute subdivision levels in a background thread, so that the thread running the render loop
+ * is never blocked. By default each request applies the Loop subdivision one level at a time from a
+ * starting level up to the requested one, and each level is made available as soon as it is complete
+ * (see loopSubdivision()); a direct request computes the requested level at once instead, patch by patch.
+ * Requesting a new subdivision cancels the previous one: it stops at the end of the level being
+ * computed, or of the patch for a direct request, and its levels are discarded. Neither a new request nor the destruction of the worker
+ * waits for a cancelled subdivision. The temporary data of the subdivision are taken from an
+ * arena kept between the requests, so that subdividing again does not allocate them anew.
+ */
+class SubdivisionWorker
+{
+public:
+    /// a subdivision level along with its number
+    using Result = std::pair<unsigned short, std::shared_ptr<const SubdivisionLevel>>;
+
+    SubdivisionWorker() = default;
+
+    /**
+     * Cancel the subdivisions still running without waiting for them, so that the worker can be
+     * destroyed by the thread running the render loop: their threads own the data they use and
+     * exit on their own once they stop
+     */
+    ~SubdivisionWorker();
+
+    SubdivisionWorker(const SubdivisionWorker&) = delete;
+    SubdivisionWorker& operator=(const SubdivisionWorker&) = delete;
+
+    /**
+     * Start computing a subdivision level in background, it returns immediately
+     * @param[in] level the level to compute
+     * @param[in] fromLevel the level of the starting model, less than level
+     * @param[in] start the starting model (its normals are not used)
+     * @param[in] threads the number of threads used by each subdivision step, 0 means as many as the hardware threads
+     * @param[in] direct if true the level is computed at once, without computing (and making available)
+     * the intermediate levels, see loopSubdivision()
+     */
+    void request(unsigned short level,
+                 unsigned short fromLevel,
+                 std::shared_ptr<const SubdivisionLevel> start,
+                 unsigned int threads = 0,
+                 bool direct = false);
+
+    /**
+     * Cancel the last request, if any
+     */
+    void cancel();
+
+    /**
+     * Return true if the last requested subdivision is being computed, or some of its levels
+     * have not been taken yet
+     * @return true if a subdivision is in progress
+     */
+    [[nodiscard]] bool busy() const;
+
+    /**
+     * Return the progress of the last requested subdivision
+     * @return the progress
+     */
+    [[nodiscard]] SubdivisionProgress progress() const;
+
+    /**
+     * Take the levels completed by the last request since the previous call, in increasing order.
+     * It never waits for the subdivision.
+     * @return the completed levels
+     */
+    std::vector<Result> take();
+
+    /**
+     * Block until the last requested subdivision is complete or cancelled, eg when rendering
+     * without a render loop; its levels are then taken by take()
+     */
+    void wait();
+
+private:
+    /**
+     * A background subdivision
+     */
+    struct Job
+    {
+        /// the level to compute
+        unsigned short targetLevel{0};
+        /// the level of the starting model
+        unsigned short fromLevel{0};
+        /// whether the intermediate levels are skipped
+        bool direct{false};
+        /// the starting model
+        std::shared_ptr<const SubdivisionLevel> start{};
+        /// the memory for the temporary data, reset at each level
+        std::shared_ptr<ScratchArena> scratch{};
+        /// the last level completed
+        std::atomic<unsigned short> completedLevel{0};
+        /// set to stop the subdivision at the end of the current level
+        std::atomic<bool> cancelled{false};
+        /// set when the thread is about to exit
+        std::atomic<bool> done{false};
+        /// protects results and done for the waits
+        std::mutex mutex{};
+        /// notified when done is set
+        std::condition_variable finished{};
+        /// the levels completed and not taken yet
+        std::vector<Result> results{};
+    };
+
+    /**
+     * Forget the jobs whose thread is complete
+     */
+    void forgetCompleted();
+
+    /// the last requested job
+    std::shared_ptr<Job> _current{};
+    /// the arena of the last job, reused by the next one if no other job is running
+    std::shared_ptr<ScratchArena> _scratch{};
+    /// the jobs whose (detached) thread may still be running
+    std::vector<std::shared_ptr<Job>> _running{};
+};
@@ -0,0 +1,125 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ThreadPool.hpp"
+#include "parallel.hpp"
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    const auto count = threadCount(threads);
+    _workers.reserve(count - 1);
+    for(unsigned int i = 1; i < count; ++i)
+    {
+        _workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+    for(auto& w : _workers)
+    {
+        w.join();
+    }
+}
+
+void ThreadPool::run(std::size_t numTasks, const std::function<void(std::size_t)>& fn)
+{
+    if(numTasks == 0)
+    {
+        return;
+    }
+    if(_workers.empty() || (numTasks == 1))
+    {
+        for(std::size_t task = 0; task < numTasks; ++task)
+        {
+            fn(task);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fn = &fn;
+        _numTasks = numTasks;
+        _nextTask.store(0, std::memory_order_relaxed);
+        _error = nullptr;
+        ++_batch;
+    }
+    _wakeUp.notify_all();
+
+    runTasks(fn, numTasks);
+
+    std::exception_ptr error;
+    {
+        // the threads joining the batch from now on find it closed, the ones already in must finish
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [this] { return _running == 0; });
+        _fn = nullptr;
+        error = _error;
+        _error = nullptr;
+    }
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::work()
+{
+    std::size_t lastBatch{0};
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(true)
+    {
+        _wakeUp.wait(lock, [&] { return _stop || (_batch != lastBatch); });
+        if(_stop)
+        {
+            return;
+        }
+        lastBatch = _batch;
+        if(_fn == nullptr)
+        {
+            // woken up too late, the batch is already over
+            continue;
+        }
+        const auto* fn = _fn;
+        const auto numTasks = _numTasks;
+        ++_running;
+        lock.unlock();
+
+        runTasks(*fn, numTasks);
+
+        lock.lock();
+        if(--_running == 0)
+        {
+            _finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::runTasks(const std::function<void(std::size_t)>& fn, std::size_t numTasks)
+{
+    for(auto task = _nextTask.fetch_add(1, std::memory_order_relaxed); task < numTasks;
+        task = _nextTask.fetch_add(1, std::memory_order_relaxed))
+    {
+        try
+        {
+            fn(task);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(!_error)
+            {
+                _error = std::current_exception();
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A set of threads kept alive between the batches of tasks they run, for the work repeated at each
+ * frame where starting new threads every time, as parallelChunks() does, would cost too much. The
+ * tasks of a batch are taken one at a time by the first thread available, so that tasks of uneven
+ * cost are balanced. A batch is run by one thread at a time.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * Start the threads
+     * @param[in] threads the number of threads running the tasks, the calling thread included, 0 means as many as the hardware threads
+     */
+    explicit ThreadPool(unsigned int threads = 0);
+
+    /**
+     * Stop the threads, once the batch running, if any, is complete
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Call fn(task) for each task in [0, numTasks), from the threads of the pool and the calling
+     * thread, and return once all the calls have returned. If any call throws, the remaining tasks
+     * are still run and the first exception is rethrown.
+     * @param[in] numTasks the number of tasks
+     * @param[in] fn the function to call for each task
+     */
+    void run(std::size_t numTasks, const std::function<void(std::size_t)>& fn);
+
+    /**
+     * Return the number of threads running the tasks
+     * @return the number of threads, the calling thread included
+     */
+    [[nodiscard]] unsigned int size() const { return static_cast<unsigned int>(_workers.size() + 1); }
+
+private:
+    /**
+     * The loop of the threads of the pool: wait for a batch and take part in it
+     */
+    void work();
+
+    /**
+     * Take the tasks of the current batch until there are none left
+     * @param[in] fn the function to call for each task
+     * @param[in] numTasks the number of tasks of the batch
+     */
+    void runTasks(const std::function<void(std::size_t)>& fn, std::size_t numTasks);
+
+    /// the threads of the pool
+    std::vector<std::thread> _workers{};
+    /// protects the batch and the counters below
+    std::mutex _mutex{};
+    /// signals a new batch or the end of the pool
+    std::condition_variable _wakeUp{};
+    /// signals that a thread of the pool has left the batch
+    std::condition_variable _finished{};
+    /// the function of the current batch, null when there is none
+    const std::function<void(std::size_t)>* _fn{nullptr};
+    /// the number of tasks of the current batch
+    std::size_t _numTasks{0};
+    /// the next task to take
+    std::atomic<std::size_t> _nextTask{0};
+    /// the number of the current batch, so that each thread joins it once
+    std::size_t _batch{0};
+    /// the number of threads of the pool working on the current batch
+    unsigned int _running{0};
+    /// the first exception thrown by the current batch
+    std::exception_ptr _error{};
+    /// true when the pool is destroyed
+    bool _stop{false};
+};
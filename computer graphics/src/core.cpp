@@ -6,12 +6,21 @@
 
 
 #include "core.hpp"
+#include "parallel.hpp"
 
 #include <cmath>
 #include <cassert>
 #include <algorithm>
 #include <limits>
 
+namespace
+{
+
+/// the minimum number of half-edges numbered by each thread
+constexpr std::size_t ADJACENCY_GRAIN{4096};
+
+}  // namespace
+
 void v3f::normalize()
 {
     const float n = norm();
@@ -425,3 +434,129 @@ bool isBoundaryEdge(const edge &e, const std::vector<face> &mesh, idxtype &oppVe
     assert(foundFirst);
     return(foundFirst && (!foundSecond));
 }
+
+void VertexCorners::build(std::size_t numVertices, const face* mesh, std::size_t numFaces)
+{
+    assert(3 * numFaces < std::numeric_limits<idxtype>::max());
+
+    // counting sort of the corners by vertex: count the corners of each vertex and compute where
+    // its list ends, then fill the lists backwards, which leaves the corners of each vertex in
+    // increasing order and each offset at the beginning of its list
+    offsets.assign(numVertices + 1, 0);
+    for(const auto* f = mesh; f != mesh + numFaces; ++f)
+    {
+        ++offsets[f->v1];
+        ++offsets[f->v2];
+        ++offsets[f->v3];
+    }
+    for(std::size_t v = 1; v < numVertices; ++v)
+    {
+        offsets[v] += offsets[v - 1];
+    }
+    offsets[numVertices] = static_cast<idxtype>(3 * numFaces);
+
+    corners.resize(3 * numFaces);
+    for(std::size_t i = numFaces; i-- > 0;)
+    {
+        const auto corner = static_cast<idxtype>(3 * i);
+        corners[--offsets[mesh[i].v3]] = corner + 2;
+        corners[--offsets[mesh[i].v2]] = corner + 1;
+        corners[--offsets[mesh[i].v1]] = corner;
+    }
+}
+
+void EdgeAdjacency::build(const face* mesh, std::size_t numFaces, const VertexCorners& corners, std::size_t firstIndex, unsigned int threads)
+{
+    const std::size_t numHalfEdges = 3 * numFaces;
+    assert(numHalfEdges < NONE);
+    auto* scratch = first.get_allocator().resource();
+    // the indices are allocated first, so that the other lists can be released before them
+    index.resize(numHalfEdges);
+    first.resize(numHalfEdges);
+    second.resize(numHalfEdges);
+
+    const auto vertexOf = [mesh](std::size_t h) -> idxtype {
+        const face& f = mesh[h / 3];
+        return (h % 3 == 0) ? f.v1 : ((h % 3 == 1) ? f.v2 : f.v3);
+    };
+    const auto nextOf = [](std::size_t h) { return (h % 3 == 2) ? h - 2 : h + 1; };
+    const auto prevOf = [](std::size_t h) { return (h % 3 == 0) ? h + 2 : h - 1; };
+
+    // the half-edges of each edge are gathered at its smallest vertex: the corners of a vertex
+    // are the half-edges leaving it and the half-edges before them are the ones reaching it, so
+    // each vertex has room for twice its corners and each half-edge is gathered exactly once
+    const std::size_t numVertices = corners.offsets.size() - 1;
+    std::pmr::vector<std::pair<idxtype, idxtype>> around(2 * numHalfEdges, scratch);
+    parallelFor(
+        numVertices,
+        [&](std::size_t u) {
+            auto* const begin = around.data() + 2 * std::size_t{corners.offsets[u]};
+            auto* end = begin;
+            for(auto c = corners.offsets[u]; c < corners.offsets[u + 1]; ++c)
+            {
+                const idxtype h = corners.corners[c];
+                if(const idxtype v = vertexOf(nextOf(h)); v >= u)
+                    *end++ = {v, h};
+                const auto p = static_cast<idxtype>(prevOf(h));
+                if(const idxtype v = vertexOf(p); v > u)
+                    *end++ = {v, p};
+            }
+
+            // sorted by the other vertex and then by half-edge, each edge is a run whose first
+            // half-edge is the first one of the edge, followed by the others in the order of the faces
+            std::sort(begin, end);
+            for(auto* run = begin; run != end;)
+            {
+                const idxtype h1 = run->second;
+                idxtype h2{NONE};
+                auto* runEnd = run;
+                for(; runEnd != end && runEnd->first == run->first; ++runEnd)
+                {
+                    if(h2 == NONE && runEnd->second / 3 != h1 / 3)
+                        h2 = runEnd->second;
+                }
+                for(; run != runEnd; ++run)
+                {
+                    first[run->second] = h1;
+                    second[run->second] = h2;
+                }
+            }
+        },
+        threads);
+    // released before the other temporary list, see ScratchArena
+    std::pmr::vector<std::pair<idxtype, idxtype>>(scratch).swap(around);
+
+    // number the edges in the order of their first half-edge: count the edges met in
+    // each chunk of half-edges, then number them from the offset of their chunk
+    const auto numChunks = static_cast<unsigned int>(
+        std::min<std::size_t>(threadCount(threads), std::max<std::size_t>(1, numHalfEdges / ADJACENCY_GRAIN)));
+    std::pmr::vector<std::size_t> chunkEdges(numChunks + 1, 0, scratch);
+    parallelChunks(numHalfEdges, numChunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        for(auto h = begin; h < end; ++h)
+        {
+            if(first[h] == h)
+                ++chunkEdges[chunk + 1];
+        }
+    });
+    for(std::size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        chunkEdges[chunk + 1] += chunkEdges[chunk];
+    }
+    numEdges = chunkEdges[numChunks];
+    parallelChunks(numHalfEdges, numChunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        auto next = firstIndex + chunkEdges[chunk];
+        for(auto h = begin; h < end; ++h)
+        {
+            if(first[h] == h)
+                index[h] = static_cast<idxtype>(next++);
+        }
+    });
+    // the other half-edges take the index of the first one, which is always before them
+    parallelFor(
+        numHalfEdges,
+        [&](std::size_t h) {
+            if(first[h] != h)
+                index[h] = index[first[h]];
+        },
+        threads);
+}
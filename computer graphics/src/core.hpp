@@ -6,8 +6,10 @@
 
 #pragma once
 
-#include "openglAll.hpp"
-
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
 #include <vector>
 #include <iostream>
 #include <string>
@@ -25,9 +27,9 @@
 #endif
 
 /**
- * Renaming, the type of an index is a unsigned int
+ * Renaming, the type of an index is a unsigned int, the same as GLuint
  */
-using idxtype = GLuint;
+using idxtype = std::uint32_t;
 
 /**
  * An edge is defined as a pair of indices of the vertices
@@ -96,15 +98,42 @@ struct edgeEquivalent
 
 
 
+/**
+ * Return the canonical key of an edge: the two indices packed in 64 bits, the smaller one
+ * first, so that edge(v1, v2) and edge(v2, v1) have the same key
+ * @param[in] e the edge
+ * @return the key
+ */
+inline std::uint64_t edgeKey( const edge &e )
+{
+    const auto lo = std::min( e.first, e.second );
+    const auto hi = std::max( e.first, e.second );
+    return ( static_cast<std::uint64_t>( lo ) << 32u ) | static_cast<std::uint64_t>( hi );
+}
+
+/**
+ * Mix the bits of a 64 bit integer (the finalizer of splitmix64), so that close keys
+ * end up far apart in a hash table
+ * @param[in] x the integer
+ * @return the mixed integer
+ */
+constexpr std::uint64_t mix64( std::uint64_t x )
+{
+    x ^= x >> 30u;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27u;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31u;
+    return x;
+}
+
 // to be used with unordered
 
 struct edgeHash
 {
     size_t operator( ) ( const edge &a ) const
     {
-        std::hash<std::string> fun;
-        return (fun( ( a.first > a.second ) ? ( "v" + std::to_string( a.second ) + "-" + std::to_string( a.first ) ) :
-                ( "v" + std::to_string( a.first ) + "-" + std::to_string( a.second ) ) ) );
+        return static_cast<size_t>( mix64( edgeKey( a ) ) );
     }
 };
 
@@ -122,6 +151,163 @@ inline std::ostream& operator<<( std::ostream& os, const edge2vertex & l )
     return os;
 }
 
+/**
+ * A hash table associating a value to each edge, no matter the order of its vertices. It is
+ * an open addressing table with linear probing: the keys (see edgeKey) and the values are
+ * stored in two flat arrays, hence looking up or inserting an edge never allocates memory,
+ * unless the table has to grow.
+ *
+ * @tparam T the type of the values
+ */
+template <typename T>
+class FlatEdgeTable
+{
+public:
+    /**
+     * Constructor
+     * @param[in] expected the number of edges that will be inserted
+     */
+    explicit FlatEdgeTable( std::size_t expected = 0 )
+    {
+        reserve( expected );
+    }
+
+    /**
+     * Make room for the given number of edges, so that they can be inserted without growing the table
+     * @param[in] expected the number of edges
+     */
+    void reserve( std::size_t expected )
+    {
+        // keep the load factor at most 1/2
+        std::size_t capacity{MIN_CAPACITY};
+        while ( capacity < 2 * expected )
+            capacity <<= 1u;
+        if ( capacity > _keys.size( ) )
+            rehash( capacity );
+    }
+
+    /**
+     * Look up an edge and insert it with the given value if it is not in the table
+     * @param[in] e the edge
+     * @param[in] value the value associated to the edge if it is inserted
+     * @return the value associated to the edge (valid until the next insertion) and true if the
+     * edge has been inserted
+     */
+    std::pair<T*, bool> findOrInsert( const edge &e, const T &value )
+    {
+        if ( 2 * ( _size + 1 ) > _keys.size( ) )
+            rehash( std::max( MIN_CAPACITY, 2 * _keys.size( ) ) );
+
+        const auto key = edgeKey( e );
+        auto slot = slotOf( key );
+        while ( _keys[slot] != EMPTY )
+        {
+            if ( _keys[slot] == key )
+                return {&_values[slot], false};
+            slot = ( slot + 1 ) & _mask;
+        }
+        _keys[slot] = key;
+        _values[slot] = value;
+        ++_size;
+        return {&_values[slot], true};
+    }
+
+    /**
+     * Look up an edge
+     * @param[in] e the edge
+     * @return the value associated to the edge, or nullptr if the edge is not in the table
+     */
+    [[nodiscard]] const T* find( const edge &e ) const
+    {
+        if ( _size == 0 )
+            return nullptr;
+        const auto key = edgeKey( e );
+        for ( auto slot = slotOf( key ); _keys[slot] != EMPTY; slot = ( slot + 1 ) & _mask )
+        {
+            if ( _keys[slot] == key )
+                return &_values[slot];
+        }
+        return nullptr;
+    }
+
+    /**
+     * Return the number of edges in the table
+     * @return the number of edges
+     */
+    [[nodiscard]] std::size_t size( ) const { return _size; }
+
+    /**
+     * Remove all the edges, keeping the memory
+     */
+    void clear( )
+    {
+        std::fill( _keys.begin( ), _keys.end( ), EMPTY );
+        _size = 0;
+    }
+
+    /**
+     * Call fn(e, value) for each edge in the table, in no particular order
+     * @param[in] fn the function
+     */
+    template <typename Function>
+    void forEach( Function &&fn ) const
+    {
+        for ( std::size_t slot = 0; slot < _keys.size( ); ++slot )
+        {
+            if ( _keys[slot] != EMPTY )
+                fn( edge( static_cast<idxtype>( _keys[slot] >> 32u ), static_cast<idxtype>( _keys[slot] ) ), _values[slot] );
+        }
+    }
+
+private:
+    /// the key of the empty slots, ie the key of the (degenerate) edge with both indices set to the maximum value
+    static constexpr std::uint64_t EMPTY{~std::uint64_t{0}};
+    /// the minimum number of slots
+    static constexpr std::size_t MIN_CAPACITY{16};
+
+    /**
+     * Return the first slot to probe for a key
+     * @param[in] key the key
+     * @return the slot
+     */
+    [[nodiscard]] std::size_t slotOf( std::uint64_t key ) const
+    {
+        return static_cast<std::size_t>( mix64( key ) ) & _mask;
+    }
+
+    /**
+     * Move the content of the table in a new table with the given number of slots
+     * @param[in] capacity the number of slots, a power of 2
+     */
+    void rehash( std::size_t capacity )
+    {
+        std::vector<std::uint64_t> keys( capacity, EMPTY );
+        std::vector<T> values( capacity );
+        _mask = capacity - 1;
+        for ( std::size_t i = 0; i < _keys.size( ); ++i )
+        {
+            if ( _keys[i] == EMPTY )
+                continue;
+            auto slot = slotOf( _keys[i] );
+            while ( keys[slot] != EMPTY )
+                slot = ( slot + 1 ) & _mask;
+            keys[slot] = _keys[i];
+            values[slot] = _values[i];
+        }
+        _keys.swap( keys );
+        _values.swap( values );
+    }
+
+    /// the key of each slot
+    std::vector<std::uint64_t> _keys{};
+    /// the value of each slot
+    std::vector<T> _values{};
+    /// the number of edges in the table
+    std::size_t _size{0};
+    /// the number of slots minus one (it is a power of 2)
+    std::size_t _mask{0};
+};
+
 /**
  * A helper class containing the indices of the new vertices added with the subdivision
  * coupled with the edge that has generated them. More specifically, it is a list in which
@@ -139,6 +325,15 @@ class EdgeList
 public:
     EdgeList( ) = default;
 
+    /**
+     * Make room for the given number of edges
+     * @param[in] expected the number of edges
+     */
+    void reserve( std::size_t expected )
+    {
+        list.reserve( expected );
+    }
+
     /**
      * Add the edge and the index of the new vertex generated on it
      * @param[in] e the edge
@@ -146,7 +341,20 @@ public:
      */
     void add( const edge &e, const idxtype &idx )
     {
-        list[e] = idx;
+        *list.findOrInsert( e, idx ).first = idx;
+    }
+
+    /**
+     * Look up the edge and add it with the given index if it is not in the list, with
+     * a single lookup
+     * @param[in] e the edge
+     * @param[in] idx the index of the new vertex generated on the edge, if it is added
+     * @return the index of the vertex associated to the edge and true if the edge has been added
+     */
+    std::pair<idxtype, bool> findOrInsert( const edge &e, const idxtype &idx )
+    {
+        const auto [value, inserted] = list.findOrInsert( e, idx );
+        return {*value, inserted};
     }
 
     /**
@@ -156,28 +364,31 @@ public:
      */
     bool contains( const edge &e ) const
     {
-        return (list.find( e ) != list.end( ) );
+        return ( list.find( e ) != nullptr );
     }
 
     /**
      * Get the vertex index associated to the edge
      * @param e the edge
-     * @return the index
+     * @return the index, 0 if the edge is not in the list
      */
-    idxtype getIndex( const edge &e )
+    idxtype getIndex( const edge &e ) const
     {
-        return (list[e] );
+        const auto* idx = list.find( e );
+        return ( idx != nullptr ) ? *idx : 0;
     }
 
     friend std::ostream& operator<<( std::ostream& os, const EdgeList& l );
 
 private:
-  edge2vertex list;
+  FlatEdgeTable<idxtype> list;
 };
 
 inline std::ostream& operator<<( std::ostream& os, const EdgeList& l )
 {
-    return (os << l.list );
+    os << std::endl;
+    l.list.forEach( [&os]( const edge &e, idxtype idx ) { os << "\t" << e << "\t" << idx << std::endl; } );
+    return os;
 }
 
 /**************************************************************************/
@@ -355,6 +566,7 @@ struct v3f
  */
 using point3d = struct v3f ;
 using vec3d = struct v3f;
+using texcoord = struct v3f;
 
 /**
  * Print the elements of a vector
@@ -533,3 +745,102 @@ inline std::ostream& operator<<( std::ostream& os, const std::vector<face>& p )
  */
 bool isBoundaryEdge( const edge &e, const std::vector<face> &triangleList, idxtype &oppVert1, idxtype &oppVert2 );
 
+/**
+ * For each vertex, the list of the face corners referring to it, in compressed form: the corners
+ * of vertex v are corners[offsets[v]], ..., corners[offsets[v + 1] - 1], in increasing order.
+ * The corner k (0, 1, 2) of the face f has index 3 * f + k, the indices are stored as idxtype
+ * to halve the memory, hence the mesh has less than 2^32 / 3 faces.
+ */
+struct VertexCorners
+{
+    /// the beginning of the list of corners of each vertex, plus the total number of corners
+    std::pmr::vector<idxtype> offsets{};
+    /// the corners of all the vertices
+    std::pmr::vector<idxtype> corners{};
+
+    VertexCorners() = default;
+
+    /**
+     * Create empty lists whose memory is taken from the given resource
+     * @param[in] resource the memory resource
+     */
+    explicit VertexCorners(std::pmr::memory_resource* resource) : offsets(resource), corners(resource) {}
+
+    /**
+     * Build the lists of corners of a mesh in linear time
+     * @param[in] numVertices the number of vertices
+     * @param[in] mesh the list of faces
+     */
+    void build(std::size_t numVertices, const std::vector<face>& mesh) { build(numVertices, mesh.data(), mesh.size()); }
+
+    /**
+     * Build the lists of corners of a mesh in linear time
+     * @param[in] numVertices the number of vertices
+     * @param[in] mesh the faces
+     * @param[in] numFaces the number of faces
+     */
+    void build(std::size_t numVertices, const face* mesh, std::size_t numFaces);
+};
+
+/**
+ * The edges of a mesh seen from its half-edges: the corner k (0, 1, 2) of the face f, with index
+ * 3f+k, is the beginning of the half-edge going from the k-th vertex of the face to the next one,
+ * ie v1-v2, v2-v3 and v3-v1. For each half-edge it keeps the first half-edge of its edge, where the
+ * edge is first met scanning the faces, and the first half-edge of the edge in another face, so the
+ * two faces sharing an edge and their opposite vertices are found in constant time. The edges are
+ * numbered in the order of their first half-edge, hence the numbering does not depend on the number
+ * of threads. It is built from the corners of the vertices (see VertexCorners) by sorting the
+ * half-edges around each vertex: linear time for bounded valences, O(n log n) for a vertex shared
+ * by all the faces.
+ */
+struct EdgeAdjacency
+{
+    /// the marker of a missing half-edge
+    static constexpr idxtype NONE{std::numeric_limits<idxtype>::max( )};
+
+    /// for each half-edge, the index of its edge
+    std::pmr::vector<idxtype> index{};
+    /// for each half-edge, the first half-edge of its edge
+    std::pmr::vector<idxtype> first{};
+    /// for each half-edge, the first half-edge of its edge in another face, NONE for a boundary edge
+    std::pmr::vector<idxtype> second{};
+    /// the number of (distinct) edges
+    std::size_t numEdges{0};
+
+    EdgeAdjacency( ) = default;
+
+    /**
+     * Create empty lists whose memory is taken from the given resource
+     * @param[in] resource the memory resource, also used for the temporary lists of build()
+     */
+    explicit EdgeAdjacency( std::pmr::memory_resource* resource ) : index( resource ), first( resource ), second( resource ) {}
+
+    /**
+     * Build the adjacency of the edges of a mesh, replacing the previous one
+     * @param[in] mesh the list of faces
+     * @param[in] corners the corners of the vertices of the mesh
+     * @param[in] firstIndex the index of the first edge
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void build( const std::vector<face> &mesh, const VertexCorners &corners, std::size_t firstIndex = 0, unsigned int threads = 0 )
+    {
+        build( mesh.data( ), mesh.size( ), corners, firstIndex, threads );
+    }
+
+    /**
+     * Build the adjacency of the edges of a mesh, replacing the previous one
+     * @param[in] mesh the faces
+     * @param[in] numFaces the number of faces
+     * @param[in] corners the corners of the vertices of the mesh
+     * @param[in] firstIndex the index of the first edge
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void build( const face *mesh, std::size_t numFaces, const VertexCorners &corners, std::size_t firstIndex = 0, unsigned int threads = 0 );
+
+    /**
+     * Return true if the edge of a half-edge is a boundary edge, ie it belongs to a single face
+     * @param[in] h the half-edge
+     * @return true if the edge is a boundary edge
+     */
+    [[nodiscard]] bool isBoundary( idxtype h ) const { return second[h] == NONE; }
+};
@@ -6,6 +6,9 @@
 
 
 #include "geometry.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -32,6 +35,42 @@ vec3d computeNormal( const point3d& v1, const point3d& v2, const point3d& v3)
     return norm;
 }
 
+void computeFaceNormals(const std::vector<point3d>& vertices,
+                        const std::vector<face>& mesh,
+                        std::vector<vec3d>& faceNormals,
+                        unsigned int threads)
+{
+    faceNormals.resize(mesh.size());
+    parallelFor(
+        mesh.size(),
+        [&](std::size_t i) {
+            const auto& f = mesh[i];
+            faceNormals[i] = computeNormal(vertices[f.v1], vertices[f.v2], vertices[f.v3]);
+        },
+        threads);
+}
+
+void computeNormalLines(const std::vector<point3d>& vertices,
+                        const std::vector<vec3d>& normals,
+                        float length,
+                        std::size_t stride,
+                        std::vector<point3d>& lines,
+                        unsigned int threads)
+{
+    stride = std::max<std::size_t>(stride, 1);
+    const auto count = std::min(vertices.size(), normals.size());
+    const auto numLines = (count + stride - 1) / stride;
+    lines.resize(2 * numLines);
+    parallelFor(
+        numLines,
+        [&](std::size_t i) {
+            const auto& v = vertices[i * stride];
+            lines[2 * i] = v;
+            lines[2 * i + 1] = v + length * normals[i * stride];
+        },
+        threads);
+}
+
 
 //////////////////////////////////////// Nothing to do after this /////////////////////////////////
 
@@ -60,4 +99,140 @@ float angleAtVertex( const point3d& baseV, const point3d& v2, const point3d& v3
     {
         return ( std::acos( e1.dot( e2 ) / (e1.norm( ) * e2.norm( )) ));
     }
-}
\ No newline at end of file
+}
+
+namespace
+{
+
+/**
+ * The angle between two edges sharing a vertex, same as angleAtVertex but inlined and without
+ * any warning in the degenerate cases, where it is 0
+ * @param[in] e1 the first edge
+ * @param[in] e2 the second edge
+ * @return the angle in radiants
+ */
+inline float cornerAngle(const vec3d& e1, const vec3d& e2)
+{
+    const float dot = e1.x * e2.x + e1.y * e2.y + e1.z * e2.z;
+    const float n1 = std::sqrt(e1.x * e1.x + e1.y * e1.y + e1.z * e1.z);
+    const float n2 = std::sqrt(e2.x * e2.x + e2.y * e2.y + e2.z * e2.z);
+    const float c = dot / (n1 * n2);
+    return (std::fabs(c) < 1.f) ? std::acos(c) : 0.f;
+}
+
+/**
+ * Compute the normal of a face weighted by its angle at each of its 3 corners
+ * @param[in] p1 the first vertex
+ * @param[in] p2 the second vertex
+ * @param[in] p3 the third vertex
+ * @param[out] corner the 3 weighted normals
+ */
+inline void cornerNormals(const point3d& p1, const point3d& p2, const point3d& p3, vec3d corner[3])
+{
+    const vec3d norm = computeNormal(p1, p2, p3);
+    corner[0] = norm * cornerAngle(p1 - p2, p1 - p3);
+    corner[1] = norm * cornerAngle(p2 - p1, p2 - p3);
+    corner[2] = norm * cornerAngle(p3 - p1, p3 - p2);
+}
+
+/**
+ * Compute the normal of a face weighted by its angle at one of its corners, same as the
+ * corresponding element computed by cornerNormals()
+ * @param[in] p1 the first vertex
+ * @param[in] p2 the second vertex
+ * @param[in] p3 the third vertex
+ * @param[in] k the corner (0, 1, 2)
+ * @return the weighted normal
+ */
+inline vec3d cornerNormal(const point3d& p1, const point3d& p2, const point3d& p3, std::size_t k)
+{
+    const vec3d norm = computeNormal(p1, p2, p3);
+    switch(k)
+    {
+        case 0: return norm * cornerAngle(p1 - p2, p1 - p3);
+        case 1: return norm * cornerAngle(p2 - p1, p2 - p3);
+        default: return norm * cornerAngle(p3 - p1, p3 - p2);
+    }
+}
+
+/// under this number of faces the normals are accumulated directly, without any threading
+constexpr std::size_t MIN_PARALLEL_FACES{1u << 15};
+
+}  // namespace
+
+void computeVertexNormals(const std::vector<point3d>& vertices,
+                          const std::vector<face>& mesh,
+                          std::vector<vec3d>& normals,
+                          unsigned int threads,
+                          std::pmr::memory_resource* scratch)
+{
+    normals.assign(vertices.size(), vec3d(0, 0, 0));
+
+    if((threadCount(threads) == 1) || (mesh.size() < MIN_PARALLEL_FACES))
+    {
+        // accumulate the contribution of each face
+        for(const auto& f : mesh)
+        {
+            vec3d corner[3];
+            cornerNormals(vertices[f.v1], vertices[f.v2], vertices[f.v3], corner);
+            normals[f.v1] += corner[0];
+            normals[f.v2] += corner[1];
+            normals[f.v3] += corner[2];
+        }
+        for(auto& n : normals)
+        {
+            n.normalize();
+        }
+        return;
+    }
+
+    // gather the contributions of the corners of each vertex, in the order of the faces
+    VertexCorners vertexCorners(scratch);
+    vertexCorners.build(vertices.size(), mesh);
+    parallelFor(
+        vertices.size(),
+        [&](std::size_t v) {
+            vec3d n(0, 0, 0);
+            for(auto c = vertexCorners.offsets[v]; c < vertexCorners.offsets[v + 1]; ++c)
+            {
+                const auto corner = vertexCorners.corners[c];
+                const auto& f = mesh[corner / 3];
+                n += cornerNormal(vertices[f.v1], vertices[f.v2], vertices[f.v3], corner % 3);
+            }
+            n.normalize();
+            normals[v] = n;
+        },
+        threads);
+}
+
+std::vector<edge> uniqueEdges(std::size_t numVertices,
+                              const std::vector<face>& mesh,
+                              unsigned int threads,
+                              std::pmr::memory_resource* scratch)
+{
+    VertexCorners vertexCorners(scratch);
+    vertexCorners.build(numVertices, mesh);
+    EdgeAdjacency adjacency(scratch);
+    adjacency.build(mesh, vertexCorners, 0, threads);
+
+    // each edge is listed by its first half-edge, at its index
+    const auto vertexOf = [&mesh](std::size_t h) -> idxtype {
+        const face& f = mesh[h / 3];
+        return (h % 3 == 0) ? f.v1 : ((h % 3 == 1) ? f.v2 : f.v3);
+    };
+    std::vector<edge> edges(adjacency.numEdges);
+    parallelFor(
+        adjacency.first.size(),
+        [&](std::size_t h) {
+            if(adjacency.first[h] == h)
+            {
+                const auto u = vertexOf(h);
+                const auto v = vertexOf((h % 3 == 2) ? h - 2 : h + 1);
+                edges[adjacency.index[h]] = edge(std::min(u, v), std::max(u, v));
+            }
+        },
+        threads);
+    // the degenerate edges of the degenerate faces are not drawn
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [](const edge& e) { return e.first == e.second; }), edges.end());
+    return edges;
+}
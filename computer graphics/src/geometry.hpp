@@ -19,6 +19,38 @@
  */
 vec3d computeNormal( const point3d& v1, const point3d& v2, const point3d& v3);
 
+/**
+ * Compute the normal of each face of a mesh, the same as computeNormal() on its vertices. The faces
+ * are processed in parallel.
+ *
+ * @param[in] vertices the list of vertices
+ * @param[in] mesh the list of faces
+ * @param[out] faceNormals the normal of each face
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ */
+void computeFaceNormals(const std::vector<point3d>& vertices,
+                        const std::vector<face>& mesh,
+                        std::vector<vec3d>& faceNormals,
+                        unsigned int threads = 0);
+
+/**
+ * Compute the segments showing the normals of the vertices: for each vertex shown, the vertex and the
+ * point at the given distance along its normal. The vertices are processed in parallel.
+ *
+ * @param[in] vertices the list of vertices
+ * @param[in] normals the normal of each vertex
+ * @param[in] length the length of the segments
+ * @param[in] stride only one vertex every stride vertices is shown, 0 is the same as 1
+ * @param[out] lines the two extremities of each segment
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ */
+void computeNormalLines(const std::vector<point3d>& vertices,
+                        const std::vector<vec3d>& normals,
+                        float length,
+                        std::size_t stride,
+                        std::vector<point3d>& lines,
+                        unsigned int threads = 0);
+
 /**
  * Computes the angle at vertex baseV formed by the edges connecting it with the
  * vertices v1 and v2 respectively, ie the baseV-v1 and baseV-v2 edges
@@ -29,4 +61,41 @@ vec3d computeNormal( const point3d& v1, const point3d& v2, const point3d& v3);
  * @param[in] v2 the other vertex of the second edge baseV-v2
  * @return the angle in radiants
  */
-[[nodiscard]] float angleAtVertex(const point3d& baseV, const point3d& v2, const point3d& v3);
\ No newline at end of file
+[[nodiscard]] float angleAtVertex(const point3d& baseV, const point3d& v2, const point3d& v3);
+
+/**
+ * Compute the normal of each vertex as the sum of the normals of the faces sharing it, weighted by the
+ * angle of each face at the vertex, and normalized. The vertices are processed in parallel: the weighted
+ * normals of the face corners of each vertex are computed and summed in the order of the faces, without
+ * storing the contributions of all the corners. Hence the result does not depend on the number of
+ * threads and it is the same as accumulating the contributions face by face.
+ *
+ * @param[in] vertices the list of vertices
+ * @param[in] mesh the list of faces
+ * @param[out] normals the normal of each vertex
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists, released before returning
+ */
+void computeVertexNormals(const std::vector<point3d>& vertices,
+                          const std::vector<face>& mesh,
+                          std::vector<vec3d>& normals,
+                          unsigned int threads = 0,
+                          std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+
+/**
+ * List the edges of a mesh, each of them once whatever the number of faces sharing it. The edges
+ * are given by their canonical pair of vertices, the smaller index first (see edgeKey), in the order
+ * in which they are first met scanning the faces (see EdgeAdjacency). The degenerate edges are
+ * skipped. The result does not depend on the number of threads.
+ *
+ * @param[in] numVertices the number of vertices
+ * @param[in] mesh the list of faces
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists, released before returning
+ * @return the edges
+ */
+[[nodiscard]] std::vector<edge> uniqueEdges(std::size_t numVertices,
+                                            const std::vector<face>& mesh,
+                                            unsigned int threads = 0,
+                                            std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
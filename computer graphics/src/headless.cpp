@@ -0,0 +1,215 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+// Render a model without any display nor GPU, with the software renderer, and save the image
+
+#include "Model.hpp"
+#include "SoftwareRasterizer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Draw the axes and their letters as DrawAxis() in the visualizer
+ * @param[in,out] rasterizer the software renderer
+ * @param[in] scale the length of the axes
+ */
+void drawAxis(SoftwareRasterizer& rasterizer, float scale)
+{
+    const auto scaled = [scale](std::vector<point3d> points) {
+        for(auto& p : points)
+        {
+            p.scale(scale);
+        }
+        return points;
+    };
+    // the x axis and the letter X
+    rasterizer.drawLines(scaled({{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {.8f, .05f, 0.f}, {1.f, .25f, 0.f}, {.8f, .25f, 0.f}, {1.f, .05f, 0.f}}),
+                         v3f(1.f, 0.f, 0.f), 1.f);
+    // the y axis
+    rasterizer.drawLines(scaled({{0.f, 0.f, 0.f}, {0.f, 1.f, 0.f}}), v3f(0.f, 1.f, 0.f), 1.f);
+    // the z axis and the letter Z
+    rasterizer.drawLines(scaled({{0.f, 0.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, .05f, .8f}, {0.f, .05f, 1.f}, {0.f, .05f, 1.f}, {0.f, .25f, .8f},
+                                 {0.f, .25f, .8f}, {0.f, .25f, 1.f}}),
+                         v3f(0.f, 0.f, 1.f), 1.f);
+}
+
+/**
+ * Draw the scene of the visualizer
+ * @param[in,out] rasterizer the software renderer
+ * @param[in,out] model the model
+ * @param[in] params the rendering parameters
+ */
+void display(SoftwareRasterizer& rasterizer, Model& model, const RenderingParameters& params)
+{
+    rasterizer.clear();
+    drawAxis(rasterizer, 1.f);
+    model.rasterize(rasterizer, params);
+}
+
+/**
+ * Print the command line options
+ * @param[in] program the name of the program
+ */
+void printUsage(const std::string& program)
+{
+    std::cout << "Usage:\n\t" << program << " <obj or ply file> [options]\n"
+              << "options:\n"
+              << "\t --output <file> - the image to write, PNG if its name ends with .png, PPM otherwise (render.png)\n"
+              << "\t --size <width> <height> - the size of the image (1024 760)\n"
+              << "\t --angle-x <degrees>, --angle-y <degrees> - rotate around the object\n"
+              << "\t --distance <distance> - the distance of the object (5)\n"
+              << "\t --smooth - smooth shading instead of flat shading\n"
+              << "\t --no-solid - do not draw the faces\n"
+              << "\t --no-wireframe - do not draw the wireframe\n"
+              << "\t --normals - draw the normals, see --normal-length and --normal-stride of the visualizer\n"
+              << "\t --subdiv <level> - draw a subdivision level\n"
+              << "\t --weld, --file-normals, --subdiv-budget <MiB>, --normal-length <length>, --normal-stride <k> - as the visualizer\n"
+              << "\t --threads <count> - the number of threads drawing, all the hardware threads by default\n"
+              << "\t --frames <count> - draw the scene several times and print the frame rate\n"
+              << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    LoadParameters loadParams;
+    RenderingParameters params;
+    Camera camera;
+    std::string output{"render.png"};
+    std::size_t width{1024};
+    std::size_t height{760};
+    unsigned int threads{0};
+    unsigned long frames{1};
+
+    for(int i = 2; i < argc; ++i)
+    {
+        const std::string option(argv[i]);
+        const bool hasValue = (i + 1 < argc);
+        if((option == "--output") && hasValue)
+        {
+            output = argv[++i];
+        }
+        else if((option == "--size") && (i + 2 < argc))
+        {
+            width = std::strtoul(argv[++i], nullptr, 10);
+            height = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if((option == "--angle-x") && hasValue)
+        {
+            camera.angleX = std::strtof(argv[++i], nullptr);
+        }
+        else if((option == "--angle-y") && hasValue)
+        {
+            camera.angleY = std::strtof(argv[++i], nullptr);
+        }
+        else if((option == "--distance") && hasValue)
+        {
+            camera.distance = std::strtof(argv[++i], nullptr);
+        }
+        else if(option == "--smooth")
+        {
+            params.smooth = true;
+        }
+        else if(option == "--no-solid")
+        {
+            params.solid = false;
+        }
+        else if(option == "--no-wireframe")
+        {
+            params.wireframe = false;
+        }
+        else if(option == "--normals")
+        {
+            params.normals = true;
+        }
+        else if((option == "--subdiv") && hasValue)
+        {
+            params.subdivision = true;
+            params.subdivLevel = static_cast<unsigned short>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(option == "--weld")
+        {
+            loadParams.weld = true;
+        }
+        else if(option == "--file-normals")
+        {
+            loadParams.useFileAttributes = true;
+        }
+        else if((option == "--subdiv-budget") && hasValue)
+        {
+            params.subdivisionBudget = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10)) << 20u;
+        }
+        else if((option == "--normal-length") && hasValue)
+        {
+            params.normalLength = std::strtof(argv[++i], nullptr);
+        }
+        else if((option == "--normal-stride") && hasValue)
+        {
+            params.normalStride = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if((option == "--threads") && hasValue)
+        {
+            threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if((option == "--frames") && hasValue)
+        {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            std::cerr << "Unknown option " << option << std::endl;
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Model model;
+    if(!model.load(argv[1], loadParams))
+    {
+        std::cerr << "Unable to load " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    model.unitizeModel();
+
+    SoftwareRasterizer rasterizer(width, height, threads);
+    rasterizer.setCamera(camera);
+
+    // the subdivision level is computed in background, the first drawing requests it
+    display(rasterizer, model, params);
+    model.waitSubdivision();
+
+    namespace chr = std::chrono;
+    const auto start = chr::steady_clock::now();
+    for(unsigned long frame = 0; frame < frames; ++frame)
+    {
+        display(rasterizer, model, params);
+    }
+    const auto seconds = chr::duration<double>(chr::steady_clock::now() - start).count();
+    std::cout << "Rendered " << frames << " frame(s) of " << rasterizer.width() << "x" << rasterizer.height() << " with "
+              << rasterizer.threads() << " thread(s): " << 1000. * seconds / static_cast<double>(frames) << " ms per frame, "
+              << static_cast<double>(frames) / seconds << " FPS" << std::endl;
+
+    if(!rasterizer.save(output))
+    {
+        return EXIT_FAILURE;
+    }
+    std::cout << "Saved " << output << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+/// the number of bytes of a pixel in the images to save
+constexpr std::size_t RGBA_BYTES{4};
+/// the number of bytes of a pixel in the files
+constexpr std::size_t RGB_BYTES{3};
+/// the largest block of a deflate stream without compression
+constexpr std::size_t STORED_BLOCK_SIZE{65535};
+
+/**
+ * Check the size of the image
+ * @param[in] filename The name of the file, for the error message
+ * @param[in] width The width of the image
+ * @param[in] height The height of the image
+ * @param[in] rgba The pixels
+ * @return true if there is a pixel for each position
+ */
+bool checkSize(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba)
+{
+    if(rgba.size() != width * height * RGBA_BYTES)
+    {
+        std::cerr << "Unable to write " << filename << ": the image has " << rgba.size() << " bytes instead of "
+                  << width * height * RGBA_BYTES << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Return the rows of the image from the top one, in RGB, each preceded by the given number of zeros
+ * @param[in] width The width of the image
+ * @param[in] height The height of the image
+ * @param[in] rgba The pixels, row by row from the bottom one
+ * @param[in] prefix The number of zeros before each row
+ * @return the rows
+ */
+std::vector<unsigned char> topDownRgb(std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba, std::size_t prefix)
+{
+    const auto rowSize = prefix + width * RGB_BYTES;
+    std::vector<unsigned char> rows(rowSize * height, 0);
+    for(std::size_t y = 0; y < height; ++y)
+    {
+        const auto* src = rgba.data() + (height - 1 - y) * width * RGBA_BYTES;
+        auto* dst = rows.data() + y * rowSize + prefix;
+        for(std::size_t x = 0; x < width; ++x, src += RGBA_BYTES, dst += RGB_BYTES)
+        {
+            std::copy(src, src + RGB_BYTES, dst);
+        }
+    }
+    return rows;
+}
+
+/**
+ * Compute the CRC of a PNG chunk
+ * @param[in] begin the first byte
+ * @param[in] end past the last byte
+ * @return the CRC-32
+ */
+std::uint32_t crc32(const unsigned char* begin, const unsigned char* end)
+{
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for(std::uint32_t n = 0; n < t.size(); ++n)
+        {
+            auto c = n;
+            for(int k = 0; k < 8; ++k)
+            {
+                c = (c & 1u) ? (0xedb88320u ^ (c >> 1u)) : (c >> 1u);
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    std::uint32_t crc{0xffffffffu};
+    for(auto* p = begin; p != end; ++p)
+    {
+        crc = table[(crc ^ *p) & 0xffu] ^ (crc >> 8u);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+/**
+ * Append a 32-bit integer in big-endian order
+ * @param[in,out] out the bytes
+ * @param[in] value the integer
+ */
+void appendBigEndian(std::vector<unsigned char>& out, std::uint32_t value)
+{
+    for(unsigned int shift = 24;; shift -= 8)
+    {
+        out.push_back(static_cast<unsigned char>((value >> shift) & 0xffu));
+        if(shift == 0)
+            break;
+    }
+}
+
+/**
+ * Append a PNG chunk
+ * @param[in,out] out the bytes of the file
+ * @param[in] type the type of the chunk
+ * @param[in] data the content of the chunk
+ */
+void appendChunk(std::vector<unsigned char>& out, const char (&type)[5], const std::vector<unsigned char>& data)
+{
+    appendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+    const auto start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendBigEndian(out, crc32(out.data() + start, out.data() + out.size()));
+}
+
+/**
+ * Wrap the data in a zlib stream made of deflate blocks without compression
+ * @param[in] data the data
+ * @return the zlib stream
+ */
+std::vector<unsigned char> zlibStored(const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> out{0x78, 0x01};
+    out.reserve(data.size() + (data.size() / STORED_BLOCK_SIZE + 1) * 5 + 6);
+    std::size_t offset{0};
+    do
+    {
+        const auto size = std::min(STORED_BLOCK_SIZE, data.size() - offset);
+        const bool last = (offset + size == data.size());
+        out.push_back(last ? 1 : 0);
+        out.push_back(static_cast<unsigned char>(size & 0xffu));
+        out.push_back(static_cast<unsigned char>(size >> 8u));
+        out.push_back(static_cast<unsigned char>(~size & 0xffu));
+        out.push_back(static_cast<unsigned char>((~size >> 8u) & 0xffu));
+        out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(offset), data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += size;
+    } while(offset < data.size());
+
+    // the Adler-32 checksum of the data
+    std::uint32_t a{1};
+    std::uint32_t b{0};
+    for(const auto byte : data)
+    {
+        a = (a + byte) % 65521u;
+        b = (b + a) % 65521u;
+    }
+    appendBigEndian(out, (b << 16u) | a);
+    return out;
+}
+
+/**
+ * Write the bytes in a file
+ * @param[in] filename The name of the file
+ * @param[in] header The first bytes
+ * @param[in] data The following bytes
+ * @return true if everything went well, false otherwise
+ */
+bool writeFile(const std::string& filename, const std::string& header, const std::vector<unsigned char>& data)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if(out)
+    {
+        out << header;
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+    if(!out)
+    {
+        std::cerr << "Unable to write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool writePpm(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba)
+{
+    if(!checkSize(filename, width, height, rgba))
+    {
+        return false;
+    }
+    const auto header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    return writeFile(filename, header, topDownRgb(width, height, rgba, 0));
+}
+
+bool writePng(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba)
+{
+    if(!checkSize(filename, width, height, rgba))
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<unsigned char> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(width));
+    appendBigEndian(header, static_cast<std::uint32_t>(height));
+    // 8 bits per channel, RGB, default compression, filter and no interlacing
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+    appendChunk(png, "IHDR", header);
+    // each row starts with its filter, none
+    appendChunk(png, "IDAT", zlibStored(topDownRgb(width, height, rgba, 1)));
+    appendChunk(png, "IEND", {});
+    return writeFile(filename, "", png);
+}
+
+bool writeImage(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba)
+{
+    auto extension = std::filesystem::path(filename).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    return (extension == ".png") ? writePng(filename, width, height, rgba) : writePpm(filename, width, height, rgba);
+}
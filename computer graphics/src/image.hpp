@@ -0,0 +1,44 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Save an image in a binary PPM file (P6)
+ *
+ * @param[in] filename The name of the file
+ * @param[in] width The width of the image
+ * @param[in] height The height of the image
+ * @param[in] rgba The pixels, 4 bytes each, row by row from the bottom one as read by glReadPixels; the alpha is dropped
+ * @return true if everything went well, false otherwise
+ */
+bool writePpm(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba);
+
+/**
+ * Save an image in a PNG file, in RGB and without compression so that no external library is needed
+ *
+ * @param[in] filename The name of the file
+ * @param[in] width The width of the image
+ * @param[in] height The height of the image
+ * @param[in] rgba The pixels, 4 bytes each, row by row from the bottom one as read by glReadPixels; the alpha is dropped
+ * @return true if everything went well, false otherwise
+ */
+bool writePng(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba);
+
+/**
+ * Save an image in a PNG file if the name ends with .png, in a PPM file otherwise
+ *
+ * @param[in] filename The name of the file
+ * @param[in] width The width of the image
+ * @param[in] height The height of the image
+ * @param[in] rgba The pixels, 4 bytes each, row by row from the bottom one as read by glReadPixels
+ * @return true if everything went well, false otherwise
+ */
+bool writeImage(const std::string& filename, std::size_t width, std::size_t height, const std::vector<unsigned char>& rgba);
@@ -6,273 +6,866 @@
 
 #include "loop.hpp"
 #include "geometry.hpp"
+#include "parallel.hpp"
+#include "ScratchArena.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+
+/// the minimum number of elements (faces, edges or vertices) processed by each thread
+constexpr std::size_t GRAIN{4096};
 
 /**
- * Compute the subdivision of the input mesh by applying one step of the Loop algorithm
- *
- * @param[in] origVert The list of the input vertices
- * @param[in] origMesh The input mesh (the vertex indices for each face/triangle)
- * @param[out] destVert The list of the new vertices for the subdivided mesh
- * @param[out] destMesh The new subdivided mesh (the vertex indices for each face/triangle)
- * @param[out] destNorm The new list of normals for each new vertex of the subdivided mesh
+ * Return the number of chunks in which a range is split, so that each of them has at least GRAIN elements
+ * @param[in] size the size of the range
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @return the number of chunks
  */
-void loopSubdivision(const std::vector<point3d>& origVert, //!< the original vertices
-                     const std::vector<face>& origMesh,    //!< the original mesh
-                     std::vector<point3d>& destVert,       //!< the new vertices
-                     std::vector<face>& destMesh,          //!< the new mesh
-                     std::vector<vec3d>& destNorm)         //!< the new normals
+unsigned int chunksFor(std::size_t size, unsigned int threads)
 {
-    // copy the original vertices in destVert
-    destVert = origVert;
-
-    // start fresh with the new mesh
-    destMesh.clear( );
+    return static_cast<unsigned int>(std::min<std::size_t>(threadCount(threads), std::max<std::size_t>(1, size / GRAIN)));
+}
 
-    //    PRINTVAR(destVert);
-    //    PRINTVAR(origVert);
+/// the marker of a missing half-edge
+constexpr idxtype NONE{std::numeric_limits<idxtype>::max( )};
 
-    // create a list of the new vertices created with the reference to the edge
-    EdgeList newVertices;
+/**
+ * Free the memory of a temporary list; the temporary lists are freed as soon as they are no longer
+ * needed, in the reverse order of their allocation so that a ScratchArena can reuse their memory
+ * @param[in,out] table the list to free
+ */
+template <typename Table>
+void release( Table& table )
+{
+    Table( table.get_allocator( ) ).swap( table );
+}
 
+/**
+ * Split each face of a mesh in four faces, joining the new vertices on its edges
+ *
+ * @tparam Faces the type of the list of the new faces
+ * @param[in] origMesh the faces of the mesh
+ * @param[in] numFaces the number of faces of the mesh
+ * @param[in] newIndex for each half-edge, the index of the new vertex on its edge
+ * @param[out] destMesh the new mesh, where the face i becomes the faces 4i, ..., 4i + 3
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ */
+template <typename Faces>
+void splitFaces( const face* origMesh, std::size_t numFaces, const std::pmr::vector<idxtype>& newIndex, Faces& destMesh, unsigned int threads )
+{
     //*********************************************************************
-    // for each face
+    // create the four new triangles of each face
+    // BE CAREFUL WITH THE VERTEX ORDER!!
+    //               v2
+    //               /\
+    //              /  \
+    //             /    \
+    //            a ---- b
+    //           / \     /\
+    //          /   \   /  \
+    //         /     \ /    \
+    //        v1 ---- c ---- v3
+    //
+    // the original triangle was v1-v2-v3, use the same clock-wise order for the other
+    // hence v1-a-c, a-b-c and so on
     //*********************************************************************
-    for (const face& f : origMesh)
+    destMesh.resize( 4 * numFaces );
+    parallelFor(
+        numFaces,
+        [&]( std::size_t i ) {
+            const face& f = origMesh[i];
+            const idxtype a = newIndex[3 * i];
+            const idxtype b = newIndex[3 * i + 1];
+            const idxtype c = newIndex[3 * i + 2];
+            destMesh[4 * i] = face( f.v1, a, c );
+            destMesh[4 * i + 1] = face( a, b, c );
+            destMesh[4 * i + 2] = face( c, b, f.v3 );
+            destMesh[4 * i + 3] = face( a, f.v2, b );
+        },
+        threads );
+}
+
+/**
+ * A memory resource shared by several threads, which forwards the requests to another resource
+ * under a lock; it lets the threads take their own arenas from a single scratch resource
+ */
+class SharedResource : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @param[in] upstream the resource actually allocating the memory
+     */
+    explicit SharedResource( std::pmr::memory_resource* upstream ) : _upstream( upstream ) { }
+
+protected:
+    void* do_allocate( std::size_t bytes, std::size_t alignment ) override
     {
-        //*********************************************************************
-        // get the indices of the triangle vertices
-        //*********************************************************************
-        idxtype v1 = f.v1;
-        idxtype v2 = f.v2;
-        idxtype v3 = f.v3;
-    
-        //*********************************************************************
-        // for each edge get the index of the vertex of the midpoint using getNewVertex
-        //*********************************************************************
+        std::lock_guard<std::mutex> lock( _mutex );
+        return _upstream->allocate( bytes, alignment );
+    }
 
-        idxtype a = getNewVertex({v1, v2}, destVert, origMesh, newVertices);
-        idxtype b = getNewVertex({v2, v3}, destVert, origMesh, newVertices);
-        idxtype c = getNewVertex({v3, v1}, destVert, origMesh, newVertices);
+    void do_deallocate( void* p, std::size_t bytes, std::size_t alignment ) override
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _upstream->deallocate( p, bytes, alignment );
+    }
 
-        //*********************************************************************
-        // create the four new triangles
-        // BE CAREFUL WITH THE VERTEX ORDER!!
-        //               v2
-        //               /\
-        //              /  \
-        //             /    \
-        //            a ---- b
-        //           / \     /\
-        //          /   \   /  \
-        //         /     \ /    \
-        //        v1 ---- c ---- v3
-        //
-        // the original triangle was v1-v2-v3, use the same clock-wise order for the other
-        // hence v1-a-c, a-b-c and so on
-        //*********************************************************************
-        destMesh.push_back(face(v1, a, c));
-        destMesh.push_back(face(a, b, c));
-        destMesh.push_back(face(c, b, v3));
-        destMesh.push_back(face(a, v2, b));
+    bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override { return this == &other; }
 
+private:
+    /// the resource actually allocating the memory
+    std::pmr::memory_resource* _upstream{nullptr};
 
+    /// serializes the requests to the upstream resource
+    std::mutex _mutex;
+};
+
+/**
+ * Compose two linear maps given by their sparse rows (see LoopStencils): each row of the result is
+ * the sum of the rows of the inner map selected by the sources of the corresponding row of the outer
+ * map, multiplied by its weights. The sources of each row of the result are distinct and sorted.
+ * The rows are computed twice, first to count their weights and then to write them at their place,
+ * so that the result is written straight into its lists.
+ *
+ * @param[in] outerOffsets the beginning of each row of the outer map, plus the number of weights
+ * @param[in] outerSources the sources of the outer map, ie the rows of the inner map
+ * @param[in] outerWeights the weights of the outer map
+ * @param[in,out] offsets the beginning of each row of the inner map, then of the result
+ * @param[in,out] sources the sources of the inner map, then of the result
+ * @param[in,out] weights the weights of the inner map, then of the result
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the rows being computed
+ */
+void composeStencils( const std::pmr::vector<std::size_t>& outerOffsets,
+                      const std::pmr::vector<idxtype>& outerSources,
+                      const std::pmr::vector<float>& outerWeights,
+                      std::vector<std::size_t>& offsets,
+                      std::vector<idxtype>& sources,
+                      std::vector<float>& weights,
+                      unsigned int threads,
+                      std::pmr::memory_resource* scratch )
+{
+    const std::size_t numRows = outerOffsets.size( ) - 1;
+    const auto numChunks = chunksFor( numRows, threads );
+
+    using Row = std::pmr::vector<std::pair<idxtype, double>>;
+    // the weights of a row of the result, sorted by source and summed, in the same order whatever
+    // the number of threads
+    const auto composeRow = [&]( std::size_t r, Row& row ) {
+        row.clear( );
+        for ( auto k = outerOffsets[r]; k < outerOffsets[r + 1]; ++k )
+        {
+            const auto j = outerSources[k];
+            for ( auto m = offsets[j]; m < offsets[j + 1]; ++m )
+                row.emplace_back( sources[m], static_cast<double>( outerWeights[k] ) * static_cast<double>( weights[m] ) );
+        }
+        std::sort( row.begin( ), row.end( ) );
+        std::size_t size{0};
+        for ( const auto& entry : row )
+        {
+            if ( ( size > 0 ) && ( row[size - 1].first == entry.first ) )
+                row[size - 1].second += entry.second;
+            else
+                row[size++] = entry;
+        }
+        row.resize( size );
+    };
+
+    // the row of each chunk is taken from the scratch resource through the arena of the chunk
+    SharedResource shared( scratch );
+    std::vector<std::size_t> newOffsets( numRows + 1, 0 );
+    parallelChunks( numRows, numChunks, [&]( std::size_t, std::size_t begin, std::size_t end ) {
+        ScratchArena arena( ScratchArena::DEFAULT_BLOCK_SIZE, &shared );
+        Row row( &arena );
+        for ( auto r = begin; r < end; ++r )
+        {
+            composeRow( r, row );
+            newOffsets[r + 1] = row.size( );
+        }
+    } );
+    for ( std::size_t r = 0; r < numRows; ++r )
+    {
+        newOffsets[r + 1] += newOffsets[r];
     }
 
+    std::vector<idxtype> newSources( newOffsets[numRows] );
+    std::vector<float> newWeights( newOffsets[numRows] );
+    parallelChunks( numRows, numChunks, [&]( std::size_t, std::size_t begin, std::size_t end ) {
+        ScratchArena arena( ScratchArena::DEFAULT_BLOCK_SIZE, &shared );
+        Row row( &arena );
+        for ( auto r = begin; r < end; ++r )
+        {
+            composeRow( r, row );
+            auto k = newOffsets[r];
+            for ( const auto& entry : row )
+            {
+                newSources[k] = entry.first;
+                newWeights[k++] = static_cast<float>( entry.second );
+            }
+        }
+    } );
+    offsets.swap( newOffsets );
+    sources.swap( newSources );
+    weights.swap( newWeights );
+}
+
+/**
+ * Apply one step of the Loop subdivision, without computing the normals
+ *
+ * @tparam Vertices the type of the lists of vertices
+ * @tparam Faces the type of the lists of faces
+ * @param[in] origVert The list of the input vertices
+ * @param[in] origMesh The input mesh (the vertex indices for each face/triangle)
+ * @param[out] destVert The list of the new vertices for the subdivided mesh
+ * @param[out] destMesh The new subdivided mesh (the vertex indices for each face/triangle)
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists
+ */
+template <typename Vertices, typename Faces>
+void loopStep( const Vertices& origVert,
+               const Faces& origMesh,
+               Vertices& destVert,
+               Faces& destMesh,
+               unsigned int threads,
+               std::pmr::memory_resource* scratch )
+{
     //*********************************************************************
-    // Update each "old" vertex using the Loop coefficients. A smart way to do
-    // so is to think in terms of faces than the single vertex: for each face
-    // we update each of the 3 vertices using the Loop formula wrt the other 2 and
-    // sum it to a temporary copy tmp of the vertices (which is initialized to
-    // [0 0 0] at the beginning). We also keep a record of the occurrence of each vertex.
-    // At then end, to get the final vertices we just need to divide each vertex
-    // in tmp by its occurrence
+    // Each edge of the mesh is seen by the corners of the faces sharing it: the corner k
+    // (0, 1, 2) of the face f, with index 3f+k, is the beginning of the half-edge going
+    // from the k-th vertex of the face to the next one, ie v1-v2, v2-v3 and v3-v1.
+    // The new vertex of an edge is numbered in the order in which the edge is first met
+    // scanning the faces, hence the numbering does not depend on the number of threads.
+    // The half-edges starting from each vertex are the corners of the vertex
+    // (see VertexCorners), so the half-edges of an edge are found in constant time (see EdgeAdjacency).
     //*********************************************************************
-
-    // A list containing the occurrence of each vertex
-    std::vector<size_t> occurrences( origVert.size( ), 0 );
-
-    // A list of the same size as origVert with all the elements initialized to [0 0 0]
-    std::vector<point3d> tmp( origVert.size( ) );
+    const std::size_t numVert = origVert.size( );
+    const std::size_t numHalfEdges = 3 * origMesh.size( );
+
+    VertexCorners corners( scratch );
+    corners.build( numVert, origMesh.data( ), origMesh.size( ) );
+
+    // the temporary tables are freed as soon as they are no longer needed (see release()),
+    // hence the peak memory is dominated by the input and output levels
+    EdgeAdjacency adjacency( scratch );
+    adjacency.build( origMesh.data( ), origMesh.size( ), corners, numVert, threads );
+    const std::size_t numEdges = adjacency.numEdges;
+    // for each half-edge, the index of the new vertex of its edge, the first half-edge of its edge
+    // and the first one in another face
+    const auto& newIndex = adjacency.index;
+    const auto& first = adjacency.first;
+    const auto& second = adjacency.second;
+
+    const auto vertexOf = [&origMesh]( std::size_t h ) -> idxtype {
+        const face& f = origMesh[h / 3];
+        return ( h % 3 == 0 ) ? f.v1 : ( ( h % 3 == 1 ) ? f.v2 : f.v3 );
+    };
+    const auto nextOf = []( std::size_t h ) { return ( h % 3 == 2 ) ? h - 2 : h + 1; };
+
+    destVert.resize( numVert + numEdges );
 
     //*********************************************************************
-    // for each face
+    // for each edge compute the new vertex on it
     //*********************************************************************
-    for (const face& f : origMesh)
-    {
-        //*********************************************************************
-        // consider each of the 3 vertices:
-        // 1) increment its occurrence
-        // 2) apply Loop update wrt the other 2 vertices of the face
-        // BE CAREFUL WITH THE COEFFICIENT OF THE OTHER 2 VERTICES!... consider
-        // how many times each vertex is summed in the general case...
-        //*********************************************************************
-        idxtype v1 = f.v1;
-        idxtype v2 = f.v2;
-        idxtype v3 = f.v3;
+    parallelFor(
+        numHalfEdges,
+        [&]( std::size_t h ) {
+            if ( first[h] != h )
+                return;
 
-         // v1
-        occurrences[v1]++;
-        tmp[v1] = tmp[v1] + (origVert[v2] + origVert[v3]);
+            const idxtype v1 = vertexOf( h );
+            const idxtype v2 = vertexOf( nextOf( h ) );
 
-        // v2
-        occurrences[v2]++;
-        tmp[v2] = tmp[v2] + (origVert[v1] + origVert[v3]);
-
-        // v3
-        occurrences[v3]++;
-        tmp[v3] = tmp[v3] + (origVert[v1] + origVert[v2]);
-
-    }
+            //*********************************************************************
+            // check if it is a boundary edge, ie check if there is another triangle
+            // sharing this edge
+            //*********************************************************************
+            const idxtype h2 = second[h];
+
+            point3d nvert;  //!< this will contain the new vertex
+            if ( h2 != NONE )
+            {
+                //*********************************************************************
+                // the new vertex is the linear combination of the two extrema of
+                // the edge V1 and V2 and the two opposite vertices oppV1 and oppV2
+                // Using the loop coefficient the new vertex is
+                // nvert = 3/8 (V1+V2) + 1/8(oppV1 + oppV2)
+                // The opposite vertex of a half-edge is the end of the next one
+                //*********************************************************************
+                const idxtype oppV1 = vertexOf( nextOf( nextOf( h ) ) );
+                const idxtype oppV2 = vertexOf( nextOf( nextOf( h2 ) ) );
+                nvert = ( 3.f / 8.f ) * ( origVert[v1] + origVert[v2] ) + ( 1.f / 8.f ) * ( origVert[oppV1] + origVert[oppV2] );
+            }
+            else
+            {
+                //*********************************************************************
+                // otherwise it is a boundary edge then the vertex is the linear combination of the
+                // two extrema
+                //*********************************************************************
+                nvert = ( origVert[v1] + origVert[v2] ) * 0.5f;
+            }
+            destVert[newIndex[h]] = nvert;
+        },
+        threads );
+    release( adjacency.second );
+    release( adjacency.first );
+
+    splitFaces( origMesh.data( ), origMesh.size( ), newIndex, destMesh, threads );
+    release( adjacency.index );
 
     //*********************************************************************
-    //  To obtain the new vertices, divide each vertex by its occurrence value
+    // Update each "old" vertex using the Loop coefficients: each face the vertex
+    // belongs to adds the other 2 vertices of the face, then the sum is divided by
+    // the occurrence of the vertex, ie the number of its corners.
+    // The corners of each vertex are summed in the order of the faces, hence the result
+    // does not depend on the number of threads.
     //*********************************************************************
+    parallelFor(
+        numVert,
+        [&]( std::size_t i ) {
+            const auto occurrences = corners.offsets[i + 1] - corners.offsets[i];
+            assert( occurrences != 0 );
+
+            point3d tmp;
+            for ( auto c = corners.offsets[i]; c < corners.offsets[i + 1]; ++c )
+            {
+                const face& f = origMesh[corners.corners[c] / 3];
+                switch ( corners.corners[c] % 3 )
+                {
+                    case 0: tmp = tmp + ( origVert[f.v2] + origVert[f.v3] ); break;
+                    case 1: tmp = tmp + ( origVert[f.v1] + origVert[f.v3] ); break;
+                    default: tmp = tmp + ( origVert[f.v1] + origVert[f.v2] ); break;
+                }
+            }
+            destVert[i] = ( 5.0f / 8.0f ) * origVert[i] + tmp * ( 3.0f / ( 16.0f * (float) occurrences ) );
+        },
+        threads );
+    release( corners.corners );
+    release( corners.offsets );
+}
 
-    for (size_t i = 0; i < origVert.size(); ++i) {
-        assert( occurrences[i] != 0 );
-        destVert[i] = (5.0f / 8.0f) * origVert[i] + tmp[i]* (3.0f / (16.0f * (float)occurrences[i]));
-    }
-    
-    //PRINTVAR(destVert);
+/// the number of faces of the final level subdivided at once by the direct subdivision, so that
+/// the working set of a patch stays within the cache
+constexpr std::size_t PATCH_FACES{1u << 16};
 
-    // redo the normals, reset and create a list of normals of the same size as
-    // the vertices, each normal set to [0 0 0]
-    destNorm.clear( );
-    destNorm = std::vector<vec3d>(destVert.size( ));
+/**
+ * The position of a vertex of the subdivision of a face, as the weights of the three corners of
+ * the face, which sum to 2^levels
+ */
+struct Barycentric
+{
+    /// the weight of the first corner
+    idxtype w1{0};
+    /// the weight of the second corner
+    idxtype w2{0};
+    /// the weight of the third corner
+    idxtype w3{0};
 
-    //*********************************************************************
-    //  Recompute the normals for each face
-    //*********************************************************************
-    for (const auto& f : destMesh)
+    Barycentric() = default;
 
-    {
-        //*********************************************************************
-        //  Calculate the normal of the triangles, it will be the same for each vertex
-        //*********************************************************************
-        vec3d norm = computeNormal(destVert[f.v1], destVert[f.v2], destVert[f.v3]);
+    Barycentric( idxtype a, idxtype b, idxtype c ) : w1( a ), w2( b ), w3( c ) { }
+};
 
+/**
+ * Return the midpoint of two positions
+ * @param[in] a the first position
+ * @param[in] b the second position
+ * @return the midpoint
+ */
+Barycentric midpoint( const Barycentric& a, const Barycentric& b )
+{
+    return {static_cast<idxtype>( ( a.w1 + b.w1 ) / 2 ), static_cast<idxtype>( ( a.w2 + b.w2 ) / 2 ),
+            static_cast<idxtype>( ( a.w3 + b.w3 ) / 2 )};
+}
 
-        //*********************************************************************
-        // Sum the normal of the face to each vertex normal using the angleAtVertex as weight
-        //*********************************************************************
-        destNorm[f.v1] += angleAtVertex(destVert[f.v1], destVert[f.v2], destVert[f.v3]) * norm;
-        destNorm[f.v2] += angleAtVertex(destVert[f.v2], destVert[f.v3], destVert[f.v1]) * norm;
-        destNorm[f.v3] += angleAtVertex(destVert[f.v3], destVert[f.v1], destVert[f.v2]) * norm;
+}  // namespace
 
+/**
+ * Compute the subdivision of the input mesh by applying one step of the Loop algorithm
+ *
+ * @param[in] origVert The list of the input vertices
+ * @param[in] origMesh The input mesh (the vertex indices for each face/triangle)
+ * @param[out] destVert The list of the new vertices for the subdivided mesh
+ * @param[out] destMesh The new subdivided mesh (the vertex indices for each face/triangle)
+ * @param[out] destNorm The new list of normals for each new vertex of the subdivided mesh
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists
+ */
+void loopSubdivision(const std::vector<point3d>& origVert, //!< the original vertices
+                     const std::vector<face>& origMesh,    //!< the original mesh
+                     std::vector<point3d>& destVert,       //!< the new vertices
+                     std::vector<face>& destMesh,          //!< the new mesh
+                     std::vector<vec3d>& destNorm,         //!< the new normals
+                     unsigned int threads,
+                     std::pmr::memory_resource* scratch)
+{
+    loopStep( origVert, origMesh, destVert, destMesh, threads, scratch );
 
-    }
     //*********************************************************************
-    // normalize the normals of each vertex
+    //  Recompute the normals of the new mesh
     //*********************************************************************
+    computeVertexNormals( destVert, destMesh, destNorm, threads, scratch );
+}
 
+bool loopSubdivision( const std::vector<point3d>& origVert,
+                      const std::vector<face>& origMesh,
+                      unsigned short levels,
+                      std::vector<point3d>& destVert,
+                      std::vector<face>& destMesh,
+                      std::vector<vec3d>& destNorm,
+                      unsigned int threads,
+                      std::pmr::memory_resource* scratch,
+                      const std::atomic<bool>* cancel )
+{
+    const auto cancelled = [cancel]( ) { return ( cancel != nullptr ) && cancel->load( std::memory_order_relaxed ); };
+    if ( cancelled( ) )
+        return false;
 
-    for (vec3d& norm : destNorm)
+    if ( levels <= 1 )
     {
-        norm.normalize();
+        if ( levels == 1 )
+        {
+            loopSubdivision( origVert, origMesh, destVert, destMesh, destNorm, threads, scratch );
+            return true;
+        }
+        destVert = origVert;
+        destMesh = origMesh;
+        computeVertexNormals( destVert, destMesh, destNorm, threads, scratch );
+        return true;
     }
-    
 
-}
+    //*********************************************************************
+    // The faces are subdivided in patches of consecutive faces: as the subdivision of a face only
+    // depends on the faces sharing a vertex with it (its one-ring), each patch is subdivided along
+    // with its one-ring up to the final level, then the subdivision of the faces of the patch is
+    // copied to the output. The faces of the one-ring are kept in the order of the mesh, hence
+    // the new vertices are computed exactly as in the subdivision of the whole mesh.
+    // The faces of the final level are numbered as in the subdivision level by level: the face f
+    // becomes the faces 4^levels * f, ..., 4^levels * (f + 1) - 1. The vertices are numbered by
+    // their position in the original mesh: first the original vertices, then the 2^levels - 1
+    // vertices on each original edge (in the order of the edges, from the origin of the first
+    // half-edge of the edge), then the vertices inside each original face, in the order of the faces.
+    //*********************************************************************
+    const std::size_t numVert = origVert.size( );
+    const std::size_t numFaces = origMesh.size( );
+    const idxtype side = idxtype{1} << levels;                        //!< the number of segments on each original edge
+    const std::size_t subFaces = std::size_t{1} << ( 2 * levels );    //!< the number of faces of each original face
+    const std::size_t innerVertices = ( side - 1 ) * ( side - 2 ) / 2;  //!< the number of vertices inside each original face
+
+    VertexCorners corners( scratch );
+    corners.build( numVert, origMesh );
+    EdgeAdjacency adjacency( scratch );
+    adjacency.build( origMesh, corners, 0, threads );
+    release( adjacency.second );
+    const std::size_t numEdges = adjacency.numEdges;
+    const auto& edgeIndex = adjacency.index;
+    const auto& first = adjacency.first;
+
+    const std::size_t innerBegin = numVert + numEdges * ( side - 1 );
+    assert( innerBegin + numFaces * innerVertices < NONE );
+    assert( 3 * numFaces * subFaces < NONE );
+    destVert.resize( innerBegin + numFaces * innerVertices );
+    destMesh.resize( numFaces * subFaces );
+
+    // the positions of the corners of the faces of a subdivided face, following the split of
+    // each face in four of loopStep()
+    std::pmr::vector<Barycentric> pattern( 3 * subFaces, scratch );
+    for ( std::size_t d = 0; d < subFaces; ++d )
+    {
+        Barycentric p1( side, 0, 0 );
+        Barycentric p2( 0, side, 0 );
+        Barycentric p3( 0, 0, side );
+        for ( auto l = levels; l-- > 0; )
+        {
+            const auto a = midpoint( p1, p2 );
+            const auto b = midpoint( p2, p3 );
+            const auto c = midpoint( p3, p1 );
+            switch ( ( d >> ( 2 * l ) ) & 3 )
+            {
+                case 0: p2 = a; p3 = c; break;
+                case 1: p1 = a; p2 = b; p3 = c; break;
+                case 2: p1 = c; p2 = b; break;
+                default: p1 = a; p3 = b; break;
+            }
+        }
+        pattern[3 * d] = p1;
+        pattern[3 * d + 1] = p2;
+        pattern[3 * d + 2] = p3;
+    }
 
-/**
- * For a given edge it returns the index of the new vertex created on its middle point.
- * If such vertex already exists it just returns the its index; if it does not exist
- * it creates it in vertList along it's normal and return the index
- *
- * @param[in] e the edge
- * @param[in,out] vertList the list of vertices
- * @param[in] mesh the list of triangles
- * @param[in,out] newVertList The list of the new vertices added so far
- * @return the index of the new vertex or the one that has been already created for that edge
- * @see EdgeList
- */
-idxtype getNewVertex(const edge& e,
-                    std::vector<point3d>& vertList,
-                    const std::vector<face>& mesh,
-                    EdgeList& newVertList)
-{
-    //    PRINTVAR(e);
-    //    PRINTVAR(newVertList);
+    const auto vertexOf = [&origMesh]( std::size_t h ) -> idxtype {
+        const face& f = origMesh[h / 3];
+        return ( h % 3 == 0 ) ? f.v1 : ( ( h % 3 == 1 ) ? f.v2 : f.v3 );
+    };
+
+    // the index of a vertex of the subdivision of the face f, which is owned by the first face
+    // containing it: only the owner writes the vertex, so each vertex is written by one thread
+    const auto globalIndex = [&]( std::size_t f, const Barycentric& p, bool& owned ) -> idxtype {
+        const face& g = origMesh[f];
+        const auto vertex = [&]( idxtype v ) {
+            owned = ( corners.corners[corners.offsets[v]] / 3 == f );
+            return v;
+        };
+        if ( p.w1 == side )
+            return vertex( g.v1 );
+        if ( p.w2 == side )
+            return vertex( g.v2 );
+        if ( p.w3 == side )
+            return vertex( g.v3 );
+
+        // a vertex on an edge: the half-edge of the face and the weight of its end
+        std::size_t h{0};
+        idxtype toEnd{0};
+        if ( p.w3 == 0 )
+        {
+            h = 3 * f;
+            toEnd = p.w2;
+        }
+        else if ( p.w1 == 0 )
+        {
+            h = 3 * f + 1;
+            toEnd = p.w3;
+        }
+        else if ( p.w2 == 0 )
+        {
+            h = 3 * f + 2;
+            toEnd = p.w1;
+        }
+        else
+        {
+            owned = true;
+            const std::size_t row = p.w2 - 1;
+            return static_cast<idxtype>( innerBegin + f * innerVertices + row * ( side - 1 ) - row * ( row + 1 ) / 2 + p.w3 - 1 );
+        }
+        const auto h1 = first[h];
+        owned = ( h1 / 3 == f );
+        const idxtype position = ( vertexOf( h1 ) == vertexOf( h ) ) ? toEnd : side - toEnd;
+        return static_cast<idxtype>( numVert + edgeIndex[h] * std::size_t{side - 1u} + position - 1 );
+    };
 
     //*********************************************************************
-    // if the egde is NOT contained in the new vertex list (see EdgeList.contains() method)
+    // group the faces in compact patches, so that their one-rings overlap as much as possible:
+    // each patch is grown from the first face not in a patch yet, adding the faces sharing a
+    // vertex with the faces already in the patch
     //*********************************************************************
-    if (!newVertList.contains(e))
+    const std::size_t patchSize = std::max<std::size_t>( 1, PATCH_FACES / subFaces );
+    std::pmr::vector<idxtype> patchOrder( scratch );       //!< the faces of the patches, one patch after the other
+    std::pmr::vector<std::size_t> patchBegin( scratch );  //!< the beginning of each patch in patchOrder, then the number of faces
+    patchOrder.reserve( numFaces );
     {
-        //*********************************************************************
-        // generate new index (vertex.size)
-        //*********************************************************************
-        idxtype newIndex = (idxtype) vertList.size();
+        std::pmr::vector<char> grouped( numFaces, 0, scratch );
+        std::size_t seed{0};
+        while ( patchOrder.size( ) < numFaces )
+        {
+            while ( grouped[seed] )
+                ++seed;
+            const auto begin = patchOrder.size( );
+            patchBegin.push_back( begin );
+            grouped[seed] = 1;
+            patchOrder.push_back( static_cast<idxtype>( seed ) );
+            for ( auto next = begin; ( next < patchOrder.size( ) ) && ( patchOrder.size( ) - begin < patchSize ); ++next )
+            {
+                const face& g = origMesh[patchOrder[next]];
+                for ( const auto v : {g.v1, g.v2, g.v3} )
+                {
+                    for ( auto c = corners.offsets[v]; ( c < corners.offsets[v + 1] ) && ( patchOrder.size( ) - begin < patchSize ); ++c )
+                    {
+                        const auto f = corners.corners[c] / 3;
+                        if ( !grouped[f] )
+                        {
+                            grouped[f] = 1;
+                            patchOrder.push_back( f );
+                        }
+                    }
+                }
+            }
+        }
+        patchBegin.push_back( numFaces );
+    }
+    const std::size_t numPatches = patchBegin.size( ) - 1;
+
+    // the memory of the chunks is taken from the scratch resource as well, through the arenas of the chunks
+    SharedResource shared( scratch );
+    const auto numChunks = static_cast<unsigned int>( std::min<std::size_t>( threadCount( threads ), numPatches ) );
+    parallelChunks( numPatches, numChunks, [&]( std::size_t, std::size_t beginPatch, std::size_t endPatch ) {
+        // the buffers are reused by all the patches of the chunk, the temporary lists of each
+        // step are in a separate arena emptied before the next step
+        ScratchArena buffers( ScratchArena::DEFAULT_BLOCK_SIZE, &shared );
+        ScratchArena arena( ScratchArena::DEFAULT_BLOCK_SIZE, &shared );
+        std::pmr::vector<idxtype> patchFaces( &buffers );
+        std::pmr::vector<idxtype> localVertices( &buffers );  //!< the vertices of the patch, sorted
+        std::pmr::vector<point3d> vertices( &buffers ), nextVertices( &buffers );
+        std::pmr::vector<face> mesh( &buffers ), nextMesh( &buffers );
+        // the local index of a vertex of the patch: the buffers only grow with the size of the
+        // patches, not with the size of the mesh
+        const auto local = [&]( idxtype v ) {
+            return static_cast<idxtype>( std::lower_bound( localVertices.begin( ), localVertices.end( ), v ) - localVertices.begin( ) );
+        };
+
+        for ( auto patch = beginPatch; ( patch < endPatch ) && !cancelled( ); ++patch )
+        {
+            const auto beginFace = patchOrder.begin( ) + static_cast<std::ptrdiff_t>( patchBegin[patch] );
+            const auto endFace = patchOrder.begin( ) + static_cast<std::ptrdiff_t>( patchBegin[patch + 1] );
+
+            // the faces of the patch and their one-ring, in the order of the mesh
+            patchFaces.clear( );
+            for ( auto it = beginFace; it != endFace; ++it )
+            {
+                const std::size_t f = *it;
+                for ( const auto v : {origMesh[f].v1, origMesh[f].v2, origMesh[f].v3} )
+                {
+                    for ( auto c = corners.offsets[v]; c < corners.offsets[v + 1]; ++c )
+                        patchFaces.push_back( corners.corners[c] / 3 );
+                }
+            }
+            std::sort( patchFaces.begin( ), patchFaces.end( ) );
+            patchFaces.erase( std::unique( patchFaces.begin( ), patchFaces.end( ) ), patchFaces.end( ) );
+
+            // the vertices of those faces, numbered in increasing order: the numbering does not change
+            // the subdivision, which only depends on the order of the faces
+            localVertices.clear( );
+            for ( const auto f : patchFaces )
+            {
+                localVertices.push_back( origMesh[f].v1 );
+                localVertices.push_back( origMesh[f].v2 );
+                localVertices.push_back( origMesh[f].v3 );
+            }
+            std::sort( localVertices.begin( ), localVertices.end( ) );
+            localVertices.erase( std::unique( localVertices.begin( ), localVertices.end( ) ), localVertices.end( ) );
+
+            mesh.resize( patchFaces.size( ) );
+            for ( std::size_t i = 0; i < patchFaces.size( ); ++i )
+            {
+                const face& g = origMesh[patchFaces[i]];
+                mesh[i] = face( local( g.v1 ), local( g.v2 ), local( g.v3 ) );
+            }
+            vertices.resize( localVertices.size( ) );
+            for ( std::size_t i = 0; i < localVertices.size( ); ++i )
+            {
+                vertices[i] = origVert[localVertices[i]];
+            }
+
+            for ( unsigned short l = 0; l < levels; ++l )
+            {
+                arena.reset( );
+                loopStep( vertices, mesh, nextVertices, nextMesh, 1, &arena );
+                vertices.swap( nextVertices );
+                mesh.swap( nextMesh );
+            }
+
+            // copy the subdivision of the faces of the patch
+            for ( auto it = beginFace; it != endFace; ++it )
+            {
+                const std::size_t f = *it;
+                const auto lf = static_cast<std::size_t>( std::lower_bound( patchFaces.begin( ), patchFaces.end( ), f ) - patchFaces.begin( ) );
+                for ( std::size_t d = 0; d < subFaces; ++d )
+                {
+                    const face& lface = mesh[lf * subFaces + d];
+                    const idxtype localIndex[3] = {lface.v1, lface.v2, lface.v3};
+                    idxtype index[3];
+                    for ( std::size_t k = 0; k < 3; ++k )
+                    {
+                        bool owned{false};
+                        index[k] = globalIndex( f, pattern[3 * d + k], owned );
+                        if ( owned )
+                            destVert[index[k]] = vertices[localIndex[k]];
+                    }
+                    destMesh[f * subFaces + d] = face( index[0], index[1], index[2] );
+                }
+            }
+        }
+    } );
+    if ( cancelled( ) )
+        return false;
 
+    // the vertices not referenced by any face are left as they are
+    for ( std::size_t v = 0; v < numVert; ++v )
+    {
+        if ( corners.offsets[v] == corners.offsets[v + 1] )
+            destVert[v] = origVert[v];
+    }
 
-        //*********************************************************************
-        // add the edge and index to the newVertList
-        //*********************************************************************
+    release( patchBegin );
+    release( patchOrder );
+    release( pattern );
+    release( adjacency.first );
+    release( adjacency.index );
+    release( corners.corners );
+    release( corners.offsets );
 
-        newVertList.add(e, newIndex);
+    //*********************************************************************
+    //  Compute the normals of the final level
+    //*********************************************************************
+    computeVertexNormals( destVert, destMesh, destNorm, threads, scratch );
+    return true;
+}
 
-        // generate new vertex
-        point3d nvert;        //!< this will contain the new vertex
-        idxtype oppV1;        //!< the index of the first "opposite" vertex
-        idxtype oppV2;        //!< the index of the second "opposite" vertex (if it exists)
+void LoopStencils::build( std::size_t numVertices,
+                          const std::vector<face>& mesh,
+                          unsigned short levels,
+                          unsigned int threads,
+                          std::pmr::memory_resource* scratch )
+{
+    // start from the identity
+    _numInputVertices = numVertices;
+    _offsets.resize( numVertices + 1 );
+    _sources.resize( numVertices );
+    _weights.assign( numVertices, 1.f );
+    for ( std::size_t i = 0; i < numVertices; ++i )
+    {
+        _offsets[i] = i;
+        _sources[i] = static_cast<idxtype>( i );
+    }
+    _offsets[numVertices] = numVertices;
+    if ( levels == 0 )
+    {
+        _mesh = mesh;
+        return;
+    }
 
+    // the faces of the intermediate levels are kept in an arena, the temporary lists of each step
+    // in another one emptied before the next step, both taken from the scratch resource; the first
+    // step reads the input faces and the last one writes the output faces
+    ScratchArena meshes( ScratchArena::DEFAULT_BLOCK_SIZE, scratch );
+    ScratchArena arena( ScratchArena::DEFAULT_BLOCK_SIZE, scratch );
+    std::pmr::vector<face> levelMesh( &meshes ), nextMesh( &meshes );
+    const face* faces = mesh.data( );
+    std::size_t numFaces = mesh.size( );
+    std::size_t numVert = numVertices;
+    for ( unsigned short l = 0; l < levels; ++l )
+    {
+        arena.reset( );
         //*********************************************************************
-        // check if it is a boundary edge, ie check if there is another triangle
-        // sharing this edge and if so get the index of its "opposite" vertex
+        // the stencils of one step, with respect to the previous level: the same weights as
+        // loopStep(), where a vertex may appear more than once in a stencil
         //*********************************************************************
-        if (!isBoundaryEdge(e, mesh, oppV1, oppV2))
+        const std::size_t numHalfEdges = 3 * numFaces;
+        VertexCorners corners( &arena );
+        corners.build( numVert, faces, numFaces );
+        EdgeAdjacency adjacency( &arena );
+        adjacency.build( faces, numFaces, corners, numVert, threads );
+        const std::size_t numEdges = adjacency.numEdges;
+        const auto& newIndex = adjacency.index;
+        const auto& first = adjacency.first;
+        const auto& second = adjacency.second;
+
+        const auto vertexOf = [faces]( std::size_t h ) -> idxtype {
+            const face& f = faces[h / 3];
+            return ( h % 3 == 0 ) ? f.v1 : ( ( h % 3 == 1 ) ? f.v2 : f.v3 );
+        };
+        const auto nextOf = []( std::size_t h ) { return ( h % 3 == 2 ) ? h - 2 : h + 1; };
+
+        // the even vertex i weights itself and the other 2 vertices of each of its corners,
+        // the odd vertex of an edge its extrema and, unless on the boundary, the 2 opposite vertices
+        const std::size_t numRows = numVert + numEdges;
+        std::pmr::vector<std::size_t> stepOffsets( numRows + 1, 0, &arena );
+        parallelFor(
+            numVert, [&]( std::size_t i ) { stepOffsets[i + 1] = 1 + 2 * ( corners.offsets[i + 1] - corners.offsets[i] ); }, threads );
+        parallelFor(
+            numHalfEdges,
+            [&]( std::size_t h ) {
+                if ( first[h] == h )
+                    stepOffsets[newIndex[h] + 1] = ( second[h] == NONE ) ? 2 : 4;
+            },
+            threads );
+        for ( std::size_t r = 0; r < numRows; ++r )
         {
-            // if it is not a boundary edge create the new vertex
-
-            //*********************************************************************
-            // the new vertex is the linear combination of the two extrema of
-            // the edge V1 and V2 and the two opposite vertices oppV1 and oppV2
-            // Using the loop coefficient the new vertex is
-            // nvert = 3/8 (V1+V2) + 1/8(oppV1 + oppV2)
-            //
-            // REMEMBER THAT IN THE CODE OPPV1 AND OPPV2 ARE INDICES, NOT VERTICES!!!
-            //*********************************************************************
-            nvert = (3.f/8.f) * (vertList[e.first] + vertList[e.second]) + (1.f/8.f) * (vertList[oppV1] + vertList[oppV2]);
+            stepOffsets[r + 1] += stepOffsets[r];
+        }
 
+        std::pmr::vector<idxtype> stepSources( stepOffsets[numRows], &arena );
+        std::pmr::vector<float> stepWeights( stepOffsets[numRows], &arena );
+        parallelFor(
+            numVert,
+            [&]( std::size_t i ) {
+                const auto occurrences = corners.offsets[i + 1] - corners.offsets[i];
+                assert( occurrences != 0 );
+                const float weight = 3.0f / ( 16.0f * (float) occurrences );
+
+                auto k = stepOffsets[i];
+                stepSources[k] = static_cast<idxtype>( i );
+                stepWeights[k++] = 5.0f / 8.0f;
+                for ( auto c = corners.offsets[i]; c < corners.offsets[i + 1]; ++c )
+                {
+                    // the other 2 vertices of the face
+                    const auto corner = corners.corners[c];
+                    stepSources[k] = vertexOf( nextOf( corner ) );
+                    stepWeights[k++] = weight;
+                    stepSources[k] = vertexOf( nextOf( nextOf( corner ) ) );
+                    stepWeights[k++] = weight;
+                }
+            },
+            threads );
+        parallelFor(
+            numHalfEdges,
+            [&]( std::size_t h ) {
+                if ( first[h] != h )
+                    return;
+                auto k = stepOffsets[newIndex[h]];
+                const auto h2 = second[h];
+                const float weight = ( h2 == NONE ) ? 0.5f : 3.f / 8.f;
+                stepSources[k] = vertexOf( h );
+                stepWeights[k++] = weight;
+                stepSources[k] = vertexOf( nextOf( h ) );
+                stepWeights[k++] = weight;
+                if ( h2 != NONE )
+                {
+                    stepSources[k] = vertexOf( nextOf( nextOf( h ) ) );
+                    stepWeights[k++] = 1.f / 8.f;
+                    stepSources[k] = vertexOf( nextOf( nextOf( h2 ) ) );
+                    stepWeights[k] = 1.f / 8.f;
+                }
+            },
+            threads );
+
+        if ( l + 1 == levels )
+        {
+            splitFaces( faces, numFaces, newIndex, _mesh, threads );
         }
         else
         {
-            //*********************************************************************
-            // otherwise it is a boundary edge then the vertex is the linear combination of the
-            // two extrema
-            //*********************************************************************
-            nvert = (vertList[e.first] + vertList[e.second]) * 0.5f;
-
+            splitFaces( faces, numFaces, newIndex, nextMesh, threads );
+            levelMesh.swap( nextMesh );
+            faces = levelMesh.data( );
+            numFaces = levelMesh.size( );
         }
-        //*********************************************************************
-        // append the new vertex to the list of vertices
-        //*********************************************************************
-        vertList.push_back(nvert);
-
-
-        //*********************************************************************
-        // return the index of the new vertex
-        //*********************************************************************
-        return newIndex;
 
+        // and with respect to the input mesh
+        composeStencils( stepOffsets, stepSources, stepWeights, _offsets, _sources, _weights, threads, &arena );
+        numVert = numRows;
     }
-    else
-    // else we don't need to do anything, just return the associated index of the
-    // already existing vertex
-    {
-        //*********************************************************************
-        // get and return the index of the vertex
-        //*********************************************************************
-        return newVertList.getIndex(e);
+}
 
-    }
+void LoopStencils::apply( const std::vector<point3d>& origVert, std::vector<point3d>& destVert, unsigned int threads ) const
+{
+    assert( origVert.size( ) == _numInputVertices );
+    destVert.resize( numOutputVertices( ) );
+    parallelFor(
+        destVert.size( ),
+        [&]( std::size_t i ) {
+            float x{0}, y{0}, z{0};
+            for ( auto k = _offsets[i]; k < _offsets[i + 1]; ++k )
+            {
+                const point3d& p = origVert[_sources[k]];
+                x += _weights[k] * p.x;
+                y += _weights[k] * p.y;
+                z += _weights[k] * p.z;
+            }
+            destVert[i] = point3d( x, y, z );
+        },
+        threads );
+}
 
-    // this is just to avoid compilation errors at the beginning
-    // execution should normally never reach here
-    // the return instructions go inside each branch of the if - else above
-    // remove this return instruction once you have implemented the function
-    std::cerr << "WARNING: the subdivision may not be implemented correctly" << std::endl;
-    return 0;
-}
\ No newline at end of file
+void LoopStencils::apply( const std::vector<point3d>& origVert,
+                          std::vector<point3d>& destVert,
+                          std::vector<vec3d>& destNorm,
+                          unsigned int threads ) const
+{
+    apply( origVert, destVert, threads );
+    computeVertexNormals( destVert, _mesh, destNorm, threads );
+}
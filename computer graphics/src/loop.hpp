@@ -8,29 +8,126 @@
 
 #include "core.hpp"
 
+#include <atomic>
+
 /**
- * Compute the subdivision of the input mesh by applying one step of the Loop algorithm
+ * Compute the subdivision of the input mesh by applying one step of the Loop algorithm. The work
+ * is split among several threads; the output is the same for any number of threads.
  *
  * @param[in] origVert The list of the input vertices
  * @param[in] origMesh The input mesh (the vertex indices for each face/triangle)
  * @param[out] destVert The list of the new vertices for the subdivided mesh
  * @param[out] destMesh The new subdivided mesh (the vertex indices for each face/triangle)
  * @param[out] destNorm The new list of normals for each new vertex of the subdivided mesh
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists, they are released before returning
+ * in the reverse order of their allocation (see ScratchArena)
  */
-void loopSubdivision(const std::vector<point3d> &origVert, const std::vector<face> &origMesh, std::vector<point3d> &destVert, std::vector<face> &destMesh, std::vector<vec3d> &destNorm);
+void loopSubdivision(const std::vector<point3d> &origVert, const std::vector<face> &origMesh, std::vector<point3d> &destVert, std::vector<face> &destMesh, std::vector<vec3d> &destNorm, unsigned int threads = 0, std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
 
+/**
+ * Compute the subdivision of the input mesh by applying several steps of the Loop algorithm at once,
+ * without building the intermediate levels. The mesh is subdivided in patches of faces, each one
+ * along with the faces around it, straight to the final level, so the memory used besides the
+ * output is about the size of the input. The faces and the vertices are the same as those of
+ * applying loopSubdivision() levels times; the faces are in the same order, the vertices are
+ * numbered differently (except for one level).
+ *
+ * @param[in] origVert The list of the input vertices
+ * @param[in] origMesh The input mesh (the vertex indices for each face/triangle)
+ * @param[in] levels the number of subdivision steps
+ * @param[out] destVert The list of the vertices of the final level
+ * @param[out] destMesh The mesh of the final level (the vertex indices for each face/triangle)
+ * @param[out] destNorm The normals of the vertices of the final level
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] scratch the memory resource for the temporary lists, released before returning; the
+ * buffers of the threads are taken from it as well, so it needs not be thread safe
+ * @param[in] cancel if given, the subdivision stops as soon as it is set, checked between the patches
+ * @return false if the subdivision was cancelled, then the output is incomplete
+ */
+bool loopSubdivision(const std::vector<point3d> &origVert, const std::vector<face> &origMesh, unsigned short levels, std::vector<point3d> &destVert, std::vector<face> &destMesh, std::vector<vec3d> &destNorm, unsigned int threads = 0, std::pmr::memory_resource *scratch = std::pmr::get_default_resource(), const std::atomic<bool> *cancel = nullptr);
 
 /**
- * For a given edge it returns the index of the new vertex created on its middle point. If such vertex already exists it just returns the
- * its index; if it does not exist it creates it in vertList along it's normal and return the index
- * @brief ObjModel::getNewVertex
- * @param e the edge
- * @param currFace the current triangle containing the edge e
- * @param vertList the list of vertices
- * @param indices the list of triangles
- * @param normList the list of normals associated to the vertices
- * @param newVertList The list of the new vertices added so far
- * @return the index of the new vertex
- * @see EdgeList
+ * The Loop subdivision of a mesh as a linear map: for a fixed connectivity each vertex of the
+ * subdivided mesh is a weighted sum of a few vertices of the input mesh (its stencil). The stencils
+ * are built once from the faces only (topology phase), then applying them to the positions of the
+ * vertices (numeric phase) gives the subdivided mesh without any adjacency work, eg after the
+ * vertices have been moved. The result is the same as applying loopSubdivision() once per level,
+ * with the same numbering of the vertices, up to rounding errors.
  */
-idxtype getNewVertex(const edge &e, std::vector<point3d> &vertList, const std::vector<face> &mesh, EdgeList &newVertList);
\ No newline at end of file
+class LoopStencils
+{
+public:
+    LoopStencils() = default;
+
+    /**
+     * Build the stencils of a subdivision (topology phase)
+     * @param[in] numVertices the number of vertices of the input mesh
+     * @param[in] mesh the input mesh
+     * @param[in] levels the number of subdivision steps
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     * @param[in] scratch the memory resource for the temporary lists, ie the adjacency, the stencils of each
+     * step and the intermediate meshes, released before returning
+     */
+    void build(std::size_t numVertices, const std::vector<face> &mesh, unsigned short levels = 1, unsigned int threads = 0, std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
+
+    /**
+     * Compute the vertices of the subdivided mesh (numeric phase)
+     * @param[in] origVert the vertices of the input mesh, as many as given to build()
+     * @param[out] destVert the vertices of the subdivided mesh
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void apply(const std::vector<point3d> &origVert, std::vector<point3d> &destVert, unsigned int threads = 0) const;
+
+    /**
+     * Compute the vertices and their normals of the subdivided mesh (numeric phase)
+     * @param[in] origVert the vertices of the input mesh, as many as given to build()
+     * @param[out] destVert the vertices of the subdivided mesh
+     * @param[out] destNorm the normals of the vertices of the subdivided mesh
+     * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+     */
+    void apply(const std::vector<point3d> &origVert, std::vector<point3d> &destVert, std::vector<vec3d> &destNorm, unsigned int threads = 0) const;
+
+    /**
+     * Return the faces of the subdivided mesh, the same as those given by loopSubdivision() level by level
+     * @return the subdivided mesh
+     */
+    [[nodiscard]] const std::vector<face> &mesh() const { return _mesh; }
+
+    /**
+     * Move the faces of the subdivided mesh out of the stencils, eg to store them along with the
+     * vertices; afterwards only the vertices can be computed, without their normals
+     * @return the subdivided mesh
+     */
+    std::vector<face> takeMesh() { return std::move(_mesh); }
+
+    /**
+     * Return the number of vertices of the input mesh
+     * @return the number of input vertices
+     */
+    [[nodiscard]] std::size_t numInputVertices() const { return _numInputVertices; }
+
+    /**
+     * Return the number of vertices of the subdivided mesh
+     * @return the number of stencils
+     */
+    [[nodiscard]] std::size_t numOutputVertices() const { return _offsets.empty() ? 0 : _offsets.size() - 1; }
+
+    /**
+     * Return the total number of weights of the stencils
+     * @return the number of weights
+     */
+    [[nodiscard]] std::size_t numWeights() const { return _weights.size(); }
+
+private:
+    /// the number of vertices of the input mesh
+    std::size_t _numInputVertices{0};
+    /// the beginning of the stencil of each output vertex in _sources and _weights, plus the number of weights
+    std::vector<std::size_t> _offsets{};
+    /// the input vertex of each weight, in increasing order within each stencil
+    std::vector<idxtype> _sources{};
+    /// the weights of the stencils
+    std::vector<float> _weights{};
+    /// the subdivided mesh
+    std::vector<face> _mesh{};
+};
@@ -4,9 +4,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include "AsyncLoader.hpp"
 #include "MeshModel.hpp"
 #include "openglAll.hpp"
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 
@@ -16,6 +18,8 @@ constexpr int DELTA_ANGLE_X{5};
 constexpr int DELTA_ANGLE_Y{5};
 constexpr float DELTA_DISTANCE{ .3f };
 constexpr float DISTANCE_MIN{ .0f };
+// the interval between two redraws while a model is being loaded or subdivided, in milliseconds
+constexpr unsigned int BUSY_REDRAW_MS{100};
 
 using namespace std;
 
@@ -43,6 +47,11 @@ struct glutWindow
 // global variable containing the OBJ model
 //************************************
 MeshModel obj;
+// the loader running in background, the model is swapped in by display() once loaded
+AsyncLoader loader;
+// the model file and how it is loaded
+std::string modelFilename;
+LoadParameters loadParams;
 
 
 int angle_y = 0;
@@ -190,6 +199,36 @@ void render_fps()
     const auto textWidth = static_cast<int>(str.length() * 10);
     render_text(str, width - textWidth - 10, 10);
 
+    // the progress of the subdivision being computed in background next to it
+    if(obj.subdividing())
+    {
+        const auto progress = obj.subdivisionProgress();
+        const std::string subdividing = "Subdividing: level " + std::to_string(progress.completedLevel) + " of " + std::to_string(progress.targetLevel);
+        const auto subdividingWidth = static_cast<int>(subdividing.length() * 10);
+        render_text(subdividing, width - textWidth - subdividingWidth - 30, 10);
+    }
+
+    // the use of the cache of the subdivision levels above
+    if(params.subdivision)
+    {
+        const auto& stats = obj.subdivisionStatistics();
+        const std::string cache = "Subdivision level " + std::to_string(params.subdivLevel) + " - cache: " + std::to_string(stats.hits) + " hits, "
+                                  + std::to_string(stats.misses) + " misses, " + std::to_string(stats.residentBytes >> 20u) + " MiB";
+        render_text(cache, 10, 35);
+    }
+
+    // and the progress of the model being loaded in the bottom-left corner
+    if(loader.loading())
+    {
+        const auto progress = loader.progress();
+        std::string loading = "Loading " + progress.filename;
+        if(progress.total > 0)
+        {
+            loading += ": " + std::to_string((100 * progress.parsed) / progress.total) + "%";
+        }
+        render_text(loading, 10, 10);
+    }
+
     // Restore previous projection and modelview matrices
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
@@ -197,8 +236,45 @@ void render_fps()
     glMatrixMode(GL_MODELVIEW);
 }
 
+// true if a redraw has been scheduled by busy_redraw()
+bool redrawScheduled{false};
+
+/**
+ * Redraw the scene, see busy_redraw()
+ */
+void redraw_timer( int )
+{
+    redrawScheduled = false;
+    glutPostRedisplay( );
+}
+
+/**
+ * Schedule a redraw while a model is being loaded or subdivided, so that its progress is shown
+ * and the result is displayed as soon as it is available
+ */
+void busy_redraw( )
+{
+    if ( !redrawScheduled && ( loader.loading( ) || obj.subdividing( ) ) )
+    {
+        redrawScheduled = true;
+        glutTimerFunc( BUSY_REDRAW_MS, redraw_timer, 0 );
+    }
+}
+
+/**
+ * Start loading the model in background
+ */
+void start_loading( )
+{
+    loader.load( modelFilename, loadParams );
+    busy_redraw( );
+}
+
 void display( )
 {
+    // swap in the model as soon as it is loaded, this never waits for the loader
+    loader.take( obj );
+
     glClearColor(0.5, .5, .75, 1.);
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
@@ -230,18 +306,23 @@ void display( )
     render_fps();
 
     glutSwapBuffers( );
+
+    // keep redrawing until the background work is over
+    busy_redraw( );
 }
 
 void printKeyboardHelp()
 {
   std::cout << "keys:"
             << "\t s - use index rendering\n"
+            << "\t b - keep the model in buffer objects on the GPU\n"
             << "\t w - draw wireframe\n"
             << "\t h - enable/disable subdivision\n"
             << "\t 1-4 - with subdivision enabled, level of subdivision\n"
             << "\t d - enable/disable solid rendering\n"
             << "\t a - enable/disable smooth rendering\n"
             << "\t n - enable/disable normals rendering\n"
+            << "\t l - reload the model (in background)\n"
             << "\t arrow keys - rotate around the object\n"
             << "\t pg down/up - zoom out/in\n"
             << std::endl;
@@ -257,6 +338,10 @@ void keyboard( unsigned char key, int , int  )
             params.useIndexRendering = !params.useIndexRendering;
             PRINTVAR( params.useIndexRendering );
             break;
+        case 'b':
+            params.useBufferObjects = !params.useBufferObjects;
+            PRINTVAR( params.useBufferObjects );
+            break;
         case 'w':
             params.wireframe = !params.wireframe;
             PRINTVAR( params.wireframe );
@@ -277,6 +362,12 @@ void keyboard( unsigned char key, int , int  )
             params.normals = !params.normals;
             PRINTVAR( params.normals );
             break;
+        case 'l':
+            if ( !modelFilename.empty( ) )
+            {
+                start_loading( );
+            }
+            break;
         case '1':
         case '2':
         case '3':
@@ -323,7 +414,7 @@ int main( int argc, char **argv )
     if(argc ==1 )
     {
       std::cout << "No obj file to load, displaying an empty scene with the reference system" << std::endl;
-      std::cout << "Usage:\n\t" + std::string(argv[0]) + " <obj file>" << std::endl;
+      std::cout << "Usage:\n\t" + std::string(argv[0]) + " <obj or ply file> [--weld] [--file-normals] [--subdiv-budget <MiB>]" << std::endl;
     }
 
     // set window values
@@ -346,23 +437,53 @@ int main( int argc, char **argv )
     glutSpecialFunc( arrows );
     initialize( );
 
-    if(argc == 2)
+    // the options after the model file
+    bool validOptions{true};
+    for(int i = 2; i < argc; ++i)
     {
-        //***********************************************
-        // Load the obj model from file
-        //***********************************************
-        if(obj.load(argv[1]))
+        const std::string option(argv[i]);
+        if(option == "--weld")
+        {
+            // merge the duplicated vertices, eg of the non-manifold models
+            loadParams.weld = true;
+        }
+        else if(option == "--file-normals")
+        {
+            // keep the normals of the file, if any, instead of recomputing them: the vertices on
+            // the creases are split, which opens the mesh there for the subdivision
+            loadParams.useFileAttributes = true;
+        }
+        else if((option == "--subdiv-budget") && (i + 1 < argc))
+        {
+            // the memory for the subdivision levels kept in cache, in MiB
+            params.subdivisionBudget = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10)) << 20u;
+        }
+        else if((option == "--normal-length") && (i + 1 < argc))
+        {
+            // the length of the normals shown, the model being scaled to a unit size
+            params.normalLength = std::strtof(argv[++i], nullptr);
+        }
+        else if((option == "--normal-stride") && (i + 1 < argc))
         {
-            //***********************************************
-            // Make it unitary
-            //***********************************************
-            obj.unitizeModel();
+            // show only one normal every k vertices, on dense models
+            params.normalStride = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
         }
         else
         {
-            std::cerr << "error while opening the model\n";
+            std::cerr << "Unknown option " << option << std::endl;
+            validOptions = false;
         }
     }
+
+    if((argc >= 2) && validOptions)
+    {
+        //***********************************************
+        // Load the obj model from file and make it unitary, in background:
+        // the scene is displayed meanwhile
+        //***********************************************
+        modelFilename = argv[1];
+        start_loading( );
+    }
     printKeyboardHelp();
 
     glutMainLoop( );
@@ -0,0 +1,357 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "meshCache.hpp"
+#include "MappedFile.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+static_assert(std::is_trivially_copyable_v<point3d> && (sizeof(point3d) == 3 * sizeof(float)),
+              "point3d must be stored as 3 packed floats");
+static_assert(std::is_trivially_copyable_v<face> && (sizeof(face) == 3 * sizeof(idxtype)),
+              "face must be stored as 3 packed indices");
+
+/// the identifier of the file format
+constexpr char CACHE_MAGIC[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0'};
+/// the version of the file format, to be incremented at each change of the layout or of the loaded model
+constexpr std::uint32_t CACHE_VERSION{4};
+/// used to detect a cache written on a machine with a different endianness
+constexpr std::uint32_t CACHE_BYTE_ORDER{0x01020304};
+/// the flag set when the normals and the texture coordinates have been taken from the file
+constexpr std::uint32_t CACHE_FILE_ATTRIBUTES{1u << 0};
+/// the flag set when the vertices have been welded
+constexpr std::uint32_t CACHE_WELDED{1u << 1};
+/// the size of the blocks that are hashed independently
+constexpr std::size_t CHECKSUM_BLOCK_BYTES{1u << 20};
+
+/**
+ * The header of the cache file, followed by the vertices, the faces, the normals and the texture coordinates
+ */
+struct CacheHeader
+{
+    /// the file format identifier
+    char magic[8]{};
+    /// the version of the file format
+    std::uint32_t version{0};
+    /// the byte order marker
+    std::uint32_t byteOrder{0};
+    /// the size in bytes of the source file
+    std::uint64_t sourceSize{0};
+    /// the modification time of the source file
+    std::int64_t sourceTime{0};
+    /// the number of vertices
+    std::uint64_t numVertices{0};
+    /// the number of faces
+    std::uint64_t numFaces{0};
+    /// the number of normals
+    std::uint64_t numNormals{0};
+    /// the number of texture coordinates
+    std::uint64_t numTexcoords{0};
+    /// how the model has been loaded (CACHE_FILE_ATTRIBUTES, CACHE_WELDED)
+    std::uint32_t flags{0};
+    /// the relative distance used to weld the vertices, if welded
+    float weldEpsilon{0};
+    /// the minimum point of the bounding box
+    float bbMin[3]{};
+    /// the maximum point of the bounding box
+    float bbMax[3]{};
+    /// the checksum of the header (with this field set to 0) and of the data
+    std::uint64_t checksum{0};
+
+    /**
+     * Check the size of the data following the header. Each count is bounded by the remaining size
+     * before being multiplied, so that corrupted counts cannot overflow and match the size anyway.
+     * @param[in] size the size of the data following the header, in bytes
+     * @return true if the data of the counts of the header has exactly this size
+     */
+    [[nodiscard]] bool hasDataSize(std::uint64_t size) const
+    {
+        const std::pair<std::uint64_t, std::uint64_t> lists[]{
+            {numVertices, sizeof(point3d)}, {numFaces, sizeof(face)}, {numNormals, sizeof(vec3d)}, {numTexcoords, sizeof(texcoord)}};
+        for(const auto& [count, elementSize] : lists)
+        {
+            if(count > size / elementSize)
+            {
+                return false;
+            }
+            size -= count * elementSize;
+        }
+        return size == 0;
+    }
+};
+
+// the header is hashed as raw bytes, hence it must not contain padding
+static_assert(sizeof(CacheHeader) == 104, "unexpected padding in the cache header");
+
+/**
+ * Hash a buffer (FNV-1a on 64 bit words)
+ * @param[in] data the buffer
+ * @param[in] size the size of the buffer in bytes
+ * @param[in] seed the initial value of the hash
+ * @return the hash
+ */
+std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t seed = 0xcbf29ce484222325ull)
+{
+    constexpr std::uint64_t prime{0x100000001b3ull};
+    auto h = seed;
+    std::size_t i{0};
+    for(; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
+    }
+    for(; i < size; ++i)
+    {
+        h = (h ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return h;
+}
+
+/**
+ * Hash a large buffer. The buffer is split in fixed-size blocks that are hashed in parallel,
+ * hence the result does not depend on the number of threads.
+ * @param[in] data the buffer
+ * @param[in] size the size of the buffer in bytes
+ * @param[in] seed the initial value of the hash
+ * @return the hash
+ */
+std::uint64_t hashBlocks(const char* data, std::size_t size, std::uint64_t seed)
+{
+    const auto numBlocks = (size + CHECKSUM_BLOCK_BYTES - 1) / CHECKSUM_BLOCK_BYTES;
+    std::vector<std::uint64_t> blockHash(numBlocks);
+    parallelFor(
+        numBlocks,
+        [&](std::size_t b) {
+            const auto begin = b * CHECKSUM_BLOCK_BYTES;
+            blockHash[b] = hashBytes(data + begin, std::min(CHECKSUM_BLOCK_BYTES, size - begin));
+        },
+        0,
+        1);
+    return hashBytes(reinterpret_cast<const char*>(blockHash.data()), blockHash.size() * sizeof(std::uint64_t), seed);
+}
+
+/**
+ * Compute the checksum of the header and of the data
+ * @param[in] header the header
+ * @param[in] vertices the vertices
+ * @param[in] mesh the faces
+ * @param[in] normals the normals
+ * @param[in] texcoords the texture coordinates
+ * @return the checksum
+ */
+std::uint64_t checksum(CacheHeader header, const point3d* vertices, const face* mesh, const vec3d* normals, const texcoord* texcoords)
+{
+    header.checksum = 0;
+    auto h = hashBytes(reinterpret_cast<const char*>(&header), sizeof(header));
+    h = hashBlocks(reinterpret_cast<const char*>(vertices), header.numVertices * sizeof(point3d), h);
+    h = hashBlocks(reinterpret_cast<const char*>(mesh), header.numFaces * sizeof(face), h);
+    h = hashBlocks(reinterpret_cast<const char*>(normals), header.numNormals * sizeof(vec3d), h);
+    return hashBlocks(reinterpret_cast<const char*>(texcoords), header.numTexcoords * sizeof(texcoord), h);
+}
+
+/**
+ * Get the size and the modification time of the source file
+ * @param[in] filename the source file
+ * @param[out] size its size in bytes
+ * @param[out] time its modification time
+ * @return true if everything went well, false otherwise
+ */
+bool sourceStamp(const std::string& filename, std::uint64_t& size, std::int64_t& time)
+{
+    std::error_code ec;
+    size = static_cast<std::uint64_t>(fs::file_size(filename, ec));
+    if(ec)
+        return false;
+    const auto mtime = fs::last_write_time(filename, ec);
+    if(ec)
+        return false;
+    time = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+/**
+ * Return the flags describing how a model is loaded
+ * @param[in] params the loading parameters
+ * @return the flags
+ */
+std::uint32_t cacheFlags(const LoadParameters& params)
+{
+    return (params.useFileAttributes ? CACHE_FILE_ATTRIBUTES : 0u) | (params.weld ? CACHE_WELDED : 0u);
+}
+
+}  // namespace
+
+std::string meshCacheFilename(const std::string& filename)
+{
+    return filename + ".meshbin";
+}
+
+bool loadMeshCache(const std::string& filename,
+                   std::vector<point3d>& vertices,
+                   std::vector<face>& mesh,
+                   std::vector<vec3d>& normals,
+                   std::vector<texcoord>& texcoords,
+                   BoundingBox& bb,
+                   const LoadParameters& params)
+{
+    const auto cacheName = meshCacheFilename(filename);
+    std::error_code ec;
+    if(!fs::exists(cacheName, ec))
+    {
+        return false;
+    }
+
+    std::uint64_t sourceSize{0};
+    std::int64_t sourceTime{0};
+    if(!sourceStamp(filename, sourceSize, sourceTime))
+    {
+        return false;
+    }
+
+    MappedFile cache;
+    if(!cache.open(cacheName))
+    {
+        std::cerr << "Unable to open the cache " << cacheName << std::endl;
+        return false;
+    }
+
+    CacheHeader header;
+    if(cache.size() < sizeof(header))
+    {
+        std::cerr << "The cache " << cacheName << " is corrupted, it will be rebuilt" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, cache.view().data(), sizeof(header));
+
+    if((std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) || (header.version != CACHE_VERSION) ||
+       (header.byteOrder != CACHE_BYTE_ORDER))
+    {
+        std::cerr << "The cache " << cacheName << " has an unsupported format, it will be rebuilt" << std::endl;
+        return false;
+    }
+    const float weldEpsilon = params.weld ? params.weldEpsilon : 0.f;
+    if((header.sourceSize != sourceSize) || (header.sourceTime != sourceTime) || (header.flags != cacheFlags(params))
+       || (std::memcmp(&header.weldEpsilon, &weldEpsilon, sizeof(weldEpsilon)) != 0))
+    {
+        std::cerr << "The cache " << cacheName << " is out of date, it will be rebuilt" << std::endl;
+        return false;
+    }
+    if(!header.hasDataSize(cache.size() - sizeof(header)))
+    {
+        std::cerr << "The cache " << cacheName << " is corrupted, it will be rebuilt" << std::endl;
+        return false;
+    }
+
+    vertices.resize(header.numVertices);
+    mesh.resize(header.numFaces);
+    normals.resize(header.numNormals);
+    texcoords.resize(header.numTexcoords);
+    const char* data = cache.view().data() + sizeof(header);
+    std::memcpy(vertices.data(), data, vertices.size() * sizeof(point3d));
+    data += vertices.size() * sizeof(point3d);
+    std::memcpy(mesh.data(), data, mesh.size() * sizeof(face));
+    data += mesh.size() * sizeof(face);
+    std::memcpy(normals.data(), data, normals.size() * sizeof(vec3d));
+    data += normals.size() * sizeof(vec3d);
+    std::memcpy(texcoords.data(), data, texcoords.size() * sizeof(texcoord));
+
+    if(checksum(header, vertices.data(), mesh.data(), normals.data(), texcoords.data()) != header.checksum)
+    {
+        std::cerr << "The cache " << cacheName << " is corrupted, it will be rebuilt" << std::endl;
+        vertices.clear();
+        mesh.clear();
+        normals.clear();
+        texcoords.clear();
+        return false;
+    }
+    bb.pmin = point3d(header.bbMin);
+    bb.pmax = point3d(header.bbMax);
+
+    std::cout << "Object loaded from cache " << cacheName << " with " << vertices.size() << " vertices and "
+              << mesh.size() << " faces" << std::endl;
+    return true;
+}
+
+bool saveMeshCache(const std::string& filename,
+                   const std::vector<point3d>& vertices,
+                   const std::vector<face>& mesh,
+                   const std::vector<vec3d>& normals,
+                   const std::vector<texcoord>& texcoords,
+                   const BoundingBox& bb,
+                   const LoadParameters& params)
+{
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER;
+    if(!sourceStamp(filename, header.sourceSize, header.sourceTime))
+    {
+        return false;
+    }
+    header.numVertices = vertices.size();
+    header.numFaces = mesh.size();
+    header.numNormals = normals.size();
+    header.numTexcoords = texcoords.size();
+    header.flags = cacheFlags(params);
+    header.weldEpsilon = params.weld ? params.weldEpsilon : 0.f;
+    header.bbMin[0] = bb.pmin.x;
+    header.bbMin[1] = bb.pmin.y;
+    header.bbMin[2] = bb.pmin.z;
+    header.bbMax[0] = bb.pmax.x;
+    header.bbMax[1] = bb.pmax.y;
+    header.bbMax[2] = bb.pmax.z;
+
+    header.checksum = checksum(header, vertices.data(), mesh.data(), normals.data(), texcoords.data());
+
+    // write to a temporary file that replaces the cache only once completely written
+    const auto cacheName = meshCacheFilename(filename);
+    const auto tmpName = cacheName + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+        if(!out.is_open())
+        {
+            std::cerr << "Unable to write the cache " << cacheName << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(point3d)));
+        out.write(reinterpret_cast<const char*>(mesh.data()), static_cast<std::streamsize>(mesh.size() * sizeof(face)));
+        out.write(reinterpret_cast<const char*>(normals.data()), static_cast<std::streamsize>(normals.size() * sizeof(vec3d)));
+        out.write(reinterpret_cast<const char*>(texcoords.data()), static_cast<std::streamsize>(texcoords.size() * sizeof(texcoord)));
+        if(!out)
+        {
+            std::cerr << "Unable to write the cache " << cacheName << std::endl;
+            out.close();
+            fs::remove(tmpName);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpName, cacheName, ec);
+    if(ec)
+    {
+        std::cerr << "Unable to write the cache " << cacheName << ": " << ec.message() << std::endl;
+        fs::remove(tmpName, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+#include "objReader.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * Return the name of the binary cache (the .meshbin sidecar) associated to a model file
+ * @param[in] filename The name of the model file
+ * @return the name of the cache file
+ */
+std::string meshCacheFilename(const std::string& filename);
+
+/**
+ * Load the model from its binary cache. The cache is used only if it is valid, ie it has
+ * the expected format and version, it has been generated from a source file with the same
+ * size and modification time of the current one, loaded with the same parameters affecting
+ * the result (the attributes of the file, the welding), and its content is not corrupted.
+ *
+ * @param[in] filename The name of the model file (not the cache)
+ * @param[out] vertices The list of vertices
+ * @param[out] mesh The list of faces
+ * @param[out] normals The list of normals
+ * @param[out] texcoords The list of texture coordinates
+ * @param[out] bb The bounding box of the object
+ * @param[in] params The parameters used to load the model
+ * @return true if the cache was valid and the model has been loaded, false otherwise
+ */
+bool loadMeshCache(const std::string& filename,
+                   std::vector<point3d>& vertices,
+                   std::vector<face>& mesh,
+                   std::vector<vec3d>& normals,
+                   std::vector<texcoord>& texcoords,
+                   BoundingBox& bb,
+                   const LoadParameters& params);
+
+/**
+ * Save the model in the binary cache associated to the model file
+ *
+ * @param[in] filename The name of the model file (not the cache)
+ * @param[in] vertices The list of vertices
+ * @param[in] mesh The list of faces
+ * @param[in] normals The list of normals
+ * @param[in] texcoords The list of texture coordinates
+ * @param[in] bb The bounding box of the object
+ * @param[in] params The parameters used to load the model
+ * @return true if everything went well, false otherwise
+ */
+bool saveMeshCache(const std::string& filename,
+                   const std::vector<point3d>& vertices,
+                   const std::vector<face>& mesh,
+                   const std::vector<vec3d>& normals,
+                   const std::vector<texcoord>& texcoords,
+                   const BoundingBox& bb,
+                   const LoadParameters& params);
@@ -6,216 +6,1939 @@
 
 #include "objReader.hpp"
 #include "geometry.hpp"
+#include "MappedFile.hpp"
+#include "parallel.hpp"
 
-#include <regex>
-#include <array>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace
+{
+
+/// the minimum number of bytes parsed by each thread
+constexpr std::size_t MIN_CHUNK_BYTES{1u << 20};
+/// the number of bytes parsed between two progress notifications
+constexpr std::size_t PROGRESS_BYTES{1u << 20};
 
 /**
- * Load the OBJ data from file
- * @param[in] filename The name of the OBJ file to load
- * @param[out] vertices The list of vertices
- * @param[out] mesh The list of faces
- * @param[out] normals The list of normals
- * @param[out] bb The bounding box of the object
- * @return true if everything went well, false otherwise
+ * Keep track of the number of bytes parsed, shared by the parsing threads
  */
-bool load(const std::string& filename, std::vector<point3d>& vertices, std::vector<face>& mesh, std::vector<vec3d>& normals, BoundingBox& bb)
+struct ParseProgress
 {
-    std::string line;
-    std::ifstream objFile( filename );
+    /// the function notified of the progress, if any
+    const std::function<void(std::size_t, std::size_t)>& callback;
+    /// the size of the file
+    std::size_t total{0};
+    /// the number of bytes parsed so far
+    std::atomic<std::size_t> parsed{0};
+    /// the flag requesting to stop the parsing, if any
+    const std::atomic<bool>* cancel{nullptr};
 
-    // If obj file is not open return (e.g. file does not exist
-    if (! objFile.is_open( ) )
+    /**
+     * Constructor
+     * @param[in] fn the function notified of the progress
+     * @param[in] size the size of the file
+     * @param[in] stop the flag requesting to stop the parsing, if any
+     */
+    ParseProgress(const std::function<void(std::size_t, std::size_t)>& fn, std::size_t size, const std::atomic<bool>* stop = nullptr)
+        : callback(fn), total(size), cancel(stop) { }
+
+    /**
+     * Return true if the parsing has been cancelled
+     * @return true if the parsing must stop
+     */
+    [[nodiscard]] bool cancelled() const
     {
-        std::cerr << "Unable to open file " << filename << std::endl;
-        return false;
+        return (cancel != nullptr) && cancel->load(std::memory_order_relaxed);
     }
 
-    // Start reading file data
-    while( !objFile.eof( ) )
+    /**
+     * Add some parsed bytes and notify the new total
+     * @param[in] bytes the number of bytes parsed since the last call
+     */
+    void advance(std::size_t bytes)
     {
-        // Get a line from file
-        getline( objFile, line );
-
-        // If the first character is a simple 'v'...
-//            PRINTVAR( line );
-        if ( (line[0] == 'v') && (line[1] == ' ') ) // to drop all the vn and vn lines
+        const auto current = parsed.fetch_add(bytes) + bytes;
+        if(callback)
         {
-//                PRINTVAR( line );
-            // Read 3 floats from the line:  X Y Z and store them in the corresponding place in _vertices
-            const point3d p = parseVertexString(line);
+            callback(current, total);
+        }
+    }
+};
 
-            //**************************************************
-            // add the new point to the list of the vertices
-            // and its normal to the list of normals: for the time
-            // being it is a [0, 0 ,0] normal.
-            //**************************************************
-            vertices.push_back(p);
-            normals.push_back(vec3d(0, 0, 0));
+/**
+ * The data parsed from (a chunk of) the file
+ */
+struct ObjChunk
+{
+    /// the vertices of the chunk
+    std::vector<point3d> vertices{};
+    /// the faces of the chunk
+    std::vector<face> mesh{};
+    /// the normals of the chunk (vn records)
+    std::vector<vec3d> normals{};
+    /// the texture coordinates of the chunk (vt records)
+    std::vector<texcoord> texcoords{};
+    /// the normal indices of each face, parallel to mesh
+    std::vector<face> normalIndices{};
+    /// the texture coordinate indices of each face, parallel to mesh
+    std::vector<face> texcoordIndices{};
+    /// the bounding box of the vertices of the chunk
+    BoundingBox bb{};
+    /// the number of faces without normal indices
+    std::size_t facesWithoutNormals{0};
+    /// the number of faces without texture coordinate indices
+    std::size_t facesWithoutTexcoords{0};
+    /// the number of times the lists had to grow
+    std::size_t reallocations{0};
+    /// parse the normals, the texture coordinates and the per-corner indices on/off
+    bool keepAttributes{false};
+    /// the progress of the parsing of the whole file, if tracked
+    ParseProgress* progress{nullptr};
+};
 
+/**
+ * Append an element to a list, keeping track of the reallocations
+ * @param[in,out] list the list
+ * @param[in] value the element to append
+ * @param[in,out] reallocations incremented if the list has to grow, ie its content is moved
+ */
+template <typename T>
+void append(std::vector<T>& list, const T& value, std::size_t& reallocations)
+{
+    if(list.size() == list.capacity())
+    {
+        reallocations += list.empty() ? 0u : 1u;
+    }
+    list.push_back(value);
+}
 
-            // update the bounding box, if it is the first vertex simply
-            // set the bb to it
-            if (vertices.size( ) == 1 )
-            {
-                bb.set( p );
-            }
-            else
+/**
+ * Resize a list, keeping track of the reallocations
+ * @param[in,out] list the list
+ * @param[in] size the new size
+ * @param[in,out] reallocations incremented if the list has to grow, ie its content is moved
+ */
+template <typename T>
+void resize(std::vector<T>& list, std::size_t size, std::size_t& reallocations)
+{
+    if((size > list.capacity()) && !list.empty())
+    {
+        ++reallocations;
+    }
+    list.resize(size);
+}
+
+/**
+ * A part of a list sized in advance, filled in order by the parsing of a chunk of the file
+ */
+template <typename T>
+class ListSlice
+{
+public:
+    ListSlice() = default;
+
+    /**
+     * Constructor
+     * @param[in] list the list, already sized
+     * @param[in] offset the beginning of the part
+     * @param[in] count the number of elements of the part
+     */
+    ListSlice(std::vector<T>& list, std::size_t offset, std::size_t count)
+        : _begin(list.data() + offset), _next(_begin), _end(_begin + count)
+    {
+    }
+
+    /**
+     * Add an element after those added so far
+     * @param[in] value the element
+     */
+    void push_back(const T& value)
+    {
+        assert(_next != _end);
+        *_next++ = value;
+    }
+
+    /**
+     * Return the number of elements added so far
+     * @return the number of elements
+     */
+    [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(_next - _begin); }
+
+    /**
+     * Return true if all the elements of the part have been added
+     * @return true if the part is full
+     */
+    [[nodiscard]] bool full() const { return _next == _end; }
+
+private:
+    /// the first element of the part
+    T* _begin{nullptr};
+    /// where the next element is added
+    T* _next{nullptr};
+    /// the end of the part
+    T* _end{nullptr};
+};
+
+/**
+ * The data parsed from a chunk of the file straight into its part of the lists of the whole
+ * file, which are sized in advance (see ObjChunk)
+ */
+struct ObjSlice
+{
+    /// the vertices of the chunk
+    ListSlice<point3d> vertices{};
+    /// the faces of the chunk
+    ListSlice<face> mesh{};
+    /// the normals of the chunk (vn records)
+    ListSlice<vec3d> normals{};
+    /// the texture coordinates of the chunk (vt records)
+    ListSlice<texcoord> texcoords{};
+    /// the normal indices of each face, parallel to mesh
+    ListSlice<face> normalIndices{};
+    /// the texture coordinate indices of each face, parallel to mesh
+    ListSlice<face> texcoordIndices{};
+    /// the bounding box of the vertices of the chunk
+    BoundingBox bb{};
+    /// the number of faces without normal indices
+    std::size_t facesWithoutNormals{0};
+    /// the number of faces without texture coordinate indices
+    std::size_t facesWithoutTexcoords{0};
+    /// unused, the parts never grow
+    std::size_t reallocations{0};
+    /// parse the normals, the texture coordinates and the per-corner indices on/off
+    bool keepAttributes{false};
+    /// the progress of the parsing of the whole file, if tracked
+    ParseProgress* progress{nullptr};
+};
+
+/**
+ * Append an element to a part of a list
+ * @param[in,out] list the part of the list
+ * @param[in] value the element to append
+ */
+template <typename T>
+void append(ListSlice<T>& list, const T& value, std::size_t&)
+{
+    list.push_back(value);
+}
+
+/**
+ * Reserve room for some more elements in a list, keeping track of the reallocations
+ * @param[in,out] list the list
+ * @param[in] count the number of elements that will be appended
+ * @param[in,out] reallocations incremented if the list has to grow, ie its content is moved
+ */
+template <typename T>
+void reserveMore(std::vector<T>& list, std::size_t count, std::size_t& reallocations)
+{
+    if(list.capacity() < list.size() + count)
+    {
+        reallocations += list.empty() ? 0u : 1u;
+        list.reserve(list.size() + count);
+    }
+}
+
+/**
+ * Count the records in a portion of the content of an OBJ file, looking only at the beginning
+ * of the lines. The lines are found with memchr, which is vectorized by the standard library.
+ * @param[in] buffer the content to scan, made of whole lines
+ * @param[out] stats the number of vertex, normal, texture coordinate and face records
+ */
+void countRecords(std::string_view buffer, LoadStatistics& stats)
+{
+    stats.vertexRecords = 0;
+    stats.normalRecords = 0;
+    stats.texcoordRecords = 0;
+    stats.faceRecords = 0;
+    const char* line = buffer.data();
+    const char* const end = buffer.data() + buffer.size();
+    while(line < end)
+    {
+        if(*line == 'f')
+        {
+            ++stats.faceRecords;
+        }
+        else if((*line == 'v') && (line + 1 < end))
+        {
+            switch(line[1])
             {
-                // otherwise add the point
-                bb.add( p );
+                case ' ': ++stats.vertexRecords; break;
+                case 'n': ++stats.normalRecords; break;
+                case 't': ++stats.texcoordRecords; break;
+                default: break;
             }
         }
-        // If the first character is a 'f'...
-        if ( line[0] == 'f' )
+        const auto* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+        if(eol == nullptr)
+            break;
+        line = eol + 1;
+    }
+}
+
+/**
+ * Parse a line of the OBJ file and add its content (if it is a vertex or a face, or a normal
+ * or a texture coordinate if they are kept) to the model
+ * @tparam Chunk the type of the parsed data, ObjChunk or ObjSlice
+ * @param[in] line the line to parse
+ * @param[in,out] chunk the parsed data
+ */
+template <typename Chunk>
+void parseObjLine(std::string_view line, Chunk& chunk)
+{
+    // If the first character is a simple 'v'...
+    if ( (line.size( ) > 1) && (line[0] == 'v') && (line[1] == ' ') ) // to drop all the vn and vn lines
+    {
+        // Read 3 floats from the line:  X Y Z and store them in the corresponding place in _vertices
+        const point3d p = parseVertexString(line);
+
+        //**************************************************
+        // add the new point to the list of the vertices
+        //**************************************************
+        append(chunk.vertices, p, chunk.reallocations);
+
+        // update the bounding box, if it is the first vertex simply
+        // set the bb to it
+        if (chunk.vertices.size( ) == 1 )
+        {
+            chunk.bb.set( p );
+        }
+        else
+        {
+            // otherwise add the point
+            chunk.bb.add( p );
+        }
+    }
+    // If the first character is a 'f'...
+    else if ( !line.empty( ) && (line[0] == 'f') )
+    {
+        if ( !chunk.keepAttributes )
         {
             face t = parseFaceString( line);
 
             //**************************************************
             // correct the indices: OBJ starts counting from 1, in C the arrays starts at 0...
+            // and add it to the mesh
             //**************************************************
-            face t_corrected = {t.v1 - 1, t.v2 - 1, t.v3 - 1};
-
-            //**************************************************
-            // add it to the mesh
-            //**************************************************
-            mesh.push_back(t_corrected);
+            append(chunk.mesh, face(t.v1 - 1, t.v2 - 1, t.v3 - 1), chunk.reallocations);
+            return;
+        }
 
-            //*********************************************************************
-            //  Compute the normal of the face  (to be done for section 5.3)
-            //*********************************************************************
-            auto norm = computeNormal(vertices[t_corrected.v1], vertices[t_corrected.v2], vertices[t_corrected.v3]);
+        // same as above, but keeping also the normal and texture indices of each corner (a missing
+        // index becomes 0 - 1, ie out of range, and the face is counted as lacking it)
+        const FaceCorners corners = parseFaceCorners( line );
+        const face one(1, 1, 1);
+        append(chunk.mesh, corners.vertices - one, chunk.reallocations);
+        append(chunk.normalIndices, corners.normals - one, chunk.reallocations);
+        append(chunk.texcoordIndices, corners.texcoords - one, chunk.reallocations);
+        chunk.facesWithoutNormals += corners.hasNormals ? 0u : 1u;
+        chunk.facesWithoutTexcoords += corners.hasTexcoords ? 0u : 1u;
+    }
+    else if ( chunk.keepAttributes && (line.size( ) > 1) && (line[0] == 'v') && (line[1] == 'n') )
+    {
+        append(chunk.normals, parseNormalString(line), chunk.reallocations);
+    }
+    else if ( chunk.keepAttributes && (line.size( ) > 1) && (line[0] == 'v') && (line[1] == 't') )
+    {
+        append(chunk.texcoords, parseTexcoordString(line), chunk.reallocations);
+    }
+}
 
-            //*********************************************************************
-            // Sum the normal of the face to each vertex normal (to be done for section 5.3)
-            //*********************************************************************
-            normals[t_corrected.v1] += norm*angleAtVertex(vertices[t_corrected.v1], vertices[t_corrected.v2], vertices[t_corrected.v3]);
-            normals[t_corrected.v2] += norm*angleAtVertex(vertices[t_corrected.v2], vertices[t_corrected.v1], vertices[t_corrected.v3]);
-            normals[t_corrected.v3] += norm *angleAtVertex(vertices[t_corrected.v3], vertices[t_corrected.v1], vertices[t_corrected.v2]);
+/**
+ * Parse a portion of the content of an OBJ file in place, line by line
+ * @tparam Chunk the type of the parsed data, ObjChunk or ObjSlice
+ * @param[in] buffer the content to parse, made of whole lines
+ * @param[in,out] chunk the parsed data
+ */
+template <typename Chunk>
+void parseObjBuffer(std::string_view buffer, Chunk& chunk)
+{
+    const auto size = buffer.size();
+    std::size_t notified{0};
+    while(!buffer.empty())
+    {
+        const auto eol = buffer.find('\n');
+        const auto line = buffer.substr(0, eol);
+        parseObjLine(line, chunk);
+        if(eol == std::string_view::npos)
+            break;
+        buffer.remove_prefix(eol + 1);
 
+        if((chunk.progress != nullptr) && (size - buffer.size() - notified >= PROGRESS_BYTES))
+        {
+            chunk.progress->advance(size - buffer.size() - notified);
+            notified = size - buffer.size();
+            if(chunk.progress->cancelled())
+            {
+                return;
+            }
         }
     }
+    if(chunk.progress != nullptr)
+    {
+        chunk.progress->advance(size - notified);
+    }
+}
+
+/**
+ * Count the records of a portion of the content of an OBJ file, reserve the exact space
+ * for them and parse it
+ * @param[in] buffer the content to parse, made of whole lines
+ * @param[in,out] chunk the parsed data
+ * @param[in,out] stats the number of records found are added to the statistics
+ */
+void scanAndParseObjBuffer(std::string_view buffer, ObjChunk& chunk, LoadStatistics& stats)
+{
+    countRecords(buffer, stats);
+    reserveMore(chunk.vertices, stats.vertexRecords, chunk.reallocations);
+    reserveMore(chunk.mesh, stats.faceRecords, chunk.reallocations);
+    if(chunk.keepAttributes)
+    {
+        reserveMore(chunk.normals, stats.normalRecords, chunk.reallocations);
+        reserveMore(chunk.texcoords, stats.texcoordRecords, chunk.reallocations);
+        reserveMore(chunk.normalIndices, stats.faceRecords, chunk.reallocations);
+        reserveMore(chunk.texcoordIndices, stats.faceRecords, chunk.reallocations);
+    }
+    parseObjBuffer(buffer, chunk);
+}
 
-    std::cerr << "Found :\n\tNumber of triangles (_indices) " << mesh.size( ) << "\n\tNumber of Vertices: " << vertices.size( ) << "\n\tNumber of Normals: " << normals.size( ) << std::endl;
-       PRINTVAR( mesh );
-       PRINTVAR( vertices );
-       PRINTVAR( normals );
+/**
+ * Split the content of the file in chunks made of whole lines
+ * @param[in] buffer the content of the file
+ * @param[in] numChunks the number of chunks
+ * @return the chunks, some of them may be empty
+ */
+std::vector<std::string_view> splitLines(std::string_view buffer, std::size_t numChunks)
+{
+    std::vector<std::string_view> chunks;
+    chunks.reserve(numChunks);
+    std::size_t begin{0};
+    for(std::size_t i = 1; i <= numChunks; ++i)
+    {
+        auto end = buffer.size();
+        if(i < numChunks)
+        {
+            // move the nominal end to the beginning of the next line
+            end = std::max(begin, (buffer.size() * i) / numChunks);
+            const auto eol = buffer.find('\n', end);
+            end = (eol == std::string_view::npos) ? buffer.size() : eol + 1;
+        }
+        chunks.push_back(buffer.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
 
-    //*********************************************************************
-    // normalize the normals of each vertex (to be done for section 5.3)
-    //*********************************************************************
-    for (auto& normal : normals){
-        normal.normalize();
+/**
+ * Parse the whole content of an OBJ file using several threads. The file is split in chunks
+ * made of whole lines: the records of each chunk are counted first, then the lists are sized
+ * once and each chunk is parsed straight into its part of the lists, whose offset is the prefix
+ * sum of the records of the previous chunks. The result is the same as the sequential parsing.
+ * @param[in] buffer the content of the file
+ * @param[in,out] result the parsed data, the content of the file is appended to it
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in,out] stats The loading statistics
+ */
+void parseObjBufferParallel(std::string_view buffer, ObjChunk& result, unsigned int threads, LoadStatistics& stats)
+{
+    const auto numChunks = std::min<std::size_t>(threadCount(threads), std::max<std::size_t>(1, buffer.size() / MIN_CHUNK_BYTES));
+    if(numChunks == 1)
+    {
+        // parse directly in the output lists
+        scanAndParseObjBuffer(buffer, result, stats);
+        return;
     }
 
+    // count the records of each chunk
+    const auto lines = splitLines(buffer, numChunks);
+    std::vector<LoadStatistics> chunkStats(numChunks);
+    parallelChunks(numChunks, static_cast<unsigned int>(numChunks), [&](std::size_t c, std::size_t, std::size_t) {
+        countRecords(lines[c], chunkStats[c]);
+    });
 
-       PRINTVAR( normals );
+    // the part of each chunk in the lists begins after the records of the previous chunks
+    const auto firstVertex = result.vertices.size();
+    const auto firstFace = result.mesh.size();
+    const auto firstNormal = result.normals.size();
+    const auto firstTexcoord = result.texcoords.size();
+    for(const auto& chunk : chunkStats)
+    {
+        stats.vertexRecords += chunk.vertexRecords;
+        stats.normalRecords += chunk.normalRecords;
+        stats.texcoordRecords += chunk.texcoordRecords;
+        stats.faceRecords += chunk.faceRecords;
+    }
+    resize(result.vertices, firstVertex + stats.vertexRecords, result.reallocations);
+    resize(result.mesh, firstFace + stats.faceRecords, result.reallocations);
+    if(result.keepAttributes)
+    {
+        resize(result.normals, firstNormal + stats.normalRecords, result.reallocations);
+        resize(result.texcoords, firstTexcoord + stats.texcoordRecords, result.reallocations);
+        resize(result.normalIndices, firstFace + stats.faceRecords, result.reallocations);
+        resize(result.texcoordIndices, firstFace + stats.faceRecords, result.reallocations);
+    }
 
-    // Close OBJ file
-    objFile.close();
+    std::vector<ObjSlice> slices(numChunks);
+    auto vertex = firstVertex;
+    auto faceRecord = firstFace;
+    auto normal = firstNormal;
+    auto texcoordRecord = firstTexcoord;
+    for(std::size_t c = 0; c < numChunks; ++c)
+    {
+        const auto& counts = chunkStats[c];
+        auto& slice = slices[c];
+        slice.keepAttributes = result.keepAttributes;
+        slice.progress = result.progress;
+        slice.vertices = ListSlice<point3d>(result.vertices, vertex, counts.vertexRecords);
+        slice.mesh = ListSlice<face>(result.mesh, faceRecord, counts.faceRecords);
+        if(result.keepAttributes)
+        {
+            slice.normals = ListSlice<vec3d>(result.normals, normal, counts.normalRecords);
+            slice.texcoords = ListSlice<texcoord>(result.texcoords, texcoordRecord, counts.texcoordRecords);
+            slice.normalIndices = ListSlice<face>(result.normalIndices, faceRecord, counts.faceRecords);
+            slice.texcoordIndices = ListSlice<face>(result.texcoordIndices, faceRecord, counts.faceRecords);
+        }
+        vertex += counts.vertexRecords;
+        faceRecord += counts.faceRecords;
+        normal += counts.normalRecords;
+        texcoordRecord += counts.texcoordRecords;
+    }
 
+    // parse each chunk in its part
+    parallelChunks(numChunks, static_cast<unsigned int>(numChunks), [&](std::size_t c, std::size_t, std::size_t) {
+        parseObjBuffer(lines[c], slices[c]);
+        assert((slices[c].vertices.full() && slices[c].mesh.full()) || ((result.progress != nullptr) && result.progress->cancelled()));
+    });
 
-    std::cout << "Object loaded with " << vertices.size( ) << " vertices and " << mesh.size( ) << " faces" << std::endl;
-    std::cout << "Bounding box : pmax=" << bb.pmax << "  pmin=" << bb.pmin << std::endl;
-    return true;
+    // the bounding box is the reduction of the bounding boxes of the chunks
+    auto numVertices = firstVertex;
+    for(const auto& slice : slices)
+    {
+        if(slice.vertices.size() != 0)
+        {
+            if(numVertices == 0)
+            {
+                result.bb = slice.bb;
+            }
+            else
+            {
+                result.bb.add(slice.bb.pmin);
+                result.bb.add(slice.bb.pmax);
+            }
+        }
+        numVertices += slice.vertices.size();
+        result.facesWithoutNormals += slice.facesWithoutNormals;
+        result.facesWithoutTexcoords += slice.facesWithoutTexcoords;
+    }
 }
 
+/**
+ * Return true if all the indices refer to an element of a list
+ * @param[in] indices the indices, one triplet per face
+ * @param[in] size the size of the list
+ * @return true if all the indices are in range
+ */
+bool indicesInRange(const std::vector<face>& indices, std::size_t size)
+{
+    return std::all_of(indices.begin(), indices.end(), [size](const face& f) {
+        return (f.v1 < size) && (f.v2 < size) && (f.v3 < size);
+    });
+}
 
+/**
+ * Give each vertex the normal and the texture coordinates referenced by the face corners of
+ * the file. A vertex used by corners referencing different normals (e.g. along a crease) or
+ * different texture coordinates (e.g. along a seam of the texture) is duplicated, one copy for
+ * each pair of normal and texture coordinates, and the corners are remapped to the copies. The
+ * corners are visited in face order, so the first pair found for a vertex keeps the original index.
+ * @param[in,out] parsed the parsed data, its vertices and faces are updated
+ * @param[in] useNormals true to take the normals of the file
+ * @param[in] useTexcoords true to take the texture coordinates of the file
+ * @param[out] normals the normal of each vertex, if useNormals
+ * @param[out] texcoords the texture coordinates of each vertex, if useTexcoords
+ */
+void resolveAttributes(ObjChunk& parsed, bool useNormals, bool useTexcoords, std::vector<vec3d>& normals, std::vector<texcoord>& texcoords)
+{
+    // the (texture coordinate, normal) pair of each vertex, if already assigned
+    using attributes = std::pair<idxtype, idxtype>;
+    constexpr idxtype unassigned = std::numeric_limits<idxtype>::max();
+    const attributes none(unassigned, unassigned);
+    std::vector<attributes> assigned(parsed.vertices.size(), none);
+    std::map<std::pair<idxtype, attributes>, idxtype> copies;
 
+    const auto resolve = [&](idxtype& v, idxtype t, idxtype n) {
+        const attributes a(useTexcoords ? t : 0, useNormals ? n : 0);
+        if((assigned[v] != none) && (assigned[v] != a))
+        {
+            const auto [it, inserted] = copies.try_emplace(std::make_pair(v, a), static_cast<idxtype>(parsed.vertices.size()));
+            if(inserted)
+            {
+                append(parsed.vertices, point3d(parsed.vertices[v]), parsed.reallocations);
+                assigned.push_back(none);
+            }
+            v = it->second;
+        }
+        if(assigned[v] == none)
+        {
+            assigned[v] = a;
+        }
+    };
 
+    for(std::size_t i = 0; i < parsed.mesh.size(); ++i)
+    {
+        auto& f = parsed.mesh[i];
+        const auto& t = parsed.texcoordIndices[i];
+        const auto& n = parsed.normalIndices[i];
+        resolve(f.v1, t.v1, n.v1);
+        resolve(f.v2, t.v2, n.v2);
+        resolve(f.v3, t.v3, n.v3);
+    }
 
+    // vertices not referenced by any face get a null normal and null texture coordinates
+    if(useNormals)
+    {
+        resize(normals, parsed.vertices.size(), parsed.reallocations);
+        for(std::size_t v = 0; v < assigned.size(); ++v)
+        {
+            normals[v] = (assigned[v].second == unassigned) ? vec3d() : parsed.normals[assigned[v].second];
+            normals[v].normalize();
+        }
+    }
+    if(useTexcoords)
+    {
+        resize(texcoords, parsed.vertices.size(), parsed.reallocations);
+        for(std::size_t v = 0; v < assigned.size(); ++v)
+        {
+            texcoords[v] = (assigned[v].first == unassigned) ? texcoord() : parsed.texcoords[assigned[v].first];
+        }
+    }
+}
 
+}  // namespace
 
-//////////////////////////////////////// Nothing to do after this /////////////////////////////////
-
-// lambda to convert the string matches to a face
-auto face_from_match(const std::string& vst1, const std::string& vst2, const std::string& vst3) -> face
+bool load(const std::string& filename,
+          std::vector<point3d>& vertices,
+          std::vector<face>& mesh,
+          std::vector<vec3d>& normals,
+          BoundingBox& bb,
+          const LoadParameters& params)
 {
-    const auto v1 = static_cast<idxtype>(std::stoi(vst1));
-    const auto v2 = static_cast<idxtype>(std::stoi(vst2));
-    const auto v3 = static_cast<idxtype>(std::stoi(vst3));
-    return {v1, v2, v3};
+    std::vector<texcoord> texcoords;
+    LoadStatistics stats;
+    return load(filename, vertices, mesh, normals, texcoords, bb, stats, params);
 }
 
-face parseFaceString(const std::string &toParse)
+/**
+ * Load the OBJ data from file
+ * @param[in] filename The name of the OBJ file to load
+ * @param[out] vertices The list of vertices
+ * @param[out] mesh The list of faces
+ * @param[out] normals The list of normals
+ * @param[out] texcoords The list of texture coordinates
+ * @param[out] bb The bounding box of the object
+ * @param[out] stats The loading statistics
+ * @param[in] params The loading parameters
+ * @return true if everything went well, false otherwise
+ */
+bool load(const std::string& filename,
+          std::vector<point3d>& vertices,
+          std::vector<face>& mesh,
+          std::vector<vec3d>& normals,
+          std::vector<texcoord>& texcoords,
+          BoundingBox& bb,
+          LoadStatistics& stats,
+          const LoadParameters& params)
 {
-    const auto res = parseFaceStringRegex(toParse);
-    if(!res.has_value())
-        throw std::invalid_argument("Error while reading line: " + toParse);
+    const auto start = std::chrono::steady_clock::now( );
+    stats = LoadStatistics( );
 
-    return res.value();
-}
+    // parse directly in the output lists
+    ObjChunk parsed;
+    parsed.vertices.swap( vertices );
+    parsed.mesh.swap( mesh );
+    parsed.bb = bb;
+    parsed.keepAttributes = params.useFileAttributes;
+    if ( parsed.keepAttributes && !( parsed.vertices.empty( ) && parsed.mesh.empty( ) ) )
+    {
+        // the corners of the file are parallel to its faces only, not to those already in the lists
+        std::cerr << "The normals and the texture coordinates of " << filename << " can only be kept when loading into empty lists" << std::endl;
+        parsed.vertices.swap( vertices );
+        parsed.mesh.swap( mesh );
+        return false;
+    }
 
-std::optional<face> parseFaceStringRegex( const std::string &toParse)
-{
-    static const std::array<std::regex, 4> face_regexes {
-          // regex to match a face from a string in the format f v1 v2 v3
-          std::regex(R"(f\s+(\d+)\s+(\d+)\s+(\d+))"),
-          // regex to match a face from a string in the format f v1/t1 v2/t2 v3/t3
-          std::regex(R"(f\s+(\d+)(?:\/\d+){1}\s+(\d+)(?:\/\d+){1}\s+(\d+)(?:\/\d+){1})"),
-          // regex to match a face from a string in the format f v1/t1/n1 v2/t2/n2 v3/t3/n3
-          std::regex(R"(f\s+(\d+)(?:\/\d+){2}\s+(\d+)(?:\/\d+){2}\s+(\d+)(?:\/\d+){2})"),
-          // regex to match a face from a string in the format f v1//n1 v2//n2 v3//n3
-          std::regex (R"(f\s+(\d+)(?:\/\/\d+){1}\s+(\d+)(?:\/\/\d+){1}\s+(\d+)(?:\/\/\d+){1})")
-    };
+    if ( params.useMemoryMapping )
+    {
+        // map the whole file (or read it at once if mapping is not available) and parse it in place
+        MappedFile objFile;
+        if ( !objFile.open( filename ) )
+        {
+            std::cerr << "Unable to open file " << filename << std::endl;
+            parsed.vertices.swap( vertices );
+            parsed.mesh.swap( mesh );
+            return false;
+        }
+        ParseProgress progress( params.progress, objFile.size( ), params.cancel );
+        parsed.progress = &progress;
+        parseObjBufferParallel( objFile.view( ), parsed, params.threads, stats );
+        parsed.progress = nullptr;
+    }
+    else
+    {
+        std::string line;
+        std::ifstream objFile( filename );
+
+        // If obj file is not open return (e.g. file does not exist
+        if (! objFile.is_open( ) )
+        {
+            std::cerr << "Unable to open file " << filename << std::endl;
+            parsed.vertices.swap( vertices );
+            parsed.mesh.swap( mesh );
+            return false;
+        }
+
+        // Start reading file data, a line at a time: the number of records is not known in advance
+        std::error_code ec;
+        ParseProgress progress( params.progress, static_cast<std::size_t>( std::filesystem::file_size( filename, ec ) ), params.cancel );
+        std::size_t notified{0};
+        std::size_t read{0};
+        while( getline( objFile, line ) )
+        {
+            parseObjLine( line, parsed );
+            read += line.size( ) + 1;
+            if ( read - notified >= PROGRESS_BYTES )
+            {
+                progress.advance( read - notified );
+                notified = read;
+                if ( progress.cancelled( ) )
+                {
+                    break;
+                }
+            }
+        }
+        progress.advance( read - notified );
+    }
 
-    // early exit if the string is empty or does not start with 'f'
-    if (toParse.empty() || toParse[0] != 'f' )
+    if ( ( params.cancel != nullptr ) && params.cancel->load( std::memory_order_relaxed ) )
     {
-        return {};
+        std::cerr << "The load of " << filename << " has been cancelled" << std::endl;
+        parsed.vertices.swap( vertices );
+        parsed.mesh.swap( mesh );
+        return false;
+    }
+
+    //*********************************************************************
+    // keep the normals and the texture coordinates of the file only if every face
+    // references valid ones, otherwise ignore them
+    //*********************************************************************
+    const bool useNormals = parsed.keepAttributes && !parsed.mesh.empty( ) && ( parsed.facesWithoutNormals == 0 )
+                            && indicesInRange( parsed.normalIndices, parsed.normals.size( ) );
+    const bool useTexcoords = parsed.keepAttributes && !parsed.mesh.empty( ) && ( parsed.facesWithoutTexcoords == 0 )
+                              && indicesInRange( parsed.texcoordIndices, parsed.texcoords.size( ) );
+    texcoords.clear( );
+    if ( useNormals || useTexcoords )
+    {
+        resolveAttributes( parsed, useNormals, useTexcoords, normals, texcoords );
     }
 
-    std::smatch face_match;
+    parsed.vertices.swap( vertices );
+    parsed.mesh.swap( mesh );
+    bb = parsed.bb;
+    stats.reallocations += parsed.reallocations;
+    stats.fileNormals = useNormals;
 
-    // try to match the string to each of the regexes
-    for(const auto& face_regex : face_regexes)
+    const auto parseEnd = std::chrono::steady_clock::now( );
+    stats.parseSeconds = std::chrono::duration<double>( parseEnd - start ).count( );
+
+    //*********************************************************************
+    // compute the normal of each vertex, once the whole mesh is known
+    // (unless the file already provides them)
+    //*********************************************************************
+    if ( !useNormals )
     {
-        if(std::regex_search(toParse, face_match, face_regex))
+        if ( normals.capacity( ) < vertices.size( ) )
         {
-            return face_from_match(face_match[1], face_match[2], face_match[3]);
+            stats.reallocations += normals.empty( ) ? 0u : 1u;
         }
+        computeVertexNormals( vertices, mesh, normals, params.threads );
     }
+    stats.normalsSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now( ) - parseEnd ).count( );
+
+    std::cerr << "Found :\n\tNumber of triangles (_indices) " << mesh.size( ) << "\n\tNumber of Vertices: " << vertices.size( ) << "\n\tNumber of Normals: " << normals.size( ) << ( useNormals ? " (from file)" : "" ) << "\n\tNumber of Texture coordinates: " << texcoords.size( ) << "\n\tNumber of reallocations: " << stats.reallocations << "\n\tParsing time: " << stats.parseSeconds << "s\n\tNormals time: " << stats.normalsSeconds << "s" << std::endl;
 
-    // if no match was found, return an empty optional
-    return {};
+    std::cout << "Object loaded with " << vertices.size( ) << " vertices and " << mesh.size( ) << " faces" << std::endl;
+    std::cout << "Bounding box : pmax=" << bb.pmax << "  pmin=" << bb.pmin << std::endl;
+    return true;
 }
 
-point3d parseVertexString(const std::string &toParse)
+
+
+
+
+
+//////////////////////////////////////// Nothing to do after this /////////////////////////////////
+
+namespace
 {
-    const auto res = parseVertexStringRegex(toParse);
-    if(!res.has_value())
-        throw std::invalid_argument("Error while reading line: " + toParse);
 
-    return res.value();
+/**
+ * Return true if the character is a whitespace, ie the same characters matched by \s
+ * @param[in] c the character
+ * @return true if it is a whitespace
+ */
+constexpr bool isSpace(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f');
 }
 
-std::optional<point3d> parseVertexStringRegex(const std::string &toParse)
+/**
+ * Return true if the character is a decimal digit
+ * @param[in] c the character
+ * @return true if it is a digit
+ */
+constexpr bool isDigit(char c)
 {
-    // float = ([+-]?(?:[0-9]*[.])?[0-9]+(?:[eE][-+]?[0-9]+)?) catches a float number in scientific notation, with or without
-    // exponent, with or without sign
-    // we are looking for 3 floats, separated by spaces and starting with 'v'
-    // the floats are the x, y, z coordinates of the vertex
-    // v\s+float\s+float\s+float
-    static const std::regex vertex_regex(R"(v\s+([+-]?(?:[0-9]*[.])?[0-9]+(?:[eE][-+]?[0-9]+)?)\s+([+-]?(?:[0-9]*[.])?[0-9]+(?:[eE][-+]?[0-9]+)?)\s+([+-]?(?:[0-9]*[.])?[0-9]+(?:[eE][-+]?[0-9]+)?))");
-
-    // early exit if the string is empty or does not start with 'v'
-    if (toParse.empty() || toParse[0] != 'v' )
-    {
-        return {};
-    }
+    return (c >= '0') && (c <= '9');
+}
 
-    // try to match the string to the regex
-    if(std::smatch vertex_match; std::regex_search(toParse, vertex_match, vertex_regex))
-    {
-        const auto x = std::stof(vertex_match[1]);
-        const auto y = std::stof(vertex_match[2]);
-        const auto z = std::stof(vertex_match[3]);
-        return point3d(x, y, z);
-    }
+/**
+ * Consume the leading whitespaces of the string
+ * @param[in,out] s the string, on return it starts at the first non-whitespace character
+ * @return true if at least one whitespace has been consumed
+ */
+bool skipSpaces(std::string_view& s)
+{
+    std::size_t i{0};
+    while((i < s.size()) && isSpace(s[i]))
+        ++i;
+    s.remove_prefix(i);
+    return i > 0;
+}
 
-    // if no match was found, return an empty optional
-    return {};
+/**
+ * Consume the given character if it is the first one of the string
+ * @param[in,out] s the string
+ * @param[in] c the expected character
+ * @return true if the character has been consumed
+ */
+bool skipChar(std::string_view& s, char c)
+{
+    if(s.empty() || (s[0] != c))
+        return false;
+    s.remove_prefix(1);
+    return true;
 }
 
+/**
+ * Parse an index (a sequence of digits, ie \d+) at the beginning of the string
+ * @param[in,out] s the string, on success it starts right after the index
+ * @param[out] value the parsed index
+ * @return true if an index has been parsed
+ */
+bool parseIndex(std::string_view& s, idxtype& value)
+{
+    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if(ec != std::errc())
+        return false;
+    s.remove_prefix(static_cast<std::size_t>(ptr - s.data()));
+    return true;
+}
+
+/**
+ * Parse a float at the beginning of the string. The accepted syntax is the one of the
+ * former regex [+-]?(?:[0-9]*[.])?[0-9]+(?:[eE][-+]?[0-9]+)?, ie with or without sign,
+ * with or without exponent. The characters following the number are not consumed.
+ * @param[in,out] s the string, on success it starts right after the number
+ * @param[out] value the parsed number
+ * @return true if a number has been parsed
+ */
+bool parseFloat(std::string_view& s, float& value)
+{
+    const auto n = s.size();
+    std::size_t i{0};
+    if((i < n) && ((s[i] == '+') || (s[i] == '-')))
+        ++i;
+    // from_chars does not accept the leading +
+    const std::size_t numberBegin = ((n > 0) && (s[0] == '+')) ? 1 : 0;
+
+    const auto intBegin = i;
+    while((i < n) && isDigit(s[i]))
+        ++i;
+    const auto intDigits = i - intBegin;
+
+    // a decimal point must be followed by at least one digit, otherwise the number ends before it
+    if((i < n) && (s[i] == '.') && (i + 1 < n) && isDigit(s[i + 1]))
+    {
+        i += 2;
+        while((i < n) && isDigit(s[i]))
+            ++i;
+    }
+    else if(intDigits == 0)
+    {
+        return false;
+    }
+
+    // the exponent is taken only if it is well formed
+    if((i < n) && ((s[i] == 'e') || (s[i] == 'E')))
+    {
+        auto j = i + 1;
+        if((j < n) && ((s[j] == '+') || (s[j] == '-')))
+            ++j;
+        if((j < n) && isDigit(s[j]))
+        {
+            while((j < n) && isDigit(s[j]))
+                ++j;
+            i = j;
+        }
+    }
+
+    const auto [ptr, ec] = std::from_chars(s.data() + numberBegin, s.data() + i, value);
+    if((ec != std::errc()) || (ptr != s.data() + i))
+        return false;
+    s.remove_prefix(i);
+    return true;
+}
+
+/**
+ * The different layouts of a face corner in the OBJ format
+ */
+enum class CornerFormat
+{
+    /// v
+    vertex,
+    /// v/t
+    vertexTexture,
+    /// v/t/n
+    vertexTextureNormal,
+    /// v//n
+    vertexNormal
+};
+
+/**
+ * Parse the first corner of a face and detect its format, which all the other corners must follow
+ * @param[in,out] s the string, on success it starts right after the corner
+ * @param[out] v the vertex index
+ * @param[out] t the texture coordinate index, if any
+ * @param[out] n the normal index, if any
+ * @param[out] format the detected format
+ * @return true if the corner has been parsed
+ */
+bool parseFirstCorner(std::string_view& s, idxtype& v, idxtype& t, idxtype& n, CornerFormat& format)
+{
+    if(!parseIndex(s, v))
+        return false;
+
+    if(skipChar(s, '/'))
+    {
+        if(skipChar(s, '/'))
+        {
+            format = CornerFormat::vertexNormal;
+            return parseIndex(s, n);
+        }
+        if(!parseIndex(s, t))
+            return false;
+        if(skipChar(s, '/'))
+        {
+            format = CornerFormat::vertexTextureNormal;
+            return parseIndex(s, n);
+        }
+        format = CornerFormat::vertexTexture;
+        return true;
+    }
+    format = CornerFormat::vertex;
+    return true;
+}
+
+/**
+ * Parse a corner of a face with the given format
+ * @param[in,out] s the string, on success it starts right after the corner
+ * @param[in] format the expected format
+ * @param[out] v the vertex index
+ * @param[out] t the texture coordinate index, if any
+ * @param[out] n the normal index, if any
+ * @return true if the corner has been parsed
+ */
+bool parseCorner(std::string_view& s, CornerFormat format, idxtype& v, idxtype& t, idxtype& n)
+{
+    if(!parseIndex(s, v))
+        return false;
+
+    switch(format)
+    {
+        case CornerFormat::vertex: return true;
+        case CornerFormat::vertexTexture: return skipChar(s, '/') && parseIndex(s, t);
+        case CornerFormat::vertexTextureNormal:
+            return skipChar(s, '/') && parseIndex(s, t) && skipChar(s, '/') && parseIndex(s, n);
+        case CornerFormat::vertexNormal: return skipChar(s, '/') && skipChar(s, '/') && parseIndex(s, n);
+    }
+    return false;
+}
+
+/**
+ * Consume the given keyword and the whitespaces following it at the beginning of the string
+ * @param[in,out] s the string
+ * @param[in] keyword the expected keyword (e.g. vn)
+ * @return true if the keyword, followed by at least a whitespace, has been consumed
+ */
+bool skipKeyword(std::string_view& s, std::string_view keyword)
+{
+    if(s.substr(0, keyword.size()) != keyword)
+        return false;
+    s.remove_prefix(keyword.size());
+    return skipSpaces(s);
+}
+
+/**
+ * Parse 3 floats separated by whitespaces at the beginning of the string; anything can
+ * follow the last one
+ * @param[in,out] s the string, on success it starts right after the last float
+ * @param[out] p the 3 floats
+ * @return true if the floats have been parsed
+ */
+bool parseFloatTriplet(std::string_view& s, v3f& p)
+{
+    return parseFloat(s, p.x) && skipSpaces(s) && parseFloat(s, p.y) && skipSpaces(s) && parseFloat(s, p.z);
+}
+
+}  // namespace
+
+face parseFaceString(std::string_view toParse)
+{
+    const auto res = tryParseFaceString(toParse);
+    if(!res.has_value())
+        throw std::invalid_argument("Error while reading line: " + std::string(toParse));
+
+    return res.value();
+}
+
+std::optional<face> tryParseFaceString(std::string_view toParse)
+{
+    const auto res = tryParseFaceCorners(toParse);
+    if(!res.has_value())
+        return {};
+
+    return res->vertices;
+}
+
+FaceCorners parseFaceCorners(std::string_view toParse)
+{
+    const auto res = tryParseFaceCorners(toParse);
+    if(!res.has_value())
+        throw std::invalid_argument("Error while reading line: " + std::string(toParse));
+
+    return res.value();
+}
+
+std::optional<FaceCorners> tryParseFaceCorners(std::string_view toParse)
+{
+    // the string must start with 'f' followed by at least a whitespace
+    if(!skipChar(toParse, 'f') || !skipSpaces(toParse))
+    {
+        return {};
+    }
+
+    FaceCorners f{};
+    CornerFormat format{};
+
+    // the first two corners must be followed by whitespaces, while anything can follow the last one
+    // (e.g. the 4th corner of a quad, which is ignored)
+    if(!parseFirstCorner(toParse, f.vertices.v1, f.texcoords.v1, f.normals.v1, format) || !skipSpaces(toParse))
+        return {};
+    if(!parseCorner(toParse, format, f.vertices.v2, f.texcoords.v2, f.normals.v2) || !skipSpaces(toParse))
+        return {};
+    if(!parseCorner(toParse, format, f.vertices.v3, f.texcoords.v3, f.normals.v3))
+        return {};
+
+    f.hasTexcoords = (format == CornerFormat::vertexTexture) || (format == CornerFormat::vertexTextureNormal);
+    f.hasNormals = (format == CornerFormat::vertexNormal) || (format == CornerFormat::vertexTextureNormal);
+    return f;
+}
+
+point3d parseVertexString(std::string_view toParse)
+{
+    const auto res = tryParseVertexString(toParse);
+    if(!res.has_value())
+        throw std::invalid_argument("Error while reading line: " + std::string(toParse));
+
+    return res.value();
+}
+
+std::optional<point3d> tryParseVertexString(std::string_view toParse)
+{
+    // we are looking for 3 floats, separated by spaces and starting with 'v'
+    // the floats are the x, y, z coordinates of the vertex
+    if(!skipChar(toParse, 'v') || !skipSpaces(toParse))
+    {
+        return {};
+    }
+
+    point3d p;
+    if(!parseFloat(toParse, p.x) || !skipSpaces(toParse))
+        return {};
+    if(!parseFloat(toParse, p.y) || !skipSpaces(toParse))
+        return {};
+    if(!parseFloat(toParse, p.z))
+        return {};
+
+    return p;
+}
+
+vec3d parseNormalString(std::string_view toParse)
+{
+    const auto res = tryParseNormalString(toParse);
+    if(!res.has_value())
+        throw std::invalid_argument("Error while reading line: " + std::string(toParse));
+
+    return res.value();
+}
+
+std::optional<vec3d> tryParseNormalString(std::string_view toParse)
+{
+    // we are looking for 3 floats, separated by spaces and starting with 'vn'
+    vec3d n;
+    if(!skipKeyword(toParse, "vn") || !parseFloatTriplet(toParse, n))
+        return {};
+
+    return n;
+}
+
+texcoord parseTexcoordString(std::string_view toParse)
+{
+    const auto res = tryParseTexcoordString(toParse);
+    if(!res.has_value())
+        throw std::invalid_argument("Error while reading line: " + std::string(toParse));
+
+    return res.value();
+}
+
+std::optional<texcoord> tryParseTexcoordString(std::string_view toParse)
+{
+    // we are looking for 1 to 3 floats, separated by spaces and starting with 'vt':
+    // the missing coordinates are 0
+    texcoord t;
+    if(!skipKeyword(toParse, "vt") || !parseFloat(toParse, t.x))
+        return {};
+    if(skipSpaces(toParse) && parseFloat(toParse, t.y) && skipSpaces(toParse))
+    {
+        parseFloat(toParse, t.z);
+    }
+
+    return t;
+}
+
+//////////////////////////////////////// PLY files /////////////////////////////////
+
+namespace
+{
+
+/**
+ * The encoding of the data of a PLY file
+ */
+enum class PlyFormat
+{
+    /// whitespace separated values
+    ascii,
+    /// binary, little endian
+    binaryLittleEndian,
+    /// binary, big endian
+    binaryBigEndian
+};
+
+/**
+ * The scalar types of the PLY properties
+ */
+enum class PlyType
+{
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    float32,
+    float64
+};
+
+/**
+ * A property of an element of a PLY file
+ */
+struct PlyProperty
+{
+    /// the name of the property
+    std::string name{};
+    /// the type of the property (of the items, for a list)
+    PlyType type{PlyType::float32};
+    /// true if the property is a list, ie a count followed by that many items
+    bool isList{false};
+    /// the type of the count of the list
+    PlyType countType{PlyType::uint8};
+};
+
+/**
+ * An element of a PLY file, ie a group of records with the same properties
+ */
+struct PlyElement
+{
+    /// the name of the element (e.g. vertex, face)
+    std::string name{};
+    /// the number of records
+    std::size_t count{0};
+    /// the properties of each record, in the order they are stored
+    std::vector<PlyProperty> properties{};
+
+    /**
+     * Return the index of a property
+     * @param[in] propertyName the name of the property
+     * @return the index of the property, or the number of properties if there is no such property
+     */
+    [[nodiscard]] std::size_t find(std::string_view propertyName) const
+    {
+        const auto it = std::find_if(properties.begin(), properties.end(), [&](const PlyProperty& p) { return p.name == propertyName; });
+        return static_cast<std::size_t>(it - properties.begin());
+    }
+
+    /**
+     * Return true if no property is a list, ie all the records have the same size
+     * @return true if the records have a fixed size
+     */
+    [[nodiscard]] bool fixedSize() const
+    {
+        return std::none_of(properties.begin(), properties.end(), [](const PlyProperty& p) { return p.isList; });
+    }
+};
+
+/**
+ * The header of a PLY file
+ */
+struct PlyHeader
+{
+    /// the encoding of the data
+    PlyFormat format{PlyFormat::ascii};
+    /// the elements, in the order they are stored
+    std::vector<PlyElement> elements{};
+    /// the size in bytes of the header, ie the offset of the data
+    std::size_t size{0};
+};
+
+/**
+ * Return the size in bytes of a type
+ * @param[in] type the type
+ * @return its size
+ */
+constexpr std::size_t typeSize(PlyType type)
+{
+    switch(type)
+    {
+        case PlyType::int8:
+        case PlyType::uint8: return 1;
+        case PlyType::int16:
+        case PlyType::uint16: return 2;
+        case PlyType::int32:
+        case PlyType::uint32:
+        case PlyType::float32: return 4;
+        case PlyType::float64: return 8;
+    }
+    return 0;
+}
+
+/**
+ * Parse the name of a type, both the original names (e.g. uchar) and the sized ones (e.g. uint8)
+ * @param[in] name the name
+ * @param[out] type the type
+ * @return true if the name is a known type
+ */
+bool parsePlyType(std::string_view name, PlyType& type)
+{
+    static const std::pair<std::string_view, PlyType> names[] = {
+        {"char", PlyType::int8},     {"int8", PlyType::int8},       {"uchar", PlyType::uint8},    {"uint8", PlyType::uint8},
+        {"short", PlyType::int16},   {"int16", PlyType::int16},     {"ushort", PlyType::uint16},  {"uint16", PlyType::uint16},
+        {"int", PlyType::int32},     {"int32", PlyType::int32},     {"uint", PlyType::uint32},    {"uint32", PlyType::uint32},
+        {"float", PlyType::float32}, {"float32", PlyType::float32}, {"double", PlyType::float64}, {"float64", PlyType::float64}};
+    for(const auto& [n, t] : names)
+    {
+        if(n == name)
+        {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Split a line of the header in whitespace separated words
+ * @param[in] line the line
+ * @return the words
+ */
+std::vector<std::string_view> splitWords(std::string_view line)
+{
+    std::vector<std::string_view> words;
+    skipSpaces(line);
+    while(!line.empty())
+    {
+        std::size_t i{0};
+        while((i < line.size()) && !isSpace(line[i]))
+            ++i;
+        words.push_back(line.substr(0, i));
+        line.remove_prefix(i);
+        skipSpaces(line);
+    }
+    return words;
+}
+
+/**
+ * Parse the header of a PLY file
+ * @param[in] buffer the content of the file
+ * @param[out] header the header
+ * @return true if the header is valid, false otherwise (and the reason is printed)
+ */
+bool parsePlyHeader(std::string_view buffer, PlyHeader& header)
+{
+    std::size_t offset{0};
+    bool first{true};
+    bool formatFound{false};
+    while(offset < buffer.size())
+    {
+        const auto eol = buffer.find('\n', offset);
+        if(eol == std::string_view::npos)
+            break;
+        const auto words = splitWords(buffer.substr(offset, eol - offset));
+        offset = eol + 1;
+
+        if(first)
+        {
+            if((words.size() != 1) || (words[0] != "ply"))
+            {
+                std::cerr << "Not a PLY file" << std::endl;
+                return false;
+            }
+            first = false;
+        }
+        else if(words.empty() || (words[0] == "comment") || (words[0] == "obj_info"))
+        {
+            continue;
+        }
+        else if((words[0] == "format") && (words.size() == 3))
+        {
+            if(words[1] == "ascii")
+                header.format = PlyFormat::ascii;
+            else if(words[1] == "binary_little_endian")
+                header.format = PlyFormat::binaryLittleEndian;
+            else if(words[1] == "binary_big_endian")
+                header.format = PlyFormat::binaryBigEndian;
+            else
+            {
+                std::cerr << "Unknown PLY format " << words[1] << std::endl;
+                return false;
+            }
+            formatFound = true;
+        }
+        else if((words[0] == "element") && (words.size() == 3))
+        {
+            PlyElement element;
+            element.name = std::string(words[1]);
+            const auto [ptr, ec] = std::from_chars(words[2].data(), words[2].data() + words[2].size(), element.count);
+            if((ec != std::errc()) || (ptr != words[2].data() + words[2].size()))
+            {
+                std::cerr << "Invalid PLY element count " << words[2] << std::endl;
+                return false;
+            }
+            header.elements.push_back(element);
+        }
+        else if((words[0] == "property") && !header.elements.empty())
+        {
+            PlyProperty property;
+            bool valid{false};
+            if((words.size() == 5) && (words[1] == "list"))
+            {
+                property.isList = true;
+                property.name = std::string(words[4]);
+                valid = parsePlyType(words[2], property.countType) && parsePlyType(words[3], property.type)
+                        && (property.countType != PlyType::float32) && (property.countType != PlyType::float64);
+            }
+            else if(words.size() == 3)
+            {
+                property.name = std::string(words[2]);
+                valid = parsePlyType(words[1], property.type);
+            }
+            if(!valid)
+            {
+                std::cerr << "Invalid PLY property " << (words.size() > 1 ? words.back() : words[0]) << std::endl;
+                return false;
+            }
+            header.elements.back().properties.push_back(property);
+        }
+        else if(words[0] == "end_header")
+        {
+            if(!formatFound)
+            {
+                std::cerr << "Missing PLY format" << std::endl;
+                return false;
+            }
+            header.size = offset;
+            return true;
+        }
+        else
+        {
+            std::cerr << "Invalid PLY header line " << words[0] << std::endl;
+            return false;
+        }
+    }
+    std::cerr << "Missing PLY end_header" << std::endl;
+    return false;
+}
+
+/**
+ * Return true if the machine is little endian
+ * @return true if the machine is little endian
+ */
+bool isLittleEndian()
+{
+    const std::uint16_t probe{1};
+    unsigned char bytes[sizeof(probe)];
+    std::memcpy(bytes, &probe, sizeof(probe));
+    return bytes[0] == 1;
+}
+
+/**
+ * Sequential reader of the values of the data section of a PLY file
+ */
+struct PlyCursor
+{
+    /// the current position
+    const char* pos{nullptr};
+    /// the end of the data
+    const char* end{nullptr};
+    /// true if the data is ascii
+    bool ascii{false};
+    /// true if the bytes of the binary values have to be reversed
+    bool swap{false};
+
+    /**
+     * Read a value
+     * @param[in] type the type of the value
+     * @param[out] value the value
+     * @return true if the value has been read, false if the data is truncated or invalid
+     */
+    bool read(PlyType type, double& value)
+    {
+        return ascii ? readAscii(type, value) : readBinary(type, value);
+    }
+
+    /**
+     * Skip a value
+     * @param[in] type the type of the value
+     * @return true if the value has been skipped, false if the data is truncated or invalid
+     */
+    bool skip(PlyType type)
+    {
+        if(ascii)
+        {
+            double discard{};
+            return readAscii(type, discard);
+        }
+        if(static_cast<std::size_t>(end - pos) < typeSize(type))
+            return false;
+        pos += typeSize(type);
+        return true;
+    }
+
+    /**
+     * Skip a property
+     * @param[in] property the property
+     * @return true if the property has been skipped, false if the data is truncated or invalid
+     */
+    bool skip(const PlyProperty& property)
+    {
+        if(!property.isList)
+            return skip(property.type);
+        double count{};
+        if(!read(property.countType, count))
+            return false;
+        for(std::size_t i = 0; i < static_cast<std::size_t>(count); ++i)
+        {
+            if(!skip(property.type))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Skip a whole record of an element
+     * @param[in] element the element
+     * @return true if the record has been skipped, false if the data is truncated or invalid
+     */
+    bool skip(const PlyElement& element)
+    {
+        return std::all_of(element.properties.begin(), element.properties.end(), [this](const PlyProperty& p) { return skip(p); });
+    }
+
+    /**
+     * Decode a binary value stored anywhere in the data, swapping its bytes if needed
+     * @param[in] bytes the first byte of the value
+     * @param[in] type the type of the value
+     * @return the value
+     */
+    [[nodiscard]] double decode(const char* bytes, PlyType type) const
+    {
+        char value[8];
+        const auto size = typeSize(type);
+        std::memcpy(value, bytes, size);
+        if(swap)
+            std::reverse(value, value + size);
+        return toDouble(value, type);
+    }
+
+private:
+    /**
+     * Read a binary value, swapping its bytes if needed
+     * @param[in] type the type of the value
+     * @param[out] value the value
+     * @return true if the value has been read
+     */
+    bool readBinary(PlyType type, double& value)
+    {
+        const auto size = typeSize(type);
+        if(static_cast<std::size_t>(end - pos) < size)
+            return false;
+        value = decode(pos, type);
+        pos += size;
+        return true;
+    }
+
+    /**
+     * Read an ascii value, using the same number syntax of the OBJ files
+     * @param[in] type the type of the value
+     * @param[out] value the value
+     * @return true if the value has been read
+     */
+    bool readAscii(PlyType type, double& value)
+    {
+        std::string_view s(pos, static_cast<std::size_t>(end - pos));
+        skipSpaces(s);
+        if((type == PlyType::float32) || (type == PlyType::float64))
+        {
+            float f{};
+            if(!parseFloat(s, f))
+                return false;
+            value = static_cast<double>(f);
+        }
+        else
+        {
+            long long i{};
+            const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), i);
+            if(ec != std::errc())
+                return false;
+            s.remove_prefix(static_cast<std::size_t>(ptr - s.data()));
+            value = static_cast<double>(i);
+        }
+        pos = s.data();
+        return true;
+    }
+
+    /**
+     * Convert the bytes of a value (in the machine byte order) to double
+     * @param[in] bytes the bytes
+     * @param[in] type the type of the value
+     * @return the value
+     */
+    static double toDouble(const char* bytes, PlyType type)
+    {
+        switch(type)
+        {
+            case PlyType::int8: return static_cast<double>(load<std::int8_t>(bytes));
+            case PlyType::uint8: return static_cast<double>(load<std::uint8_t>(bytes));
+            case PlyType::int16: return static_cast<double>(load<std::int16_t>(bytes));
+            case PlyType::uint16: return static_cast<double>(load<std::uint16_t>(bytes));
+            case PlyType::int32: return static_cast<double>(load<std::int32_t>(bytes));
+            case PlyType::uint32: return static_cast<double>(load<std::uint32_t>(bytes));
+            case PlyType::float32: return static_cast<double>(load<float>(bytes));
+            case PlyType::float64: return load<double>(bytes);
+        }
+        return 0;
+    }
+
+    /**
+     * Copy the bytes of a value into a variable of the given type
+     * @param[in] bytes the bytes
+     * @return the value
+     */
+    template <typename T>
+    static T load(const char* bytes)
+    {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * Read the vertex element of a PLY file: the position and, if requested, the normal and the
+ * texture coordinates of each vertex
+ * @param[in,out] cursor the reader, at the beginning of the element
+ * @param[in] element the vertex element
+ * @param[in] keepAttributes read also the normals and the texture coordinates
+ * @param[out] vertices the vertices
+ * @param[out] normals the normals, if present in the file
+ * @param[out] texcoords the texture coordinates, if present in the file
+ * @return true if everything went well, false otherwise
+ */
+bool readPlyVertices(PlyCursor& cursor,
+                     const PlyElement& element,
+                     bool keepAttributes,
+                     std::vector<point3d>& vertices,
+                     std::vector<vec3d>& normals,
+                     std::vector<texcoord>& texcoords)
+{
+    const auto numProperties = element.properties.size();
+    const std::size_t position[3] = {element.find("x"), element.find("y"), element.find("z")};
+    if((position[0] == numProperties) || (position[1] == numProperties) || (position[2] == numProperties))
+    {
+        std::cerr << "The PLY vertices have no x, y, z properties" << std::endl;
+        return false;
+    }
+
+    // the smallest size of a record (exactly its size for binary records without lists), so that
+    // a wrong count is detected before allocating the vertices: an ascii value takes at least a
+    // digit and a separator, a list at least its count
+    std::size_t recordSize{0};
+    for(const auto& p : element.properties)
+        recordSize += cursor.ascii ? 2 : typeSize(p.isList ? p.countType : p.type);
+    if(element.count > static_cast<std::size_t>(cursor.end - cursor.pos) / recordSize)
+    {
+        std::cerr << "The PLY file is too short for its " << element.count << " vertices" << std::endl;
+        return false;
+    }
+    vertices.resize(element.count);
+
+    // fast path: binary vertices made only of x, y, z floats in the byte order of the machine
+    // are stored exactly like the list of vertices
+    if(!cursor.ascii && !cursor.swap && (numProperties == 3) && (position[0] == 0) && (position[1] == 1) && (position[2] == 2)
+       && std::all_of(element.properties.begin(), element.properties.end(), [](const PlyProperty& p) { return !p.isList && (p.type == PlyType::float32); }))
+    {
+        const auto size = element.count * sizeof(point3d);
+        std::memcpy(vertices.data(), cursor.pos, size);
+        cursor.pos += size;
+        return true;
+    }
+
+    // the destination of each property: the 3 coordinates of the vertex, of the normal, of the
+    // texture coordinates, or nowhere
+    constexpr std::size_t none{9};
+    std::vector<std::size_t> target(numProperties, none);
+    for(std::size_t k = 0; k < 3; ++k)
+        target[position[k]] = k;
+
+    const std::size_t normal[3] = {element.find("nx"), element.find("ny"), element.find("nz")};
+    const bool hasNormals = keepAttributes && (normal[0] < numProperties) && (normal[1] < numProperties) && (normal[2] < numProperties);
+    std::size_t uv[2] = {element.find("u"), element.find("v")};
+    if((uv[0] == numProperties) || (uv[1] == numProperties))
+    {
+        uv[0] = element.find("s");
+        uv[1] = element.find("t");
+    }
+    if((uv[0] == numProperties) || (uv[1] == numProperties))
+    {
+        uv[0] = element.find("texture_u");
+        uv[1] = element.find("texture_v");
+    }
+    const bool hasTexcoords = keepAttributes && (uv[0] < numProperties) && (uv[1] < numProperties);
+    if(hasNormals)
+    {
+        normals.resize(element.count);
+        for(std::size_t k = 0; k < 3; ++k)
+            target[normal[k]] = 3 + k;
+    }
+    if(hasTexcoords)
+    {
+        texcoords.resize(element.count);
+        for(std::size_t k = 0; k < 2; ++k)
+            target[uv[k]] = 6 + k;
+    }
+
+    // where each value of a vertex goes
+    const auto destinations = [&](std::size_t i, float* (&destination)[9]) {
+        destination[0] = &vertices[i].x;
+        destination[1] = &vertices[i].y;
+        destination[2] = &vertices[i].z;
+        for(std::size_t k = 3; k < 9; ++k)
+            destination[k] = nullptr;
+        if(hasNormals)
+        {
+            destination[3] = &normals[i].x;
+            destination[4] = &normals[i].y;
+            destination[5] = &normals[i].z;
+        }
+        if(hasTexcoords)
+        {
+            destination[6] = &texcoords[i].x;
+            destination[7] = &texcoords[i].y;
+        }
+    };
+
+    // binary records of fixed size (e.g. x, y, z with the normals or the colors, in any type and
+    // byte order): the records are a block whose size has been checked above, each value is
+    // decoded in place from its offset in the record
+    if(!cursor.ascii && element.fixedSize())
+    {
+        std::vector<std::size_t> offset(numProperties, 0);
+        for(std::size_t p = 1; p < numProperties; ++p)
+            offset[p] = offset[p - 1] + typeSize(element.properties[p - 1].type);
+        const char* record = cursor.pos;
+        for(std::size_t i = 0; i < element.count; ++i, record += recordSize)
+        {
+            float* destination[9];
+            destinations(i, destination);
+            for(std::size_t p = 0; p < numProperties; ++p)
+            {
+                if(target[p] != none)
+                    *destination[target[p]] = static_cast<float>(cursor.decode(record + offset[p], element.properties[p].type));
+            }
+        }
+        cursor.pos = record;
+        return true;
+    }
+
+    for(std::size_t i = 0; i < element.count; ++i)
+    {
+        float* destination[9];
+        destinations(i, destination);
+        for(std::size_t p = 0; p < numProperties; ++p)
+        {
+            if(target[p] == none)
+            {
+                if(!cursor.skip(element.properties[p]))
+                    return false;
+                continue;
+            }
+            double value{};
+            if(!cursor.read(element.properties[p].type, value))
+                return false;
+            *destination[target[p]] = static_cast<float>(value);
+        }
+    }
+    return true;
+}
+
+/**
+ * Read the face element of a PLY file. The polygons are split in triangles as a fan around
+ * their first vertex.
+ * @param[in,out] cursor the reader, at the beginning of the element
+ * @param[in] element the face element
+ * @param[in] numVertices the number of vertices, to check the indices
+ * @param[out] mesh the faces
+ * @param[in,out] stats the number of reallocations is updated
+ * @return true if everything went well, false otherwise
+ */
+bool readPlyFaces(PlyCursor& cursor, const PlyElement& element, std::size_t numVertices, std::vector<face>& mesh, LoadStatistics& stats)
+{
+    auto indices = element.find("vertex_indices");
+    if(indices == element.properties.size())
+        indices = element.find("vertex_index");
+    if((indices == element.properties.size()) || !element.properties[indices].isList)
+    {
+        std::cerr << "The PLY faces have no vertex_indices property" << std::endl;
+        return false;
+    }
+    const auto& property = element.properties[indices];
+
+    mesh.reserve(element.count);
+    std::vector<idxtype> polygon;
+    const auto addPolygon = [&](std::size_t i) {
+        for(const auto v : polygon)
+        {
+            if(v >= numVertices)
+            {
+                std::cerr << "Invalid vertex index " << v << " in PLY face " << i << std::endl;
+                return false;
+            }
+        }
+        for(std::size_t k = 2; k < polygon.size(); ++k)
+        {
+            append(mesh, face(polygon[0], polygon[k - 1], polygon[k]), stats.reallocations);
+        }
+        return true;
+    };
+
+    // fast path: binary faces made only of the list of 32 bit indices in the byte order of the machine,
+    // the indices of each face are copied at once
+    if(!cursor.ascii && !cursor.swap && (element.properties.size() == 1) && (property.countType == PlyType::uint8)
+       && ((property.type == PlyType::int32) || (property.type == PlyType::uint32)))
+    {
+        static_assert(sizeof(idxtype) == sizeof(std::uint32_t), "the indices must be 32 bit");
+        for(std::size_t i = 0; i < element.count; ++i)
+        {
+            if(cursor.pos == cursor.end)
+                return false;
+            const auto count = static_cast<unsigned char>(*cursor.pos);
+            const auto size = count * sizeof(idxtype);
+            if(static_cast<std::size_t>(cursor.end - cursor.pos) < 1 + size)
+                return false;
+            polygon.resize(count);
+            std::memcpy(polygon.data(), cursor.pos + 1, size);
+            cursor.pos += 1 + size;
+            if(!addPolygon(i))
+                return false;
+        }
+        return true;
+    }
+
+    for(std::size_t i = 0; i < element.count; ++i)
+    {
+        for(std::size_t p = 0; p < element.properties.size(); ++p)
+        {
+            if(p != indices)
+            {
+                if(!cursor.skip(element.properties[p]))
+                    return false;
+                continue;
+            }
+            double count{};
+            if(!cursor.read(property.countType, count))
+                return false;
+            polygon.resize(static_cast<std::size_t>(count));
+            for(auto& v : polygon)
+            {
+                double value{};
+                if(!cursor.read(property.type, value))
+                    return false;
+                // a negative index becomes out of range
+                v = (value < 0) ? std::numeric_limits<idxtype>::max() : static_cast<idxtype>(value);
+            }
+            if(!addPolygon(i))
+                return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool isPlyFile(const std::string& filename)
+{
+    const auto extension = std::filesystem::path(filename).extension().string();
+    return (extension.size() == 4) && std::equal(extension.begin(), extension.end(), ".ply", [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+bool loadPly(const std::string& filename,
+             std::vector<point3d>& vertices,
+             std::vector<face>& mesh,
+             std::vector<vec3d>& normals,
+             std::vector<texcoord>& texcoords,
+             BoundingBox& bb,
+             LoadStatistics& stats,
+             const LoadParameters& params)
+{
+    const auto start = std::chrono::steady_clock::now( );
+    stats = LoadStatistics( );
+    vertices.clear( );
+    mesh.clear( );
+    normals.clear( );
+    texcoords.clear( );
+
+    MappedFile plyFile;
+    if ( !plyFile.open( filename, params.useMemoryMapping ) )
+    {
+        std::cerr << "Unable to open file " << filename << std::endl;
+        return false;
+    }
+
+    PlyHeader header;
+    if ( !parsePlyHeader( plyFile.view( ), header ) )
+    {
+        std::cerr << "Invalid PLY header in " << filename << std::endl;
+        return false;
+    }
+
+    PlyCursor cursor;
+    cursor.pos = plyFile.view( ).data( ) + header.size;
+    cursor.end = plyFile.view( ).data( ) + plyFile.view( ).size( );
+    cursor.ascii = ( header.format == PlyFormat::ascii );
+    cursor.swap = !cursor.ascii && ( ( header.format == PlyFormat::binaryLittleEndian ) != isLittleEndian( ) );
+
+    // read the elements in the order of the file, skipping the unknown ones
+    ParseProgress progress( params.progress, plyFile.size( ), params.cancel );
+    progress.advance( header.size );
+    bool verticesFound{false};
+    for ( const auto& element : header.elements )
+    {
+        if ( progress.cancelled( ) )
+        {
+            std::cerr << "The load of " << filename << " has been cancelled" << std::endl;
+            return false;
+        }
+        const auto* elementBegin = cursor.pos;
+        bool ok{true};
+        if ( element.name == "vertex" )
+        {
+            stats.vertexRecords = element.count;
+            ok = readPlyVertices( cursor, element, params.useFileAttributes, vertices, normals, texcoords );
+            verticesFound = true;
+        }
+        else if ( ( element.name == "face" ) && verticesFound )
+        {
+            stats.faceRecords = element.count;
+            ok = readPlyFaces( cursor, element, vertices.size( ), mesh, stats );
+        }
+        else
+        {
+            for ( std::size_t i = 0; ok && ( i < element.count ); ++i )
+            {
+                ok = cursor.skip( element );
+            }
+        }
+        if ( !ok )
+        {
+            std::cerr << "The PLY file " << filename << " is truncated or invalid (element " << element.name << ")" << std::endl;
+            return false;
+        }
+        progress.advance( static_cast<std::size_t>( cursor.pos - elementBegin ) );
+    }
+
+    for ( std::size_t i = 0; i < vertices.size( ); ++i )
+    {
+        if ( i == 0 )
+            bb.set( vertices[i] );
+        else
+            bb.add( vertices[i] );
+    }
+
+    const auto parseEnd = std::chrono::steady_clock::now( );
+    stats.parseSeconds = std::chrono::duration<double>( parseEnd - start ).count( );
+
+    // as for OBJ files, the normals of the file are used only if requested
+    stats.fileNormals = !normals.empty( );
+    if ( stats.fileNormals )
+    {
+        for ( auto& n : normals )
+        {
+            n.normalize( );
+        }
+    }
+    else
+    {
+        computeVertexNormals( vertices, mesh, normals, params.threads );
+    }
+    stats.normalsSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now( ) - parseEnd ).count( );
+
+    std::cerr << "Found :\n\tNumber of triangles (_indices) " << mesh.size( ) << "\n\tNumber of Vertices: " << vertices.size( ) << "\n\tNumber of Normals: " << normals.size( ) << ( stats.fileNormals ? " (from file)" : "" ) << "\n\tNumber of Texture coordinates: " << texcoords.size( ) << "\n\tParsing time: " << stats.parseSeconds << "s\n\tNormals time: " << stats.normalsSeconds << "s" << std::endl;
+
+    std::cout << "Object loaded with " << vertices.size( ) << " vertices and " << mesh.size( ) << " faces" << std::endl;
+    std::cout << "Bounding box : pmax=" << bb.pmax << "  pmin=" << bb.pmin << std::endl;
+    return true;
+}
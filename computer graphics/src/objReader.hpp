@@ -7,8 +7,11 @@
 #pragma once
 
 #include "core.hpp"
-#include <string>
+#include <atomic>
+#include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
 
 /**
  * A structure that model the bounding box
@@ -47,16 +50,128 @@ struct BoundingBox
     }
 };
 
+/**
+ * The parameters controlling how a model is loaded from file
+ */
+struct LoadParameters
+{
+    /// map the whole file in memory and parse it in place (falling back to a single buffered read
+    /// if mapping is not available) on/off; if off the file is read line by line
+    bool useMemoryMapping{true};
+    /// number of threads used to parse a memory mapped file, 0 means as many as the hardware threads
+    unsigned int threads{0};
+    /// use (and create when missing or out of date) the binary cache next to the model file on/off
+    bool useCache{true};
+    /// keep the normals and the texture coordinates of the file (vn and vt records, referenced by the
+    /// face corners) on/off; if on and every face references a normal, the normals are not recomputed
+    bool useFileAttributes{false};
+    /// merge the vertices closer than weldEpsilon (see weldVertices) after loading the model on/off
+    bool weld{false};
+    /// the maximum distance between welded vertices, relative to the diagonal of the bounding box
+    float weldEpsilon{1e-6f};
+    /// called while parsing with the number of bytes parsed so far and the size of the file, e.g. to
+    /// show the progress of a long load; it may be called concurrently by the parsing threads
+    std::function<void(std::size_t parsed, std::size_t total)> progress{};
+    /// if not null, the load stops as soon as it is set (it is checked between chunks of the file)
+    /// and fails, leaving the lists in an unspecified state
+    const std::atomic<bool>* cancel{nullptr};
+
+    LoadParameters() = default;
+};
+
+/**
+ * Some statistics about the loading of a model
+ */
+struct LoadStatistics
+{
+    /// number of vertex records found in the file before parsing it (only for memory mapped files)
+    std::size_t vertexRecords{0};
+    /// number of normal records found in the file before parsing it (only for memory mapped files)
+    std::size_t normalRecords{0};
+    /// number of texture coordinate records found in the file before parsing it (only for memory mapped files)
+    std::size_t texcoordRecords{0};
+    /// number of face records found in the file before parsing it (only for memory mapped files)
+    std::size_t faceRecords{0};
+    /// number of times a non-empty list (of vertices, faces, normals) had to grow, ie its content was moved
+    std::size_t reallocations{0};
+    /// time spent reading and parsing the file, in seconds
+    double parseSeconds{0};
+    /// time spent computing the normals, in seconds
+    double normalsSeconds{0};
+    /// true if the normals have been taken from the file instead of being computed
+    bool fileNormals{false};
+
+    LoadStatistics() = default;
+};
+
 /**
  * Load the OBJ data from file
  * @param[in] filename The name of the OBJ file to load
  * @param[out] vertices The list of vertices
  * @param[out] mesh The list of faces
  * @param[out] normals The list of normals
+ * @param[out] texcoords The list of texture coordinates, empty unless they are taken from the file
+ * @param[out] bb The bounding box of the object
+ * @param[out] stats The loading statistics
+ * @param[in] params The loading parameters
+ * @return true if everything went well, false otherwise
+ */
+bool load(const std::string& filename,
+          std::vector<point3d>& vertices,
+          std::vector<face>& mesh,
+          std::vector<vec3d>& normals,
+          std::vector<texcoord>& texcoords,
+          BoundingBox& bb,
+          LoadStatistics& stats,
+          const LoadParameters& params = LoadParameters());
+
+/**
+ * Load the OBJ data from file
+ * @param[in] filename The name of the OBJ file to load
+ * @param[out] vertices The list of vertices
+ * @param[out] mesh The list of faces
+ * @param[out] normals The list of normals
+ * @param[out] bb The bounding box of the object
+ * @param[in] params The loading parameters
+ * @return true if everything went well, false otherwise
+ */
+bool load(const std::string& filename,
+          std::vector<point3d>& vertices,
+          std::vector<face>& mesh,
+          std::vector<vec3d>& normals,
+          BoundingBox& bb,
+          const LoadParameters& params = LoadParameters());
+
+/**
+ * Return true if the file is a PLY file, according to its extension (case insensitive)
+ * @param[in] filename The name of the file
+ * @return true if the extension is .ply
+ */
+bool isPlyFile(const std::string& filename);
+
+/**
+ * Load the PLY data from file, either ascii or binary (little or big endian). The elements
+ * other than vertex and face are skipped, and the polygons are split in triangles. The
+ * normals (nx, ny, nz) and the texture coordinates (u, v or s, t) of the vertices are kept
+ * only if params.useFileAttributes is on, otherwise the normals are computed.
+ * @param[in] filename The name of the PLY file to load
+ * @param[out] vertices The list of vertices
+ * @param[out] mesh The list of faces
+ * @param[out] normals The list of normals
+ * @param[out] texcoords The list of texture coordinates, empty unless they are taken from the file
  * @param[out] bb The bounding box of the object
+ * @param[out] stats The loading statistics
+ * @param[in] params The loading parameters
  * @return true if everything went well, false otherwise
  */
-bool load(const std::string& filename, std::vector<point3d>& vertices, std::vector<face>& mesh, std::vector<vec3d>& normals, BoundingBox& bb);
+bool loadPly(const std::string& filename,
+             std::vector<point3d>& vertices,
+             std::vector<face>& mesh,
+             std::vector<vec3d>& normals,
+             std::vector<texcoord>& texcoords,
+             BoundingBox& bb,
+             LoadStatistics& stats,
+             const LoadParameters& params = LoadParameters());
 
 
 
@@ -65,28 +180,109 @@ bool load(const std::string& filename, std::vector<point3d>& vertices, std::vect
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
+/**
+ * The indices of the corners of a face
+ */
+struct FaceCorners
+{
+    /// the vertex indices
+    face vertices{};
+    /// the texture coordinate indices, if any
+    face texcoords{};
+    /// the normal indices, if any
+    face normals{};
+    /// true if the face has texture coordinate indices (v/t and v/t/n formats)
+    bool hasTexcoords{false};
+    /// true if the face has normal indices (v//n and v/t/n formats)
+    bool hasNormals{false};
+
+    FaceCorners() = default;
+};
+
 /**
  * It parses a line of the OBJ file containing a face and it return the result.
- * NB: it only recovers the indices, it discards normal and texture indices
+ * NB: it only recovers the indices, it discards normal and texture indices (see parseFaceCorners)
  *
  * @param[in] toParse the string to parse in the OBJ format for a face (f v/vt/vn v/vt/vn v/vt/vn) and its variants
  * @return the 3 indices for the face
+ * @throw std::invalid_argument if the string is not a valid face
  */
-face parseFaceString(const std::string &toParse);
+face parseFaceString(std::string_view toParse);
 
-std::optional<face> parseFaceStringRegex( const std::string &toParse);
+/**
+ * It parses a line of the OBJ file containing a face, supporting the formats f v v v,
+ * f v/t v/t v/t, f v/t/n v/t/n v/t/n and f v//n v//n v//n.
+ *
+ * @param[in] toParse the string to parse
+ * @return the 3 indices for the face or an empty optional if the string is not a valid face
+ */
+std::optional<face> tryParseFaceString(std::string_view toParse);
+
+/**
+ * It parses a line of the OBJ file containing a face and it return all the indices of its corners.
+ *
+ * @param[in] toParse the string to parse in the OBJ format for a face (f v/vt/vn v/vt/vn v/vt/vn) and its variants
+ * @return the vertex, texture coordinate and normal indices of the face
+ * @throw std::invalid_argument if the string is not a valid face
+ */
+FaceCorners parseFaceCorners(std::string_view toParse);
+
+/**
+ * It parses a line of the OBJ file containing a face, keeping the texture coordinate and the normal
+ * indices of each corner (if present). The same formats of tryParseFaceString are supported.
+ *
+ * @param[in] toParse the string to parse
+ * @return the indices of the face or an empty optional if the string is not a valid face
+ */
+std::optional<FaceCorners> tryParseFaceCorners(std::string_view toParse);
 
 /**
  * It parses a line of the OBJ file containing a vertex and it return the result.
  *
  * @param[in] toParse the string to parse in the OBJ format for a vertex (v x y z)
  * @return the 3 coordinates of the vertex
+ * @throw std::invalid_argument if the string is not a valid vertex
  */
-point3d parseVertexString(const std::string &toParse);
-
-std::optional<point3d> parseVertexStringRegex(const std::string &toParse);
+point3d parseVertexString(std::string_view toParse);
 
+/**
+ * It parses a line of the OBJ file containing a vertex (v x y z).
+ *
+ * @param[in] toParse the string to parse
+ * @return the 3 coordinates of the vertex or an empty optional if the string is not a valid vertex
+ */
+std::optional<point3d> tryParseVertexString(std::string_view toParse);
 
+/**
+ * It parses a line of the OBJ file containing a normal and it return the result.
+ *
+ * @param[in] toParse the string to parse in the OBJ format for a normal (vn x y z)
+ * @return the 3 coordinates of the normal
+ * @throw std::invalid_argument if the string is not a valid normal
+ */
+vec3d parseNormalString(std::string_view toParse);
 
+/**
+ * It parses a line of the OBJ file containing a normal (vn x y z).
+ *
+ * @param[in] toParse the string to parse
+ * @return the 3 coordinates of the normal or an empty optional if the string is not a valid normal
+ */
+std::optional<vec3d> tryParseNormalString(std::string_view toParse);
 
+/**
+ * It parses a line of the OBJ file containing a texture coordinate and it return the result.
+ *
+ * @param[in] toParse the string to parse in the OBJ format for a texture coordinate (vt u [v [w]])
+ * @return the texture coordinates, the missing ones are 0
+ * @throw std::invalid_argument if the string is not a valid texture coordinate
+ */
+texcoord parseTexcoordString(std::string_view toParse);
 
+/**
+ * It parses a line of the OBJ file containing a texture coordinate (vt u [v [w]]).
+ *
+ * @param[in] toParse the string to parse
+ * @return the texture coordinates or an empty optional if the string is not a valid texture coordinate
+ */
+std::optional<texcoord> tryParseTexcoordString(std::string_view toParse);
@@ -16,6 +16,13 @@
 #ifdef _WIN32
 #include <windows.h>
 #endif
+// the prototypes of the functions beyond OpenGL 1.1 (e.g. the buffer objects), windows only
+// provides the OpenGL 1.1 ones and the others have to be loaded at runtime
+#ifndef _WIN32
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#endif
 // for windows and linux
 #include <GL/gl.h>
 #include <GL/glu.h>
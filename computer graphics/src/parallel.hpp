@@ -0,0 +1,105 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/**
+ * Return the number of threads to use
+ * @param[in] requested the requested number of threads, 0 means as many as the hardware threads
+ * @return the number of threads to use, at least 1
+ */
+inline unsigned int threadCount(unsigned int requested = 0)
+{
+    if(requested > 0)
+    {
+        return requested;
+    }
+    const auto hw = std::thread::hardware_concurrency();
+    return (hw > 0) ? hw : 1;
+}
+
+/**
+ * Split the range [0, size) in numChunks contiguous chunks of (almost) the same size and call
+ * fn(chunk, begin, end) for each of them, each chunk in its own thread. The calling thread
+ * processes the first chunk. If any call throws, the first exception is rethrown once all the
+ * threads have finished.
+ *
+ * @param[in] size the size of the range
+ * @param[in] numChunks the number of chunks (and threads)
+ * @param[in] fn the function to call for each chunk
+ */
+template <typename Function>
+void parallelChunks(std::size_t size, unsigned int numChunks, Function&& fn)
+{
+    numChunks = std::max(1u, numChunks);
+    const auto chunkBegin = [&](std::size_t chunk) { return (size * chunk) / numChunks; };
+
+    if(numChunks == 1)
+    {
+        fn(std::size_t{0}, std::size_t{0}, size);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(numChunks);
+    std::vector<std::thread> workers;
+    workers.reserve(numChunks - 1);
+
+    const auto run = [&](std::size_t chunk) {
+        try
+        {
+            fn(chunk, chunkBegin(chunk), chunkBegin(chunk + 1));
+        }
+        catch(...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    for(std::size_t chunk = 1; chunk < numChunks; ++chunk)
+    {
+        workers.emplace_back(run, chunk);
+    }
+    run(0);
+    for(auto& w : workers)
+    {
+        w.join();
+    }
+    for(const auto& e : errors)
+    {
+        if(e)
+        {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+/**
+ * Call fn(i) for each i in [0, size) using several threads. Small ranges are processed
+ * on the calling thread only.
+ *
+ * @param[in] size the size of the range
+ * @param[in] fn the function to call for each element
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @param[in] grain the minimum number of elements processed by each thread
+ */
+template <typename Function>
+void parallelFor(std::size_t size, Function&& fn, unsigned int threads = 0, std::size_t grain = 4096)
+{
+    const auto maxChunks = std::max<std::size_t>(1, size / std::max<std::size_t>(1, grain));
+    const auto numChunks = static_cast<unsigned int>(std::min<std::size_t>(threadCount(threads), maxChunks));
+    parallelChunks(size, numChunks, [&fn](std::size_t, std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; ++i)
+        {
+            fn(i);
+        }
+    });
+}
@@ -6,17 +6,17 @@
 
 #include "rendering.hpp"
 #include "geometry.hpp"
+#include "MeshBuffers.hpp"
+
+namespace
+{
 
 /**
- * Draw the wireframe of the model
- *
- * @param vertices The list of vertices
- * @param mesh The mesh as a list of faces, each face is a tripleIndex of vertex indices
- * @param params The rendering parameters
+ * Set the color and the width of the lines of the wireframe and disable the lighting, which has
+ * to be enabled again once the wireframe is drawn
+ * @param[in] params The rendering parameters
  */
-void drawWireframe(const std::vector<point3d>& vertices,
-                   const std::vector<face>& mesh,
-                   const RenderingParameters& params)
+void beginWireframe(const RenderingParameters& params)
 {
     //**************************************************
     // we first need to disable the lighting in order to
@@ -37,6 +37,34 @@ void drawWireframe(const std::vector<point3d>& vertices,
         glColor3f( .8f, .8f, .8f );
         glLineWidth( .21f );
     }
+}
+
+/**
+ * Set the color and the width of the normals and disable the lighting, which has to be enabled
+ * again once the normals are drawn
+ */
+void beginNormals()
+{
+    glDisable(GL_LIGHTING);
+
+    glColor3f(.8f, .0f, .0f);
+    glLineWidth(2);
+}
+
+}  // namespace
+
+/**
+ * Draw the wireframe of the model
+ *
+ * @param vertices The list of vertices
+ * @param mesh The mesh as a list of faces, each face is a tripleIndex of vertex indices
+ * @param params The rendering parameters
+ */
+void drawWireframe(const std::vector<point3d>& vertices,
+                   const std::vector<face>& mesh,
+                   const RenderingParameters& params)
+{
+    beginWireframe(params);
 
     //**************************************************
     // for each face of the mesh...
@@ -67,17 +95,22 @@ void drawWireframe(const std::vector<point3d>& vertices,
  * @param[in] mesh The list of face, each face containing the indices of the vertices
  * @param[in] vertexNormals The list of normals associated to each vertex
  * @param[in] params If smooth is true, the model is drawn with smooth shading, otherwise with flat shading
+ * @param[in] faceNormals The list of normals associated to each face, for flat shading; if empty they are computed
  */
 void drawFaces(const std::vector<point3d>& vertices,
                    const std::vector<face>& mesh,
                    const std::vector<vec3d>& vertexNormals,
-                   const RenderingParameters& params)
+                   const RenderingParameters& params,
+                   const std::vector<vec3d>& faceNormals)
 {
     // shading model to use
     if(!params.smooth)
     {
         glShadeModel(GL_FLAT);
 
+        // the normals of the faces, unless they are provided
+        const bool cached = (faceNormals.size() == mesh.size());
+
         //**************************************************
         // for each face
         //**************************************************
@@ -91,7 +124,7 @@ void drawFaces(const std::vector<point3d>& vertices,
             auto v1 = vertices[f.v1];
             auto v2 = vertices[f.v2];
             auto v3 = vertices[f.v3];
-            auto norm = computeNormal((point3d)v1, (point3d)v2, (point3d)v3);
+            auto norm = cached ? faceNormals[i] : computeNormal((point3d)v1, (point3d)v2, (point3d)v3);
             glBegin(GL_TRIANGLES);
                 glNormal3fv((float*)&norm);
                 glVertex3fv((float*)&v1);
@@ -200,32 +233,37 @@ void drawArrayFaces(const std::vector<point3d>& vertices,
 
 void drawNormals(const std::vector<point3d>& vertices, const std::vector<vec3d>& vertexNormals)
 {
-    glDisable(GL_LIGHTING);
-
-    glColor3f(.8f, .0f, .0f);
-    glLineWidth(2);
+    std::vector<point3d> lines;
+    computeNormalLines(vertices, vertexNormals, RenderingParameters().normalLength, 1, lines);
+    drawNormalLines(lines);
+}
 
-    for(std::size_t i = 0; i < vertices.size(); ++i)
+void drawNormalLines(const std::vector<point3d>& lines)
+{
+    if(lines.empty())
     {
-        glBegin(GL_LINES);
-
-        const auto v = vertices[i];
-        const auto n = vertexNormals[i];
-
-        vec3d newP = v + 0.05f * n;
-        glVertex3fv((float*)&v);
-
-        glVertex3f(newP.x, newP.y, newP.z);
-
-        glEnd();
+        return;
     }
+    beginNormals();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(COORD_PER_VERTEX, GL_FLOAT, 0, lines.data());
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lines.size()));
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_LIGHTING);
+}
+
+void drawNormalLines(const MeshBuffers& buffers)
+{
+    beginNormals();
+    buffers.drawNormalLines();
     glEnable(GL_LIGHTING);
 }
 
 void drawSolid(const std::vector<point3d>& vertices,
                const std::vector<face>& indices,
-               std::vector<vec3d>& vertexNormals,
-               const RenderingParameters& params)
+               const std::vector<vec3d>& vertexNormals,
+               const RenderingParameters& params,
+               const std::vector<vec3d>& faceNormals)
 {
     if(params.useIndexRendering)
     {
@@ -233,7 +271,7 @@ void drawSolid(const std::vector<point3d>& vertices,
     }
     else
     {
-        drawFaces(vertices, indices, vertexNormals, params);
+        drawFaces(vertices, indices, vertexNormals, params, faceNormals);
     }
 }
 
@@ -244,15 +282,63 @@ void drawSolid(const std::vector<point3d>& vertices,
  * @param indices list of faces
  * @param vertexNormals list of normals
  * @param params Rendering parameters
+ * @param faceNormals list of normals of the faces, for flat shading; if empty they are computed
  */
-void draw( const std::vector<point3d> &vertices, const std::vector<face> &indices, std::vector<vec3d> &vertexNormals, const RenderingParameters &params )
+void draw( const std::vector<point3d> &vertices,
+           const std::vector<face> &indices,
+           const std::vector<vec3d> &vertexNormals,
+           const RenderingParameters &params,
+           const std::vector<vec3d> &faceNormals )
 {
     if ( params.solid )
     {
-        drawSolid( vertices, indices, vertexNormals, params );
+        drawSolid( vertices, indices, vertexNormals, params, faceNormals );
     }
     if ( params.wireframe )
     {
         ::drawWireframe( vertices, indices, params );
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Draw the model stored in buffer objects
+ *
+ * @param buffers the buffers containing the model
+ * @param vertices list of vertices
+ * @param indices list of faces
+ * @param vertexNormals list of normals
+ * @param params Rendering parameters
+ * @param faceNormals list of normals of the faces, for flat shading; if empty they are computed
+ */
+void draw( const MeshBuffers &buffers,
+           const std::vector<point3d> &vertices,
+           const std::vector<face> &indices,
+           const std::vector<vec3d> &vertexNormals,
+           const RenderingParameters &params,
+           const std::vector<vec3d> &faceNormals )
+{
+    if ( params.solid )
+    {
+        if ( params.smooth )
+        {
+            glShadeModel( GL_SMOOTH );
+            buffers.drawTriangles( );
+        }
+        else if ( buffers.hasFlatTriangles( ) )
+        {
+            glShadeModel( GL_FLAT );
+            buffers.drawFlatTriangles( );
+        }
+        else
+        {
+            // the flat shaded triangles have not been uploaded
+            drawSolid( vertices, indices, vertexNormals, params, faceNormals );
+        }
+    }
+    if ( params.wireframe )
+    {
+        beginWireframe( params );
+        buffers.drawEdges( );
+        glEnable( GL_LIGHTING );
+    }
+}
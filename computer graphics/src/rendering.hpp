@@ -8,8 +8,12 @@
 
 #include "core.hpp"
 #include "openglAll.hpp"
+#include "RenderingParameters.hpp"
+#include <cstddef>
 #include <vector>
 
+class MeshBuffers;
+
 /// number of vertices in a triangle
 constexpr GLsizei VERTICES_PER_TRIANGLE{3};
 /// number of coordinates per vertex
@@ -17,25 +21,8 @@ constexpr GLsizei COORD_PER_VERTEX{3};
 /// total number of floats in a triangle
 constexpr GLsizei TOTAL_FLOATS_IN_TRIANGLE { (VERTICES_PER_TRIANGLE * COORD_PER_VERTEX) };
 
-struct RenderingParameters
-{
-    /// wireframe on/off
-    bool wireframe{true};
-    /// draw the mesh on/off
-    bool solid { true };
-    /// use opengl drawElements on/off
-    bool useIndexRendering{false};
-    /// subdivision on/off
-    bool subdivision{false};
-    /// GL_SMOOTH on/off
-    bool smooth{false};
-    /// show normals on/off
-    bool normals{false};
-    /// number of subdivision level
-    unsigned short subdivLevel{1};
-
-    RenderingParameters() = default;
-};
+// the faces are given to OpenGL as they are, with GL_UNSIGNED_INT indices
+static_assert(sizeof(idxtype) == sizeof(GLuint), "the indices of the vertices must be GLuint");
 
 /**
 * Draw the wireframe of the model
@@ -65,11 +52,13 @@ void drawArrayFaces(const std::vector<point3d> &vertices,
  * @param[in] mesh The list of face, each face containing the indices of the vertices
  * @param[in] vertexNormals The list of normals associated to each vertex
  * @param[in] params If smooth is true, the model is drawn with smooth shading, otherwise with flat shading
+ * @param[in] faceNormals The list of normals associated to each face, for flat shading; if empty they are computed
  */
 void drawFaces(const std::vector<point3d>& vertices,
                    const std::vector<face>& mesh,
                    const std::vector<vec3d>& vertexNormals,
-                   const RenderingParameters& params);
+                   const RenderingParameters& params,
+                   const std::vector<vec3d>& faceNormals = std::vector<vec3d>());
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -80,8 +69,24 @@ void drawFaces(const std::vector<point3d>& vertices,
 */
 void drawNormals(const std::vector<point3d> &vertices, const std::vector<vec3d>& vertexNormals);
 
+/**
+* Draw the normals as segments computed beforehand, with a single call
+* @param[in] lines The two extremities of each segment, see computeNormalLines()
+*/
+void drawNormalLines(const std::vector<point3d> &lines);
+
+/**
+* Draw the normals as segments stored in buffer objects
+* @param[in] buffers The buffers containing the segments
+*/
+void drawNormalLines(const MeshBuffers &buffers);
 
-void drawSolid(const std::vector<point3d> &vertices, const std::vector<face> &indices, std::vector<vec3d> &vertexNormals, const RenderingParameters &params);
+
+void drawSolid(const std::vector<point3d> &vertices,
+               const std::vector<face> &indices,
+               const std::vector<vec3d> &vertexNormals,
+               const RenderingParameters &params,
+               const std::vector<vec3d> &faceNormals = std::vector<vec3d>());
 
 /**
 * Draw the model
@@ -90,5 +95,28 @@ void drawSolid(const std::vector<point3d> &vertices, const std::vector<face> &in
 * @param[in] indices list of faces
 * @param[in] vertexNormals list of normals
 * @param[in] params Rendering parameters
+* @param[in] faceNormals list of normals of the faces, for flat shading; if empty they are computed
+*/
+void draw(const std::vector<point3d> &vertices,
+          const std::vector<face> &indices,
+          const std::vector<vec3d> &vertexNormals,
+          const RenderingParameters &params,
+          const std::vector<vec3d> &faceNormals = std::vector<vec3d>());
+
+/**
+* Draw the model stored in buffer objects, with flat shading the faces are drawn from the lists
+* unless the buffers contain the flat shaded triangles
+*
+* @param[in] buffers the buffers containing the model
+* @param[in] vertices list of vertices
+* @param[in] indices list of faces
+* @param[in] vertexNormals list of normals
+* @param[in] params Rendering parameters
+* @param[in] faceNormals list of normals of the faces, for flat shading; if empty they are computed
 */
-void draw(const std::vector<point3d> &vertices, const std::vector<face> &indices, std::vector<vec3d> &vertexNormals, const RenderingParameters &params);
\ No newline at end of file
+void draw(const MeshBuffers &buffers,
+          const std::vector<point3d> &vertices,
+          const std::vector<face> &indices,
+          const std::vector<vec3d> &vertexNormals,
+          const RenderingParameters &params,
+          const std::vector<vec3d> &faceNormals = std::vector<vec3d>());
\ No newline at end of file
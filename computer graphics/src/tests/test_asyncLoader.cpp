@@ -0,0 +1,126 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <AsyncLoader.hpp>
+#include <MeshModel.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Poll the loader until the last requested load is complete
+ * @param[in,out] loader the loader
+ * @param[out] model the model replaced by the loaded one
+ * @return true if the model has been replaced
+ */
+bool waitAndTake(AsyncLoader& loader, MeshModel& model)
+{
+    while(loader.loading())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return loader.take(model);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_asyncLoader)
+
+BOOST_AUTO_TEST_CASE(test_async_load)
+{
+    const auto filename = (fs::temp_directory_path() / "test_async_load.obj").string();
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nf 1 3 2\nf 1 2 4\nf 2 3 4\nf 3 1 4\n";
+    }
+    LoadParameters params;
+    params.useCache = false;
+
+    AsyncLoader loader;
+    MeshModel model;
+    BOOST_CHECK(!loader.loading());
+    BOOST_CHECK(!loader.take(model));
+
+    loader.load(filename, params);
+    BOOST_CHECK(waitAndTake(loader, model));
+    // nothing else to take
+    BOOST_CHECK(!loader.take(model));
+
+    // the progress of a completed load
+    loader.load(filename, params);
+    while(loader.loading())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto progress = loader.progress();
+    BOOST_CHECK_EQUAL(progress.filename, filename);
+    BOOST_CHECK_EQUAL(progress.total, fs::file_size(filename));
+    BOOST_CHECK_EQUAL(progress.parsed, progress.total);
+
+    // a newer request makes the previous one stale
+    loader.load("this/file/does/not/exist.obj", params);
+    loader.load(filename, params);
+    BOOST_CHECK(waitAndTake(loader, model));
+
+    // a failed load
+    loader.load("this/file/does/not/exist.obj", params);
+    BOOST_CHECK(!waitAndTake(loader, model));
+    BOOST_CHECK(!loader.loading());
+
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_async_cancel)
+{
+    // a file large enough to be parsed in several chunks
+    const auto large = (fs::temp_directory_path() / "test_async_cancel.obj").string();
+    {
+        std::ofstream out(large, std::ios::binary | std::ios::trunc);
+        for(int i = 0; i < 400000; ++i)
+        {
+            out << "v " << i << " 0.5 0.25\n";
+        }
+        out << "f 1 2 3\n";
+    }
+    const auto small = (fs::temp_directory_path() / "test_async_cancel_small.obj").string();
+    {
+        std::ofstream out(small, std::ios::binary | std::ios::trunc);
+        out << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    }
+    LoadParameters params;
+    params.useCache = false;
+    params.useMemoryMapping = false;
+
+    MeshModel model;
+    {
+        // the stale load is cancelled, the last one completes
+        AsyncLoader loader;
+        loader.load(large, params);
+        loader.load(small, params);
+        BOOST_CHECK(waitAndTake(loader, model));
+
+        // the loads still running are cancelled by the destructor, which does not wait for them to complete
+        loader.load(large, params);
+    }
+
+    fs::remove(large);
+    fs::remove(small);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -121,4 +121,134 @@ BOOST_AUTO_TEST_CASE(test_edge_list)
     }
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE(test_flat_edge_table)
+{
+    BOOST_CHECK_EQUAL(edgeKey(edge(3, 7)), edgeKey(edge(7, 3)));
+    BOOST_CHECK_NE(edgeKey(edge(3, 7)), edgeKey(edge(3, 8)));
+    BOOST_CHECK_EQUAL(edgeHash()(edge(3, 7)), edgeHash()(edge(7, 3)));
+
+    // start small so that the table has to grow several times
+    FlatEdgeTable<idxtype> table;
+    const idxtype n{2000};
+    for(idxtype i = 0; i < n; ++i)
+    {
+        const auto [value, inserted] = table.findOrInsert(edge(i, i + 1), i);
+        BOOST_CHECK(inserted);
+        BOOST_CHECK_EQUAL(*value, i);
+    }
+    BOOST_CHECK_EQUAL(table.size(), n);
+    for(idxtype i = 0; i < n; ++i)
+    {
+        // the edge is found in both orders, and it keeps its first value
+        const auto [value, inserted] = table.findOrInsert(edge(i + 1, i), n + i);
+        BOOST_CHECK(!inserted);
+        BOOST_CHECK_EQUAL(*value, i);
+        BOOST_REQUIRE(table.find(edge(i, i + 1)) != nullptr);
+        BOOST_CHECK_EQUAL(*table.find(edge(i, i + 1)), i);
+    }
+    BOOST_CHECK(table.find(edge(0, 2)) == nullptr);
+
+    std::size_t count{0};
+    table.forEach([&count](const edge& e, idxtype value) {
+        BOOST_CHECK_EQUAL(e.first, value);
+        ++count;
+    });
+    BOOST_CHECK_EQUAL(count, n);
+
+    table.clear();
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    BOOST_CHECK(table.find(edge(0, 1)) == nullptr);
+
+    EdgeList list;
+    list.reserve(4);
+    BOOST_CHECK(list.findOrInsert(edge(1, 2), 10).second);
+    BOOST_CHECK_EQUAL(list.findOrInsert(edge(2, 1), 11).first, 10);
+    BOOST_CHECK_EQUAL(list.getIndex(edge(2, 1)), 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_vertex_corners)
+{
+    const std::vector<face> mesh{{0, 1, 2}, {2, 1, 3}, {3, 4, 2}};
+    VertexCorners vc;
+    vc.build(6, mesh);
+    BOOST_REQUIRE_EQUAL(vc.offsets.size(), 7);
+    BOOST_REQUIRE_EQUAL(vc.corners.size(), 9);
+
+    const std::vector<std::vector<std::size_t>> expected{{0}, {1, 4}, {2, 3, 8}, {5, 6}, {7}, {}};
+    for(std::size_t v = 0; v < expected.size(); ++v)
+    {
+        const std::vector<std::size_t> corners(vc.corners.begin() + static_cast<std::ptrdiff_t>(vc.offsets[v]),
+                                               vc.corners.begin() + static_cast<std::ptrdiff_t>(vc.offsets[v + 1]));
+        BOOST_CHECK(corners == expected[v]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_edge_adjacency)
+{
+    // a strip of two triangles, a fan of three triangles sharing the edge (4, 5) and a degenerate face
+    const std::vector<face> mesh{{0, 1, 2}, {2, 1, 3}, {4, 5, 6}, {5, 4, 7}, {4, 5, 8}, {9, 9, 10}};
+    VertexCorners corners;
+    corners.build(11, mesh);
+    EdgeAdjacency adjacency;
+    adjacency.build(mesh, corners, 100, 1);
+    BOOST_CHECK_EQUAL(adjacency.numEdges, 5 + 7 + 2);
+    BOOST_REQUIRE_EQUAL(adjacency.index.size(), 3 * mesh.size());
+
+    // the edges are numbered in the order of their first half-edge, from the first index
+    const std::vector<idxtype> first{0, 1, 2, 1, 4, 5, 6, 7, 8, 6, 10, 11, 6, 13, 14, 15, 16, 16};
+    const std::vector<idxtype> index{100, 101, 102, 101, 103, 104, 105, 106, 107, 105, 108, 109, 105, 110, 111, 112, 113, 113};
+    for(idxtype h = 0; h < first.size(); ++h)
+    {
+        BOOST_CHECK_EQUAL(adjacency.first[h], first[h]);
+        BOOST_CHECK_EQUAL(adjacency.index[h], index[h]);
+    }
+
+    // the edge (1, 2) is shared by the first two faces, the first and the second faces sharing the edge (4, 5) are kept
+    BOOST_CHECK(!adjacency.isBoundary(1));
+    BOOST_CHECK_EQUAL(adjacency.second[1], 3);
+    BOOST_CHECK_EQUAL(adjacency.second[3], 3);
+    BOOST_CHECK(adjacency.isBoundary(0));
+    BOOST_CHECK(adjacency.isBoundary(4));
+    BOOST_CHECK_EQUAL(adjacency.second[6], 9);
+    BOOST_CHECK_EQUAL(adjacency.second[12], 9);
+    // the two half-edges between 9 and 10 are in the same face
+    BOOST_CHECK(adjacency.isBoundary(16));
+
+    // the same numbering whatever the number of threads
+    std::vector<face> grid;
+    const idxtype n{100};
+    for(idxtype i = 0; i + 1 < n; ++i)
+    {
+        for(idxtype j = 0; j + 1 < n; ++j)
+        {
+            const auto v = i * n + j;
+            grid.emplace_back(v, v + n, v + 1);
+            grid.emplace_back(v + 1, v + n, v + n + 1);
+        }
+    }
+    corners.build(n * n, grid);
+    adjacency.build(grid, corners, 0, 1);
+    EdgeAdjacency parallel;
+    parallel.build(grid, corners, 0, 4);
+    BOOST_CHECK_EQUAL(parallel.numEdges, n * n + grid.size() - 1);
+    BOOST_CHECK(parallel.index == adjacency.index);
+    BOOST_CHECK(parallel.second == adjacency.second);
+
+    // an open fan around the vertex 0, whose valence is the number of faces
+    std::vector<face> fan;
+    const idxtype numFan{100000};
+    for(idxtype i = 1; i <= numFan; ++i)
+    {
+        fan.emplace_back(0, i, i + 1);
+    }
+    corners.build(numFan + 2, fan);
+    adjacency.build(fan, corners, 0, 4);
+    BOOST_CHECK_EQUAL(adjacency.numEdges, 2 * std::size_t{numFan} + 1);
+    // the edge (0, 2) is shared by the first two faces
+    BOOST_CHECK_EQUAL(adjacency.first[3], 2);
+    BOOST_CHECK_EQUAL(adjacency.second[2], 3);
+    BOOST_CHECK(adjacency.isBoundary(0));
+    BOOST_CHECK(adjacency.isBoundary(3 * (numFan - 1) + 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -11,11 +11,29 @@
 #include <boost/test/unit_test.hpp>
 #include <geometry.hpp>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <optional>
 #include <cmath>
+#include <vector>
 
+namespace
+{
+
+/**
+ * Check that two points are exactly the same
+ * @param[in] p the point
+ * @param[in] expected the expected point
+ */
+void checkSamePoint(const point3d& p, const point3d& expected)
+{
+    BOOST_CHECK_EQUAL(p.x, expected.x);
+    BOOST_CHECK_EQUAL(p.y, expected.y);
+    BOOST_CHECK_EQUAL(p.z, expected.z);
+}
+
+}  // namespace
 
 BOOST_AUTO_TEST_SUITE(test_geometry)
 
@@ -45,5 +63,130 @@ BOOST_AUTO_TEST_CASE(test_angleAtVertex)
 
 }
 
+BOOST_AUTO_TEST_CASE(test_vertex_normals)
+{
+    const auto epsilon{0.0001f};
+    // a square in the xy plane made of two triangles
+    const std::vector<point3d> square{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+    const std::vector<face> squareMesh{{0, 1, 2}, {0, 2, 3}};
+    std::vector<vec3d> normals;
+    computeVertexNormals(square, squareMesh, normals);
+    BOOST_REQUIRE_EQUAL(normals.size(), square.size());
+    for(const auto& n : normals)
+    {
+        BOOST_CHECK_SMALL(n.x, epsilon);
+        BOOST_CHECK_SMALL(n.y, epsilon);
+        BOOST_CHECK_CLOSE(n.z, 1.f, epsilon);
+    }
+
+    // a bumpy grid large enough to be processed in parallel: the result must not depend on the threads
+    const std::size_t n{200};
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    for(std::size_t i = 0; i < n; ++i)
+        for(std::size_t j = 0; j < n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), std::sin(static_cast<float>(i * j)));
+    for(std::size_t i = 0; i + 1 < n; ++i)
+    {
+        for(std::size_t j = 0; j + 1 < n; ++j)
+        {
+            const auto v = static_cast<idxtype>(i * n + j);
+            mesh.emplace_back(v, v + n, v + 1);
+            mesh.emplace_back(v + 1, v + n, v + n + 1);
+        }
+    }
+    std::vector<vec3d> sequential;
+    std::vector<vec3d> parallel;
+    computeVertexNormals(vertices, mesh, sequential, 1);
+    computeVertexNormals(vertices, mesh, parallel, 4);
+    BOOST_REQUIRE_EQUAL(sequential.size(), parallel.size());
+    for(std::size_t i = 0; i < sequential.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(sequential[i].x, parallel[i].x);
+        BOOST_REQUIRE_EQUAL(sequential[i].y, parallel[i].y);
+        BOOST_REQUIRE_EQUAL(sequential[i].z, parallel[i].z);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_face_normals)
+{
+    const std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    const std::vector<face> mesh{{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+    std::vector<vec3d> normals;
+    computeFaceNormals(vertices, mesh, normals, 2);
+    BOOST_REQUIRE_EQUAL(normals.size(), mesh.size());
+    for(std::size_t i = 0; i < mesh.size(); ++i)
+    {
+        const auto expected = computeNormal(vertices[mesh[i].v1], vertices[mesh[i].v2], vertices[mesh[i].v3]);
+        BOOST_CHECK_EQUAL(normals[i].x, expected.x);
+        BOOST_CHECK_EQUAL(normals[i].y, expected.y);
+        BOOST_CHECK_EQUAL(normals[i].z, expected.z);
+    }
+    BOOST_CHECK_CLOSE(normals[0].z, -1.f, 1e-4);
+
+    computeFaceNormals(vertices, {}, normals);
+    BOOST_CHECK(normals.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_normal_lines)
+{
+    const std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}};
+    const std::vector<vec3d> normals{{0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, -1, 0}};
+    std::vector<point3d> lines;
+    computeNormalLines(vertices, normals, .5f, 1, lines, 2);
+    BOOST_REQUIRE_EQUAL(lines.size(), 2 * vertices.size());
+    for(std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        checkSamePoint(lines[2 * i], vertices[i]);
+        checkSamePoint(lines[2 * i + 1], vertices[i] + .5f * normals[i]);
+    }
+
+    // one normal every 2 vertices, from the first one
+    computeNormalLines(vertices, normals, .5f, 2, lines);
+    BOOST_REQUIRE_EQUAL(lines.size(), 6);
+    checkSamePoint(lines[2], vertices[2]);
+    checkSamePoint(lines[5], vertices[4] + .5f * normals[4]);
+    computeNormalLines(vertices, normals, .5f, 0, lines);
+    BOOST_CHECK_EQUAL(lines.size(), 2 * vertices.size());
+    computeNormalLines(vertices, {}, .5f, 1, lines);
+    BOOST_CHECK(lines.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_unique_edges)
+{
+    // a tetrahedron has 6 edges, each shared by 2 faces, listed in the order of the faces
+    const std::vector<face> tetrahedron{{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+    const auto edges = uniqueEdges(4, tetrahedron, 1);
+    const std::vector<edge> expected{{0, 2}, {1, 2}, {0, 1}, {1, 3}, {0, 3}, {2, 3}};
+    BOOST_REQUIRE_EQUAL(edges.size(), expected.size());
+    for(std::size_t i = 0; i < edges.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(edges[i].first, expected[i].first);
+        BOOST_CHECK_EQUAL(edges[i].second, expected[i].second);
+    }
+
+    // the boundary edges are listed too, the degenerate ones and the isolated vertices are ignored
+    const std::vector<face> open{{0, 1, 2}, {2, 1, 3}, {3, 3, 1}};
+    BOOST_CHECK_EQUAL(uniqueEdges(5, open, 1).size(), 5);
+    BOOST_CHECK(uniqueEdges(3, {}, 1).empty());
+
+    // a grid large enough to be processed in parallel: V + F - 1 edges, whatever the threads
+    const std::size_t n{200};
+    std::vector<face> mesh;
+    for(std::size_t i = 0; i + 1 < n; ++i)
+    {
+        for(std::size_t j = 0; j + 1 < n; ++j)
+        {
+            const auto v = static_cast<idxtype>(i * n + j);
+            mesh.emplace_back(v, v + n, v + 1);
+            mesh.emplace_back(v + 1, v + n, v + n + 1);
+        }
+    }
+    const auto sequential = uniqueEdges(n * n, mesh, 1);
+    const auto parallel = uniqueEdges(n * n, mesh, 4);
+    BOOST_CHECK_EQUAL(sequential.size(), n * n + mesh.size() - 1);
+    BOOST_CHECK(sequential == parallel);
+    BOOST_CHECK(std::all_of(parallel.begin(), parallel.end(), [](const edge& e) { return e.first < e.second; }));
+}
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
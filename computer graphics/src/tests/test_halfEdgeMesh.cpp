@@ -0,0 +1,150 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <HalfEdgeMesh.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+std::vector<idxtype> neighbors(const HalfEdgeMesh& he, idxtype v)
+{
+    std::vector<idxtype> result;
+    he.forEachNeighbor(v, [&result](idxtype u) { result.push_back(u); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(test_halfEdgeMesh)
+
+BOOST_AUTO_TEST_CASE(test_tetrahedron)
+{
+    const std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    const std::vector<face> mesh{{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+    HalfEdgeMesh he;
+    he.build(vertices, mesh);
+
+    BOOST_CHECK_EQUAL(he.numVertices(), 4);
+    BOOST_CHECK_EQUAL(he.numFaces(), 4);
+    BOOST_CHECK_EQUAL(he.numHalfEdges(), 12);
+    BOOST_CHECK(he.isManifold());
+    BOOST_CHECK(he.isClosed());
+
+    for(idxtype h = 0; h < he.numHalfEdges(); ++h)
+    {
+        const auto t = he.twin(h);
+        BOOST_REQUIRE_NE(t, HalfEdgeMesh::INVALID);
+        BOOST_CHECK_EQUAL(he.twin(t), h);
+        BOOST_CHECK_EQUAL(he.origin(t), he.target(h));
+        BOOST_CHECK_EQUAL(he.target(t), he.origin(h));
+        BOOST_CHECK_EQUAL(HalfEdgeMesh::next(HalfEdgeMesh::prev(h)), h);
+        BOOST_CHECK_EQUAL(HalfEdgeMesh::faceOf(HalfEdgeMesh::next(h)), HalfEdgeMesh::faceOf(h));
+    }
+    for(idxtype v = 0; v < he.numVertices(); ++v)
+    {
+        BOOST_CHECK(!he.isBoundaryVertex(v));
+        BOOST_CHECK_EQUAL(he.valence(v), 3);
+        he.forEachOutgoing(v, [&](idxtype h) { BOOST_CHECK_EQUAL(he.origin(h), v); });
+    }
+    BOOST_CHECK(neighbors(he, 0) == std::vector<idxtype>({1, 2, 3}));
+
+    std::vector<point3d> outVertices;
+    std::vector<face> outMesh;
+    he.exportMesh(outVertices, outMesh);
+    BOOST_CHECK(outMesh == mesh);
+    BOOST_REQUIRE_EQUAL(outVertices.size(), vertices.size());
+    BOOST_CHECK_EQUAL(outVertices[3].z, 1.f);
+}
+
+BOOST_AUTO_TEST_CASE(test_boundary_and_non_manifold)
+{
+    // a fan of three triangles around the vertex 0, an isolated vertex 5
+    const std::vector<point3d> vertices(6);
+    const std::vector<face> fan{{0, 1, 2}, {0, 2, 3}, {0, 3, 4}};
+    HalfEdgeMesh he;
+    he.build(vertices, fan);
+    BOOST_CHECK(he.isManifold());
+    BOOST_CHECK(!he.isClosed());
+    BOOST_CHECK_EQUAL(he.numBoundaryHalfEdges(), 5);
+    BOOST_CHECK(he.isBoundaryVertex(0));
+    BOOST_CHECK(he.isBoundaryVertex(5));
+    BOOST_CHECK_EQUAL(he.outgoing(5), HalfEdgeMesh::INVALID);
+    BOOST_CHECK_EQUAL(he.valence(5), 0);
+    // the whole one-ring is visited, whatever the order of the faces
+    BOOST_CHECK(neighbors(he, 0) == std::vector<idxtype>({1, 2, 3, 4}));
+    BOOST_CHECK(neighbors(he, 2) == std::vector<idxtype>({0, 1, 3}));
+    BOOST_CHECK_EQUAL(he.valence(1), 2);
+
+    // a third face on the edge (0, 2) and a face with the opposite orientation on the edge (0, 4),
+    // which in turn share the edge (0, 5) with the same orientation
+    const std::vector<face> nonManifold{{0, 1, 2}, {0, 2, 3}, {0, 3, 4}, {2, 0, 5}, {4, 0, 5}};
+    he.build(vertices, nonManifold);
+    BOOST_CHECK(!he.isManifold());
+    BOOST_CHECK_EQUAL(he.numNonManifoldHalfEdges(), 7);
+    BOOST_CHECK_EQUAL(he.twin(1), HalfEdgeMesh::INVALID);
+    BOOST_CHECK_EQUAL(he.twin(2), HalfEdgeMesh::INVALID);
+
+    const std::vector<face> degenerate{{0, 0, 1}};
+    he.build(vertices, degenerate);
+    BOOST_CHECK(!he.isManifold());
+    BOOST_CHECK_EQUAL(he.numNonManifoldHalfEdges(), 1);
+    BOOST_CHECK_EQUAL(he.twin(0), HalfEdgeMesh::INVALID);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_build)
+{
+    // a grid of n x n quads, large enough to be split among the threads
+    const idxtype n{64};
+    std::vector<point3d> vertices;
+    for(idxtype i = 0; i <= n; ++i)
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), 0.f);
+    std::vector<face> mesh;
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype a = i * (n + 1) + j;
+            mesh.emplace_back(a, a + 1, a + n + 2);
+            mesh.emplace_back(a, a + n + 2, a + n + 1);
+        }
+    }
+
+    HalfEdgeMesh sequential;
+    sequential.build(vertices, mesh, 1);
+    HalfEdgeMesh parallel;
+    parallel.build(vertices, mesh, 4);
+
+    BOOST_CHECK(parallel.isManifold());
+    BOOST_CHECK_EQUAL(parallel.numBoundaryHalfEdges(), 4 * n);
+    BOOST_CHECK_EQUAL(parallel.numBoundaryHalfEdges(), sequential.numBoundaryHalfEdges());
+    for(idxtype h = 0; h < parallel.numHalfEdges(); ++h)
+        BOOST_CHECK_EQUAL(parallel.twin(h), sequential.twin(h));
+    for(idxtype v = 0; v < parallel.numVertices(); ++v)
+        BOOST_CHECK_EQUAL(parallel.outgoing(v), sequential.outgoing(v));
+
+    // interior vertices have valence 6, the corners 2 or 3
+    BOOST_CHECK_EQUAL(parallel.valence(n + 2), 6);
+    BOOST_CHECK_EQUAL(parallel.valence(0), 3);
+    BOOST_CHECK_EQUAL(parallel.valence(n), 2);
+
+    std::vector<point3d> outVertices;
+    std::vector<face> outMesh;
+    parallel.exportMesh(outVertices, outMesh, 4);
+    BOOST_CHECK(outMesh == mesh);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
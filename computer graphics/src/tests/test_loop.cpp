@@ -0,0 +1,216 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <loop.hpp>
+
+#include <cstring>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(test_loop)
+
+BOOST_AUTO_TEST_CASE(test_loop_square)
+{
+    // a square made of two triangles sharing the diagonal (0, 2)
+    const std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 1}};
+    const std::vector<face> mesh{{0, 1, 2}, {0, 2, 3}};
+    std::vector<point3d> destVert;
+    std::vector<face> destMesh;
+    std::vector<vec3d> destNorm;
+    loopSubdivision(vertices, mesh, destVert, destMesh, destNorm);
+
+    // the new vertices are numbered in the order the edges are met
+    BOOST_REQUIRE_EQUAL(destVert.size(), 4 + 5);
+    BOOST_REQUIRE_EQUAL(destMesh.size(), 8);
+    BOOST_CHECK_EQUAL(destNorm.size(), destVert.size());
+    BOOST_CHECK_EQUAL(destMesh[0], face(0, 4, 6));
+    BOOST_CHECK_EQUAL(destMesh[1], face(4, 5, 6));
+    BOOST_CHECK_EQUAL(destMesh[2], face(6, 5, 2));
+    BOOST_CHECK_EQUAL(destMesh[3], face(4, 1, 5));
+    BOOST_CHECK_EQUAL(destMesh[4], face(0, 6, 8));
+    BOOST_CHECK_EQUAL(destMesh[5], face(6, 7, 8));
+
+    // a boundary edge gets its midpoint, the shared one the Loop average
+    BOOST_CHECK_CLOSE(destVert[4].x, 0.5f, 1e-4f);
+    BOOST_CHECK_SMALL(destVert[4].y, 1e-6f);
+    BOOST_CHECK_CLOSE(destVert[6].x, 3.f / 8.f * 1.f + 1.f / 8.f * 1.f, 1e-4f);
+    BOOST_CHECK_CLOSE(destVert[6].y, 3.f / 8.f * 1.f + 1.f / 8.f * 1.f, 1e-4f);
+    BOOST_CHECK_CLOSE(destVert[6].z, 1.f / 8.f, 1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE(test_loop_threads)
+{
+    // a bumpy grid of n x n quads, large enough to be split among the threads
+    const idxtype n{48};
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    for(idxtype i = 0; i <= n; ++i)
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), static_cast<float>((i * j) % 5));
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype a = i * (n + 1) + j;
+            mesh.emplace_back(a, a + 1, a + n + 2);
+            mesh.emplace_back(a, a + n + 2, a + n + 1);
+        }
+    }
+
+    std::vector<point3d> vert1, vert4;
+    std::vector<face> mesh1, mesh4;
+    std::vector<vec3d> norm1, norm4;
+    loopSubdivision(vertices, mesh, vert1, mesh1, norm1, 1);
+    loopSubdivision(vertices, mesh, vert4, mesh4, norm4, 4);
+
+    // n x n quads have 3 n^2 + 2 n edges
+    BOOST_CHECK_EQUAL(vert1.size(), vertices.size() + 3 * n * n + 2 * n);
+    BOOST_CHECK_EQUAL(mesh1.size(), 4 * mesh.size());
+    BOOST_REQUIRE_EQUAL(vert4.size(), vert1.size());
+    BOOST_REQUIRE_EQUAL(norm4.size(), norm1.size());
+    BOOST_CHECK(mesh4 == mesh1);
+    BOOST_CHECK(std::memcmp(vert4.data(), vert1.data(), vert1.size() * sizeof(point3d)) == 0);
+    BOOST_CHECK(std::memcmp(norm4.data(), norm1.data(), norm1.size() * sizeof(vec3d)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_loop_direct)
+{
+    // a bumpy grid with a boundary, plus a face sharing one of its edges (non-manifold) and a tetrahedron
+    const idxtype n{12};
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    for(idxtype i = 0; i <= n; ++i)
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), static_cast<float>((i * j) % 3));
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype a = i * (n + 1) + j;
+            mesh.emplace_back(a, a + 1, a + n + 2);
+            mesh.emplace_back(a, a + n + 2, a + n + 1);
+        }
+    }
+    const auto fin = static_cast<idxtype>(vertices.size());
+    vertices.emplace_back(0.5f, 0.5f, 4.f);
+    mesh.emplace_back(0, n + 2, fin);
+    const auto tetrahedron = static_cast<idxtype>(vertices.size());
+    vertices.insert(vertices.end(), {{20, 0, 0}, {21, 0, 0}, {20, 1, 0}, {20, 0, 1}});
+    mesh.insert(mesh.end(), {{tetrahedron, static_cast<idxtype>(tetrahedron + 2), static_cast<idxtype>(tetrahedron + 1)},
+                             {tetrahedron, static_cast<idxtype>(tetrahedron + 1), static_cast<idxtype>(tetrahedron + 3)},
+                             {static_cast<idxtype>(tetrahedron + 1), static_cast<idxtype>(tetrahedron + 2), static_cast<idxtype>(tetrahedron + 3)},
+                             {static_cast<idxtype>(tetrahedron + 2), tetrahedron, static_cast<idxtype>(tetrahedron + 3)}});
+
+    // one level is the same as the single step
+    std::vector<point3d> vert1, direct1;
+    std::vector<face> mesh1, directMesh1;
+    std::vector<vec3d> norm1, directNorm1;
+    loopSubdivision(vertices, mesh, vert1, mesh1, norm1, 1);
+    loopSubdivision(vertices, mesh, 1, direct1, directMesh1, directNorm1, 1);
+    BOOST_CHECK(directMesh1 == mesh1);
+    BOOST_CHECK(direct1.size() == vert1.size());
+
+    // three levels: the same faces in the same order, with the same vertices and normals
+    std::vector<point3d> iterVert = vertices;
+    std::vector<face> iterMesh = mesh;
+    std::vector<vec3d> iterNorm;
+    for(int level = 0; level < 3; ++level)
+    {
+        std::vector<point3d> destVert;
+        std::vector<face> destMesh;
+        loopSubdivision(iterVert, iterMesh, destVert, destMesh, iterNorm, 1);
+        iterVert.swap(destVert);
+        iterMesh.swap(destMesh);
+    }
+    for(const unsigned int threads : {1u, 3u})
+    {
+        std::vector<point3d> directVert;
+        std::vector<face> directMesh;
+        std::vector<vec3d> directNorm;
+        loopSubdivision(vertices, mesh, 3, directVert, directMesh, directNorm, threads);
+        BOOST_REQUIRE_EQUAL(directVert.size(), iterVert.size());
+        BOOST_REQUIRE_EQUAL(directMesh.size(), iterMesh.size());
+        BOOST_REQUIRE_EQUAL(directNorm.size(), directVert.size());
+
+        std::size_t different{0};
+        for(std::size_t i = 0; i < iterMesh.size(); ++i)
+        {
+            const idxtype iter[3] = {iterMesh[i].v1, iterMesh[i].v2, iterMesh[i].v3};
+            const idxtype direct[3] = {directMesh[i].v1, directMesh[i].v2, directMesh[i].v3};
+            for(std::size_t k = 0; k < 3; ++k)
+            {
+                if(std::memcmp(&iterVert[iter[k]], &directVert[direct[k]], sizeof(point3d)) != 0 ||
+                   std::memcmp(&iterNorm[iter[k]], &directNorm[direct[k]], sizeof(vec3d)) != 0)
+                    ++different;
+            }
+        }
+        BOOST_CHECK_EQUAL(different, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_loop_stencils)
+{
+    // a bumpy grid with a boundary
+    const idxtype n{8};
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    for(idxtype i = 0; i <= n; ++i)
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), static_cast<float>((i * j) % 3));
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype a = i * (n + 1) + j;
+            mesh.emplace_back(a, a + 1, a + n + 2);
+            mesh.emplace_back(a, a + n + 2, a + n + 1);
+        }
+    }
+
+    LoopStencils stencils;
+    stencils.build(vertices.size(), mesh, 2, 2);
+    BOOST_CHECK_EQUAL(stencils.numInputVertices(), vertices.size());
+
+    // the weights of each stencil sum to 1, as the subdivision does not depend on the origin
+    std::vector<point3d> ones;
+    stencils.apply(std::vector<point3d>(vertices.size(), point3d(1, 1, 1)), ones);
+    for(const auto& p : ones)
+        BOOST_CHECK_CLOSE(p.x, 1.f, 1e-4f);
+
+    // the same as the subdivision, also after moving the vertices
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        std::vector<point3d> level1, expectedVert;
+        std::vector<face> mesh1, expectedMesh;
+        std::vector<vec3d> normals1, expectedNorm;
+        loopSubdivision(vertices, mesh, level1, mesh1, normals1);
+        loopSubdivision(level1, mesh1, expectedVert, expectedMesh, expectedNorm);
+
+        std::vector<point3d> destVert;
+        std::vector<vec3d> destNorm;
+        stencils.apply(vertices, destVert, destNorm);
+        BOOST_CHECK(stencils.mesh() == expectedMesh);
+        BOOST_REQUIRE_EQUAL(stencils.numOutputVertices(), expectedVert.size());
+        BOOST_REQUIRE_EQUAL(destVert.size(), expectedVert.size());
+        BOOST_REQUIRE_EQUAL(destNorm.size(), expectedVert.size());
+        // the vertices are numbered as in the subdivision level by level
+        for(std::size_t i = 0; i < expectedVert.size(); ++i)
+        {
+            BOOST_CHECK_SMALL((destVert[i] - expectedVert[i]).norm(), 1e-4f);
+            BOOST_CHECK_SMALL((destNorm[i] - expectedNorm[i]).norm(), 1e-4f);
+        }
+
+        for(auto& v : vertices)
+            v = point3d(2 * v.x + 1, v.y - 3, v.z * v.z);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <geometry.hpp>
+#include <MeshBuffers.hpp>
+#include <rendering.hpp>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+
+/// the size of the images rendered
+constexpr GLsizei IMAGE_SIZE{64};
+
+/**
+ * An OpenGL context without any window, rendering in an offscreen surface, e.g. with the
+ * software renderer of Mesa (llvmpipe)
+ */
+struct OffscreenContext
+{
+    /// the display
+    EGLDisplay display{EGL_NO_DISPLAY};
+    /// the offscreen surface
+    EGLSurface surface{EGL_NO_SURFACE};
+    /// the context
+    EGLContext context{EGL_NO_CONTEXT};
+
+    OffscreenContext()
+    {
+        const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if(getPlatformDisplay)
+        {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if(display == EGL_NO_DISPLAY)
+        {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major{0};
+        EGLint minor{0};
+        if((display == EGL_NO_DISPLAY) || !eglInitialize(display, &major, &minor))
+        {
+            display = EGL_NO_DISPLAY;
+            return;
+        }
+
+        const EGLint attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 24, EGL_NONE};
+        EGLConfig config{};
+        EGLint numConfigs{0};
+        if(!eglChooseConfig(display, attributes, &config, 1, &numConfigs) || (numConfigs == 0) || !eglBindAPI(EGL_OPENGL_API))
+        {
+            return;
+        }
+        const EGLint size[] = {EGL_WIDTH, IMAGE_SIZE, EGL_HEIGHT, IMAGE_SIZE, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, size);
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+        if((surface == EGL_NO_SURFACE) || (context == EGL_NO_CONTEXT) || !eglMakeCurrent(display, surface, surface, context))
+        {
+            context = EGL_NO_CONTEXT;
+        }
+    }
+
+    ~OffscreenContext()
+    {
+        if(display != EGL_NO_DISPLAY)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if(context != EGL_NO_CONTEXT)
+                eglDestroyContext(display, context);
+            if(surface != EGL_NO_SURFACE)
+                eglDestroySurface(display, surface);
+            eglTerminate(display);
+        }
+    }
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    [[nodiscard]] bool valid() const { return context != EGL_NO_CONTEXT; }
+};
+
+/**
+ * Set up a lit scene looking at the unit cube
+ */
+void setupScene()
+{
+    glViewport(0, 0, IMAGE_SIZE, IMAGE_SIZE);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(-1.5, 1.5, -1.5, 1.5, -10, 10);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glRotatef(30.f, 1.f, 0.f, 0.f);
+    glRotatef(40.f, 0.f, 1.f, 0.f);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glEnable(GL_CULL_FACE);
+    const GLfloat position[] = {0.f, 0.f, 10.f, 1.f};
+    glLightfv(GL_LIGHT0, GL_POSITION, position);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_LIGHTING);
+}
+
+/**
+ * Clear the image
+ */
+void clear()
+{
+    glClearColor(.5f, .5f, .75f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+/**
+ * Read the image rendered
+ * @return the RGBA pixels
+ */
+std::vector<unsigned char> readImage()
+{
+    glFinish();
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(IMAGE_SIZE * IMAGE_SIZE * 4));
+    glReadPixels(0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+/**
+ * Count the pixels that are not the background
+ * @param[in] image the RGBA pixels
+ * @return the number of pixels drawn
+ */
+std::size_t coverage(const std::vector<unsigned char>& image)
+{
+    std::size_t count{0};
+    for(std::size_t i = 0; i < image.size(); i += 4)
+    {
+        if((image[i] != 128) || (image[i + 1] != 128) || (image[i + 2] != 191))
+            ++count;
+    }
+    return count;
+}
+
+/// a cube made of 12 triangles, with the normals of its vertices
+struct Cube
+{
+    std::vector<point3d> vertices{{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+                                  {-1, -1, 1},  {1, -1, 1},  {1, 1, 1},  {-1, 1, 1}};
+    std::vector<face> mesh{{0, 2, 1}, {0, 3, 2}, {4, 5, 6}, {4, 6, 7}, {0, 1, 5}, {0, 5, 4},
+                           {2, 3, 7}, {2, 7, 6}, {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3}};
+    std::vector<vec3d> normals{};
+
+    Cube()
+    {
+        for(const auto& v : vertices)
+        {
+            normals.push_back(v * (1.f / v.norm()));
+        }
+    }
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_meshBuffers)
+
+BOOST_AUTO_TEST_CASE(test_buffers_rendering)
+{
+    OffscreenContext context;
+    if(!context.valid() || !MeshBuffers::supported())
+    {
+        BOOST_TEST_MESSAGE("No OpenGL context with buffer objects available, the test is skipped");
+        return;
+    }
+
+    const Cube cube;
+    MeshBuffers buffers;
+    BOOST_CHECK(buffers.empty());
+    BOOST_REQUIRE(buffers.upload(cube.vertices, cube.normals, cube.mesh));
+    BOOST_CHECK(!buffers.empty());
+    // the 12 edges of the cube and the 6 diagonals of its sides
+    BOOST_CHECK_EQUAL(buffers.numEdges(), 18);
+    BOOST_CHECK_EQUAL(buffers.bytes(), 8 * 2 * sizeof(point3d) + 12 * sizeof(face) + 18 * sizeof(edge));
+
+    setupScene();
+    RenderingParameters params;
+    params.wireframe = false;
+
+    // with the corners of the faces for flat shading
+    std::vector<vec3d> faceNormals;
+    computeFaceNormals(cube.vertices, cube.mesh, faceNormals, 1);
+    BOOST_CHECK(!buffers.hasFlatTriangles());
+    BOOST_REQUIRE(buffers.uploadFlatTriangles(cube.vertices, cube.mesh, faceNormals));
+    BOOST_CHECK(buffers.hasFlatTriangles());
+    BOOST_CHECK_EQUAL(buffers.bytes(), 8 * 2 * sizeof(point3d) + 12 * sizeof(face) + 18 * sizeof(edge) + 36 * 2 * sizeof(point3d));
+
+    // the faces are the same as drawn from the main memory
+    for(const bool smooth : {true, false})
+    {
+        params.smooth = smooth;
+        clear();
+        draw(cube.vertices, cube.mesh, cube.normals, params);
+        const auto expected = readImage();
+        clear();
+        draw(buffers, cube.vertices, cube.mesh, cube.normals, params);
+        const auto image = readImage();
+        BOOST_CHECK_GT(coverage(image), 0);
+        BOOST_CHECK(image == expected);
+        // and with the normals of the faces computed once
+        clear();
+        draw(cube.vertices, cube.mesh, cube.normals, params, faceNormals);
+        BOOST_CHECK(readImage() == expected);
+    }
+    BOOST_CHECK(!buffers.uploadFlatTriangles(cube.vertices, cube.mesh, {}));
+    BOOST_CHECK(!buffers.hasFlatTriangles());
+
+    // the wireframe, each edge drawn once, covers about the same pixels as the contours of the faces
+    params.solid = false;
+    params.wireframe = true;
+    clear();
+    draw(cube.vertices, cube.mesh, cube.normals, params);
+    const auto expected = coverage(readImage());
+    clear();
+    draw(buffers, cube.vertices, cube.mesh, cube.normals, params);
+    const auto wireframe = coverage(readImage());
+    BOOST_CHECK_GT(wireframe, 0);
+    BOOST_CHECK_LE(std::max(wireframe, expected) - std::min(wireframe, expected), expected / 10);
+    BOOST_CHECK_EQUAL(glGetError(), GL_NO_ERROR);
+
+    // the normals drawn from the buffers, with a single call, are the same as drawn from the main memory
+    std::vector<point3d> lines;
+    computeNormalLines(cube.vertices, cube.normals, .4f, 1, lines);
+    BOOST_CHECK(!buffers.hasNormalLines());
+    BOOST_REQUIRE(buffers.uploadNormalLines(lines));
+    BOOST_CHECK(buffers.hasNormalLines());
+    params.wireframe = false;
+    clear();
+    drawNormalLines(lines);
+    const auto expectedNormals = readImage();
+    BOOST_CHECK_GT(coverage(expectedNormals), 0);
+    clear();
+    drawNormalLines(buffers);
+    BOOST_CHECK(readImage() == expectedNormals);
+    BOOST_CHECK_EQUAL(glGetError(), GL_NO_ERROR);
+    params.wireframe = true;
+
+    // the vertices can be replaced alone, as long as their number does not change
+    std::vector<point3d> scaled;
+    for(const auto& v : cube.vertices)
+        scaled.push_back(v * .5f);
+    BOOST_REQUIRE(buffers.uploadFlatTriangles(cube.vertices, cube.mesh, faceNormals));
+    BOOST_CHECK(buffers.uploadVertices(scaled, cube.normals));
+    BOOST_CHECK_EQUAL(buffers.numEdges(), 18);
+    BOOST_CHECK(!buffers.hasFlatTriangles());
+    BOOST_CHECK(!buffers.hasNormalLines());
+    clear();
+    draw(buffers, scaled, cube.mesh, cube.normals, params);
+    BOOST_CHECK_LT(coverage(readImage()), wireframe);
+    BOOST_CHECK(!buffers.uploadVertices({scaled.begin(), scaled.begin() + 4}, {}));
+    BOOST_CHECK(buffers.empty());
+
+    // the buffers are replaced by a new upload and can be moved
+    const std::vector<face> half(cube.mesh.begin(), cube.mesh.begin() + 6);
+    BOOST_REQUIRE(buffers.upload(cube.vertices, {}, half));
+    BOOST_CHECK_EQUAL(buffers.numEdges(), 13);
+    MeshBuffers other(std::move(buffers));
+    BOOST_CHECK(buffers.empty());
+    BOOST_CHECK(!other.empty());
+    other.release();
+    BOOST_CHECK(other.empty());
+    BOOST_CHECK(other.upload(cube.vertices, cube.normals, {}));
+    BOOST_CHECK(other.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <meshCache.hpp>
+#include <objReader.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Write a simple model (a tetrahedron) to file
+ */
+void writeTetrahedron(const std::string& filename, const std::string& comment = "")
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << "# tetrahedron" << comment << "\n"
+        << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\n"
+        << "f 1 3 2\nf 1 2 4\nf 2 3 4\nf 3 1 4\n";
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_meshCache)
+
+BOOST_AUTO_TEST_CASE(test_cache_roundtrip)
+{
+    const auto filename = (fs::temp_directory_path() / "test_cache_roundtrip.obj").string();
+    writeTetrahedron(filename);
+    fs::remove(meshCacheFilename(filename));
+
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    std::vector<vec3d> normals;
+    std::vector<texcoord> texcoords;
+    BoundingBox bb;
+    BOOST_REQUIRE(load(filename, vertices, mesh, normals, bb));
+
+    // no cache yet
+    std::vector<point3d> cVertices;
+    std::vector<face> cMesh;
+    std::vector<vec3d> cNormals;
+    std::vector<texcoord> cTexcoords;
+    BoundingBox cBB;
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+
+    BOOST_REQUIRE(saveMeshCache(filename, vertices, mesh, normals, texcoords, bb, LoadParameters()));
+    BOOST_REQUIRE(loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+    BOOST_CHECK(cMesh == mesh);
+    BOOST_REQUIRE_EQUAL(cVertices.size(), vertices.size());
+    BOOST_REQUIRE_EQUAL(cNormals.size(), normals.size());
+    for(std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(cVertices[i].x, vertices[i].x);
+        BOOST_CHECK_EQUAL(cVertices[i].y, vertices[i].y);
+        BOOST_CHECK_EQUAL(cVertices[i].z, vertices[i].z);
+        BOOST_CHECK_EQUAL(cNormals[i].x, normals[i].x);
+        BOOST_CHECK_EQUAL(cNormals[i].y, normals[i].y);
+        BOOST_CHECK_EQUAL(cNormals[i].z, normals[i].z);
+    }
+    BOOST_CHECK_EQUAL(cBB.pmax.x, bb.pmax.x);
+    BOOST_CHECK_EQUAL(cBB.pmin.z, bb.pmin.z);
+
+    fs::remove(meshCacheFilename(filename));
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_cache_invalid)
+{
+    const auto filename = (fs::temp_directory_path() / "test_cache_invalid.obj").string();
+    const auto cacheName = meshCacheFilename(filename);
+    writeTetrahedron(filename);
+
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    std::vector<vec3d> normals;
+    std::vector<texcoord> texcoords;
+    BoundingBox bb;
+    BOOST_REQUIRE(load(filename, vertices, mesh, normals, bb));
+    BOOST_REQUIRE(saveMeshCache(filename, vertices, mesh, normals, texcoords, bb, LoadParameters()));
+
+    std::vector<point3d> cVertices;
+    std::vector<face> cMesh;
+    std::vector<vec3d> cNormals;
+    std::vector<texcoord> cTexcoords;
+    BoundingBox cBB;
+
+    // corrupt a byte of the data
+    {
+        std::fstream cache(cacheName, std::ios::binary | std::ios::in | std::ios::out);
+        cache.seekp(-5, std::ios::end);
+        cache.put('\x7f');
+    }
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+
+    // truncated cache
+    BOOST_REQUIRE(saveMeshCache(filename, vertices, mesh, normals, texcoords, bb, LoadParameters()));
+    fs::resize_file(cacheName, fs::file_size(cacheName) - 4);
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+
+    // a number of vertices whose size overflows to the size of the file (the count is at byte 32 of the header)
+    BOOST_REQUIRE(saveMeshCache(filename, vertices, mesh, normals, texcoords, bb, LoadParameters()));
+    {
+        std::fstream cache(cacheName, std::ios::binary | std::ios::in | std::ios::out);
+        std::uint64_t numVertices{0};
+        cache.seekg(32);
+        cache.read(reinterpret_cast<char*>(&numVertices), sizeof(numVertices));
+        BOOST_REQUIRE_EQUAL(numVertices, vertices.size());
+        numVertices += std::uint64_t{1} << 62u;
+        cache.seekp(32);
+        cache.write(reinterpret_cast<const char*>(&numVertices), sizeof(numVertices));
+    }
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+
+    // the source has changed after the cache has been created
+    BOOST_REQUIRE(saveMeshCache(filename, vertices, mesh, normals, texcoords, bb, LoadParameters()));
+    BOOST_CHECK(loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+    // the cache has been created without the attributes of the file and without welding
+    LoadParameters params;
+    params.useFileAttributes = true;
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, params));
+    params = LoadParameters();
+    params.weld = true;
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, params));
+    writeTetrahedron(filename, " modified");
+    BOOST_CHECK(!loadMeshCache(filename, cVertices, cMesh, cNormals, cTexcoords, cBB, LoadParameters()));
+
+    fs::remove(cacheName);
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <Model.hpp>
+#include <SoftwareRasterizer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+/**
+ * Write a tetrahedron in an OBJ file
+ * @param[in] name the name of the file in the temporary directory
+ * @return the path of the file
+ */
+std::string writeTetrahedron(const std::string& name)
+{
+    const auto filename = (fs::temp_directory_path() / name).string();
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << "v 0 0 0\nv 4 0 0\nv 0 4 0\nv 0 0 4\nf 1 3 2\nf 1 2 4\nf 2 3 4\nf 3 1 4\n";
+    return filename;
+}
+
+/**
+ * Render the model until the subdivision level requested is displayed
+ * @param[in,out] model the model
+ * @param[in,out] rasterizer the renderer
+ * @param[in] params the rendering parameters
+ */
+void rasterizeSubdivision(Model& model, SoftwareRasterizer& rasterizer, const RenderingParameters& params)
+{
+    model.rasterize(rasterizer, params);
+    model.waitSubdivision();
+    rasterizer.clear();
+    model.rasterize(rasterizer, params);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_model)
+
+BOOST_AUTO_TEST_CASE(test_unitize_keeps_subdivision)
+{
+    const auto filename = writeTetrahedron("test_unitize_keeps_subdivision.obj");
+    LoadParameters loadParams;
+    loadParams.useCache = false;
+    Model model;
+    BOOST_REQUIRE(model.load(filename, loadParams));
+
+    SoftwareRasterizer rasterizer(64, 64, 1);
+    RenderingParameters params;
+    params.subdivision = true;
+    params.subdivLevel = 2;
+    rasterizeSubdivision(model, rasterizer, params);
+    BOOST_CHECK_EQUAL(model.subdivisionStatistics().levels, 2);
+
+    // the levels follow the vertices through the stencils of each level instead of being subdivided again
+    model.unitizeModel();
+    BOOST_CHECK_EQUAL(model.subdivisionStatistics().levels, 2);
+    const auto misses = model.subdivisionStatistics().misses;
+    rasterizer.clear();
+    model.rasterize(rasterizer, params);
+    BOOST_CHECK(!model.subdividing());
+    BOOST_CHECK_EQUAL(model.subdivisionStatistics().misses, misses);
+    const auto moved = rasterizer.image();
+
+    // the same image as subdividing the unitized model
+    Model other;
+    BOOST_REQUIRE(other.load(filename, loadParams));
+    other.unitizeModel();
+    SoftwareRasterizer expected(64, 64, 1);
+    rasterizeSubdivision(other, expected, params);
+    BOOST_CHECK(moved == expected.image());
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(test_direct_subdivision)
+{
+    const auto filename = writeTetrahedron("test_direct_subdivision.obj");
+    LoadParameters loadParams;
+    loadParams.useCache = false;
+    SoftwareRasterizer rasterizer(64, 64, 1);
+    RenderingParameters params;
+    params.subdivision = true;
+    params.subdivLevel = 2;
+
+    Model model;
+    BOOST_REQUIRE(model.load(filename, loadParams));
+    rasterizeSubdivision(model, rasterizer, params);
+    BOOST_CHECK_EQUAL(model.subdivisionStatistics().levels, 2);
+
+    // the level 2 (1584 bytes) does not fit in the budget: it is computed at once, without the level 1
+    Model direct;
+    BOOST_REQUIRE(direct.load(filename, loadParams));
+    params.subdivisionBudget = 1000;
+    SoftwareRasterizer directRasterizer(64, 64, 1);
+    rasterizeSubdivision(direct, directRasterizer, params);
+    BOOST_CHECK_EQUAL(direct.subdivisionStatistics().levels, 0);
+    BOOST_CHECK(directRasterizer.image() == rasterizer.image());
+    fs::remove(filename);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -13,11 +13,42 @@
 #include <core.hpp>
 
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <map>
 #include <string>
 #include <optional>
+#include <vector>
 
 
+namespace
+{
+
+/**
+ * Append the bytes of a value to a buffer, in the requested byte order
+ * @param[in,out] out the buffer
+ * @param[in] value the value
+ * @param[in] bigEndian true to write it in big endian
+ */
+template <typename T>
+void writeBinary(std::string& out, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    const std::uint16_t probe{1};
+    const bool littleEndianMachine = (*reinterpret_cast<const unsigned char*>(&probe) == 1);
+    if(bigEndian == littleEndianMachine)
+        std::reverse(bytes, bytes + sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+}  // namespace
+
 BOOST_AUTO_TEST_SUITE(test_parsing)
 
 BOOST_AUTO_TEST_CASE(test_parse_face)
@@ -29,6 +60,11 @@ BOOST_AUTO_TEST_CASE(test_parse_face)
                                          {"f 12/13 1 5", std::nullopt},
                                          {"f 12/12/12 13/32/32 1/2332/332", face(12, 13, 1)},
                                          {"f 12//15 13//302 1//3200", face(12, 13, 1),},
+                                         {"f 12 13 1 5", face(12, 13, 1)},
+                                         {"f\t12 13 1\r", face(12, 13, 1)},
+                                         {"f 12/1/ 13/1/5 1/5/9", std::nullopt},
+                                         {"f 12 13", std::nullopt},
+                                         {"f12 13 1", std::nullopt},
                                          {"not a face", std::nullopt}};
 
     for(const auto&[str, res] : test)
@@ -56,6 +92,9 @@ BOOST_AUTO_TEST_CASE(test_parse_vertex)
          {"v -10.1603 5.71902 -0.957758", point3d(-10.1603f, 5.71902f, -0.957758f)},
          {"v 2.422296 -1.510915 -0.494169", point3d(2.422296f, -1.510915f, -0.494169f)},
          {"v 2.422296 -1.510915e -0.494169", std::nullopt},
+         {"v +1.5 .5 -.25", point3d(1.5f, 0.5f, -0.25f)},
+         {"v 1. 2 3", std::nullopt},
+         {"v 1 2", std::nullopt},
          {"", std::nullopt,},
          {"not a vertex", std::nullopt}
     };
@@ -76,5 +115,417 @@ BOOST_AUTO_TEST_CASE(test_parse_vertex)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_parse_face_corners)
+{
+    const auto corners = parseFaceCorners("f 12/13/1 13/1/5 1/5/9");
+    BOOST_CHECK_EQUAL(corners.vertices, face(12, 13, 1));
+    BOOST_CHECK_EQUAL(corners.texcoords, face(13, 1, 5));
+    BOOST_CHECK_EQUAL(corners.normals, face(1, 5, 9));
+    BOOST_CHECK(corners.hasTexcoords && corners.hasNormals);
+
+    const auto normalsOnly = parseFaceCorners("f 12//15 13//302 1//3200");
+    BOOST_CHECK_EQUAL(normalsOnly.normals, face(15, 302, 3200));
+    BOOST_CHECK(!normalsOnly.hasTexcoords && normalsOnly.hasNormals);
+
+    const auto texcoordsOnly = parseFaceCorners("f 12/13 13/1 1/5");
+    BOOST_CHECK_EQUAL(texcoordsOnly.texcoords, face(13, 1, 5));
+    BOOST_CHECK(texcoordsOnly.hasTexcoords && !texcoordsOnly.hasNormals);
+
+    BOOST_CHECK(!parseFaceCorners("f 12 13 1").hasNormals);
+    BOOST_CHECK_THROW(parseFaceCorners("f 12/13 1 5"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_attributes)
+{
+    const auto epsilon{0.0001f};
+    const auto n = parseNormalString("vn -0.5 0.25e1 +1");
+    BOOST_CHECK_CLOSE(n.x, -0.5f, epsilon);
+    BOOST_CHECK_CLOSE(n.y, 2.5f, epsilon);
+    BOOST_CHECK_CLOSE(n.z, 1.f, epsilon);
+    BOOST_CHECK_THROW(parseNormalString("vn 1 2"), std::invalid_argument);
+    BOOST_CHECK_THROW(parseNormalString("v 1 2 3"), std::invalid_argument);
+
+    const auto t = parseTexcoordString("vt 0.25 0.75");
+    BOOST_CHECK_CLOSE(t.x, 0.25f, epsilon);
+    BOOST_CHECK_CLOSE(t.y, 0.75f, epsilon);
+    BOOST_CHECK_EQUAL(t.z, 0.f);
+    BOOST_CHECK_CLOSE(parseTexcoordString("vt 0.5\r").x, 0.5f, epsilon);
+    BOOST_CHECK_CLOSE(parseTexcoordString("vt 1 2 3").z, 3.f, epsilon);
+    BOOST_CHECK_THROW(parseTexcoordString("vt"), std::invalid_argument);
+    BOOST_CHECK_THROW(parseTexcoordString("vn 1 2 3"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_load_modes)
+{
+    // a square made of two triangles, with a comment, a normal, a CRLF line and no final newline
+    const auto filename = (std::filesystem::temp_directory_path() / "test_load_modes.obj").string();
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "# square\nv 0 0 0\nv 1 0 0\r\nv 1 1 0\nv 0 1 0\nvn 0 0 1\nf 1 2 3\nf 1//1 3//1 4//1";
+    }
+
+    for(const bool mapped : {true, false})
+    {
+        LoadParameters params;
+        params.useMemoryMapping = mapped;
+        std::vector<point3d> vertices;
+        std::vector<face> mesh;
+        std::vector<vec3d> normals;
+        std::vector<texcoord> texcoords;
+        BoundingBox bb;
+        LoadStatistics stats;
+        BOOST_REQUIRE(load(filename, vertices, mesh, normals, texcoords, bb, stats, params));
+        if(mapped)
+        {
+            BOOST_CHECK_EQUAL(stats.vertexRecords, 4);
+            BOOST_CHECK_EQUAL(stats.faceRecords, 2);
+            BOOST_CHECK_EQUAL(stats.reallocations, 0);
+        }
+        BOOST_CHECK_EQUAL(vertices.size(), 4);
+        BOOST_CHECK_EQUAL(normals.size(), 4);
+        BOOST_REQUIRE_EQUAL(mesh.size(), 2);
+        BOOST_CHECK_EQUAL(mesh[0], face(0, 1, 2));
+        BOOST_CHECK_EQUAL(mesh[1], face(0, 2, 3));
+        BOOST_CHECK_CLOSE(bb.pmax.x, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(bb.pmax.y, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(normals[0].z, 1.f, 0.0001f);
+    }
+    std::remove(filename.c_str());
+
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    std::vector<vec3d> normals;
+    BoundingBox bb;
+    BOOST_CHECK(!load("this/file/does/not/exist.obj", vertices, mesh, normals, bb));
+}
+
+BOOST_AUTO_TEST_CASE(test_load_parallel)
+{
+    // a grid large enough to be split in several chunks
+    const auto filename = (std::filesystem::temp_directory_path() / "test_load_parallel.obj").string();
+    const idxtype n{250};
+    {
+        std::ofstream out(filename, std::ios::binary);
+        for(idxtype i = 0; i < n; ++i)
+            for(idxtype j = 0; j < n; ++j)
+                out << "v " << static_cast<float>(i) * 0.1f << " " << static_cast<float>(j) * 0.1f << " " << static_cast<float>((i * j) % 7) << "\n";
+        for(idxtype i = 0; i + 1 < n; ++i)
+        {
+            for(idxtype j = 0; j + 1 < n; ++j)
+            {
+                const auto v = i * n + j + 1;
+                out << "f " << v << " " << v + n << " " << v + 1 << "\n";
+                out << "f " << v + 1 << " " << v + n << " " << v + n + 1 << "\n";
+            }
+        }
+    }
+
+    std::vector<point3d> vertices[2];
+    std::vector<face> mesh[2];
+    std::vector<vec3d> normals[2];
+    std::vector<texcoord> texcoords[2];
+    BoundingBox bb[2];
+    LoadParameters params[2];
+    params[0].useMemoryMapping = false;
+    params[1].threads = 4;
+    LoadStatistics stats[2];
+    for(std::size_t k = 0; k < 2; ++k)
+    {
+        BOOST_REQUIRE(load(filename, vertices[k], mesh[k], normals[k], texcoords[k], bb[k], stats[k], params[k]));
+    }
+    // the lists of the parallel parsing are allocated once with their final size
+    BOOST_CHECK_EQUAL(stats[1].vertexRecords, n * n);
+    BOOST_CHECK_EQUAL(stats[1].reallocations, 0);
+
+    // the same faces when the corners of the faces are parsed as well
+    {
+        LoadParameters attributes;
+        attributes.threads = 4;
+        attributes.useFileAttributes = true;
+        std::vector<point3d> v;
+        std::vector<face> m;
+        std::vector<vec3d> nrm;
+        std::vector<texcoord> t;
+        BoundingBox box;
+        LoadStatistics st;
+        BOOST_REQUIRE(load(filename, v, m, nrm, t, box, st, attributes));
+        BOOST_CHECK(m == mesh[0]);
+        BOOST_CHECK(!st.fileNormals);
+        BOOST_CHECK_EQUAL(st.reallocations, 0);
+    }
+
+    // a load cancelled by the progress callback stops at the next chunk and fails
+    for(const bool mapped : {true, false})
+    {
+        std::atomic<bool> cancel{false};
+        std::atomic<std::size_t> parsed{0};
+        LoadParameters cancelled;
+        cancelled.useMemoryMapping = mapped;
+        cancelled.threads = 4;
+        cancelled.cancel = &cancel;
+        cancelled.progress = [&cancel, &parsed](std::size_t bytes, std::size_t) {
+            parsed.store(bytes);
+            cancel.store(true);
+        };
+        std::vector<point3d> v;
+        std::vector<face> m;
+        std::vector<vec3d> nrm;
+        std::vector<texcoord> t;
+        BoundingBox box;
+        LoadStatistics st;
+        BOOST_CHECK(!load(filename, v, m, nrm, t, box, st, cancelled));
+        BOOST_CHECK_LT(parsed.load(), std::filesystem::file_size(filename));
+    }
+    std::remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(vertices[1].size(), n * n);
+    BOOST_REQUIRE_EQUAL(mesh[1].size(), 2 * (n - 1) * (n - 1));
+    BOOST_CHECK(mesh[0] == mesh[1]);
+    for(std::size_t i = 0; i < vertices[0].size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(vertices[0][i].x, vertices[1][i].x);
+        BOOST_REQUIRE_EQUAL(vertices[0][i].y, vertices[1][i].y);
+        BOOST_REQUIRE_EQUAL(vertices[0][i].z, vertices[1][i].z);
+        BOOST_REQUIRE_EQUAL(normals[0][i].z, normals[1][i].z);
+    }
+    BOOST_CHECK_EQUAL(bb[1].pmax.x, vertices[1].back().x);
+    BOOST_CHECK_EQUAL(bb[1].pmax.z, 6.f);
+}
+
+BOOST_AUTO_TEST_CASE(test_load_attributes)
+{
+    // a square folded along its diagonal: each triangle has its own normal, hence the two vertices
+    // of the diagonal are shared by corners with different normals
+    const auto filename = (std::filesystem::temp_directory_path() / "test_load_attributes.obj").string();
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+            << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+            << "vn 0 0 2\nvn 0 1 0\n"
+            << "f 1/1/1 2/2/1 3/3/1\nf 1/1/2 3/3/2 4/4/2\n";
+    }
+
+    for(const bool mapped : {true, false})
+    {
+        LoadParameters params;
+        params.useMemoryMapping = mapped;
+        params.useFileAttributes = true;
+        std::vector<point3d> vertices;
+        std::vector<face> mesh;
+        std::vector<vec3d> normals;
+        std::vector<texcoord> texcoords;
+        BoundingBox bb;
+        LoadStatistics stats;
+        BOOST_REQUIRE(load(filename, vertices, mesh, normals, texcoords, bb, stats, params));
+        BOOST_CHECK(stats.fileNormals);
+
+        // the first and the third vertex are duplicated for the second face
+        BOOST_REQUIRE_EQUAL(vertices.size(), 6);
+        BOOST_REQUIRE_EQUAL(normals.size(), 6);
+        BOOST_REQUIRE_EQUAL(texcoords.size(), 6);
+        BOOST_REQUIRE_EQUAL(mesh.size(), 2);
+        BOOST_CHECK_EQUAL(mesh[0], face(0, 1, 2));
+        BOOST_CHECK_EQUAL(mesh[1], face(4, 5, 3));
+        BOOST_CHECK_EQUAL(vertices[4].x, vertices[0].x);
+        BOOST_CHECK_EQUAL(vertices[5].y, vertices[2].y);
+
+        // the normals are normalized
+        BOOST_CHECK_CLOSE(normals[0].z, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(normals[2].z, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(normals[3].y, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(normals[4].y, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(texcoords[3].y, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(texcoords[5].x, 1.f, 0.0001f);
+    }
+
+    // a seam of the texture along the diagonal: the vertices of the second face on the seam are
+    // split, so that each corner keeps its own texture coordinates
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+            << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvt .5 .5\n"
+            << "vn 0 0 1\n"
+            << "f 1/1/1 2/2/1 3/3/1\nf 1/5/1 3/5/1 4/4/1\n";
+    }
+    {
+        LoadParameters params;
+        params.useFileAttributes = true;
+        std::vector<point3d> vertices;
+        std::vector<face> mesh;
+        std::vector<vec3d> normals;
+        std::vector<texcoord> texcoords;
+        BoundingBox bb;
+        LoadStatistics stats;
+        BOOST_REQUIRE(load(filename, vertices, mesh, normals, texcoords, bb, stats, params));
+        BOOST_CHECK(stats.fileNormals);
+        BOOST_CHECK_EQUAL(vertices.size(), 6);
+        BOOST_REQUIRE_EQUAL(texcoords.size(), 6);
+        BOOST_REQUIRE_EQUAL(normals.size(), 6);
+        BOOST_CHECK_EQUAL(mesh[0], face(0, 1, 2));
+        BOOST_CHECK_EQUAL(mesh[1], face(4, 5, 3));
+        BOOST_CHECK_EQUAL(vertices[4].x, vertices[0].x);
+        BOOST_CHECK_EQUAL(vertices[5].y, vertices[2].y);
+        BOOST_CHECK_CLOSE(texcoords[2].x, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(texcoords[3].y, 1.f, 0.0001f);
+        BOOST_CHECK_CLOSE(texcoords[4].x, .5f, 0.0001f);
+        BOOST_CHECK_CLOSE(texcoords[5].y, .5f, 0.0001f);
+        BOOST_CHECK_CLOSE(normals[5].z, 1.f, 0.0001f);
+
+        // the corners of the file only cover its own faces, so the lists must be empty
+        BOOST_CHECK(!load(filename, vertices, mesh, normals, texcoords, bb, stats, params));
+        BOOST_CHECK_EQUAL(vertices.size(), 6);
+        BOOST_CHECK_EQUAL(mesh.size(), 2);
+    }
+
+    // by default the attributes of the file are ignored and the normals are computed
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    std::vector<vec3d> normals;
+    std::vector<texcoord> texcoords;
+    BoundingBox bb;
+    LoadStatistics stats;
+    BOOST_REQUIRE(load(filename, vertices, mesh, normals, texcoords, bb, stats));
+    BOOST_CHECK(!stats.fileNormals);
+    BOOST_CHECK_EQUAL(vertices.size(), 4);
+    BOOST_CHECK(texcoords.empty());
+    BOOST_CHECK_EQUAL(mesh[1], face(0, 2, 3));
+
+    // a face without normal indices: the normals of the file are not used
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::app);
+        out << "f 2 3 4\n";
+    }
+    LoadParameters params;
+    params.useFileAttributes = true;
+    std::vector<point3d> vertices2;
+    std::vector<face> mesh2;
+    std::vector<vec3d> normals2;
+    BOOST_REQUIRE(load(filename, vertices2, mesh2, normals2, texcoords, bb, stats, params));
+    BOOST_CHECK(!stats.fileNormals);
+    BOOST_CHECK_EQUAL(vertices2.size(), 4);
+    BOOST_CHECK_CLOSE(normals2[0].z, 1.f, 0.0001f);
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_load_ply)
+{
+    // a square made of a triangle and a quad, ascii and binary (with x, y, z floats only, ie the
+    // direct copy, and with doubles, normals, an unused property and an unknown element)
+    const auto filename = (std::filesystem::temp_directory_path() / "test_load_ply.PLY").string();
+    const float coords[5][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0.5f, -1, 0}};
+
+    std::vector<std::string> files;
+    {
+        std::string ascii = "ply\nformat ascii 1.0\ncomment test\nelement vertex 5\nproperty float x\nproperty float y\nproperty float z\n"
+                            "element face 2\nproperty list uchar int vertex_indices\nend_header\n";
+        for(const auto& c : coords)
+            ascii += std::to_string(c[0]) + " " + std::to_string(c[1]) + " " + std::to_string(c[2]) + "\n";
+        ascii += "3 0 4 1\n4 0 1 2 3\n";
+        files.push_back(ascii);
+    }
+    for(const bool bigEndian : {false, true})
+    {
+        std::string binary = std::string("ply\nformat ") + (bigEndian ? "binary_big_endian" : "binary_little_endian")
+                             + " 1.0\nelement vertex 5\nproperty float x\nproperty float y\nproperty float z\n"
+                               "element face 2\nproperty list uchar int vertex_indices\nend_header\n";
+        for(const auto& c : coords)
+            for(const auto x : c)
+                writeBinary(binary, x, bigEndian);
+        for(const std::vector<std::int32_t>& f : {std::vector<std::int32_t>{0, 4, 1}, std::vector<std::int32_t>{0, 1, 2, 3}})
+        {
+            writeBinary(binary, static_cast<std::uint8_t>(f.size()), bigEndian);
+            for(const auto v : f)
+                writeBinary(binary, v, bigEndian);
+        }
+        files.push_back(binary);
+
+        std::string full = std::string("ply\nformat ") + (bigEndian ? "binary_big_endian" : "binary_little_endian")
+                           + " 1.0\nelement vertex 5\nproperty uchar flags\nproperty double x\nproperty double y\nproperty double z\n"
+                             "property float nx\nproperty float ny\nproperty float nz\n"
+                             "element material 1\nproperty list uchar float colors\n"
+                             "element face 2\nproperty list uint8 uint32 vertex_index\nproperty short tag\nend_header\n";
+        for(const auto& c : coords)
+        {
+            writeBinary(full, static_cast<std::uint8_t>(7), bigEndian);
+            for(const auto x : c)
+                writeBinary(full, static_cast<double>(x), bigEndian);
+            writeBinary(full, 0.f, bigEndian);
+            writeBinary(full, 0.f, bigEndian);
+            writeBinary(full, 2.f, bigEndian);
+        }
+        writeBinary(full, static_cast<std::uint8_t>(2), bigEndian);
+        writeBinary(full, 0.5f, bigEndian);
+        writeBinary(full, 0.25f, bigEndian);
+        for(const std::vector<std::uint32_t>& f : {std::vector<std::uint32_t>{0, 4, 1}, std::vector<std::uint32_t>{0, 1, 2, 3}})
+        {
+            writeBinary(full, static_cast<std::uint8_t>(f.size()), bigEndian);
+            for(const auto v : f)
+                writeBinary(full, v, bigEndian);
+            writeBinary(full, static_cast<std::int16_t>(-1), bigEndian);
+        }
+        files.push_back(full);
+    }
+
+    BOOST_CHECK(isPlyFile(filename));
+    BOOST_CHECK(!isPlyFile("model.obj"));
+    for(std::size_t k = 0; k < files.size(); ++k)
+    {
+        {
+            std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+            out << files[k];
+        }
+        LoadParameters params;
+        params.useFileAttributes = true;
+        std::vector<point3d> vertices;
+        std::vector<face> mesh;
+        std::vector<vec3d> normals;
+        std::vector<texcoord> texcoords;
+        BoundingBox bb;
+        LoadStatistics stats;
+        BOOST_REQUIRE(loadPly(filename, vertices, mesh, normals, texcoords, bb, stats, params));
+        BOOST_REQUIRE_EQUAL(vertices.size(), 5);
+        for(std::size_t i = 0; i < vertices.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL(vertices[i].x, coords[i][0]);
+            BOOST_CHECK_EQUAL(vertices[i].y, coords[i][1]);
+            BOOST_CHECK_EQUAL(vertices[i].z, coords[i][2]);
+        }
+        // the quad is split in two triangles
+        BOOST_REQUIRE_EQUAL(mesh.size(), 3);
+        BOOST_CHECK_EQUAL(mesh[0], face(0, 4, 1));
+        BOOST_CHECK_EQUAL(mesh[1], face(0, 1, 2));
+        BOOST_CHECK_EQUAL(mesh[2], face(0, 2, 3));
+        BOOST_CHECK_EQUAL(bb.pmin.y, -1.f);
+        BOOST_REQUIRE_EQUAL(normals.size(), 5);
+        BOOST_CHECK_CLOSE(normals[3].z, 1.f, 0.0001f);
+        // only the last files have normals
+        BOOST_CHECK_EQUAL(stats.fileNormals, (k % 2) == 0 && (k > 0));
+    }
+
+    // a truncated file
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << files[1].substr(0, files[1].size() - 2);
+    }
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    std::vector<vec3d> normals;
+    std::vector<texcoord> texcoords;
+    BoundingBox bb;
+    LoadStatistics stats;
+    BOOST_CHECK(!loadPly(filename, vertices, mesh, normals, texcoords, bb, stats));
+
+    // a count of vertices the file cannot hold is rejected before allocating them
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << "ply\nformat binary_little_endian 1.0\nelement vertex 4000000000\nproperty float x\nproperty float y\n"
+               "property float z\nproperty float nx\nproperty float ny\nproperty float nz\nend_header\n"
+            << std::string(48, '\0');
+    }
+    std::vector<point3d>().swap(vertices);
+    BOOST_CHECK(!loadPly(filename, vertices, mesh, normals, texcoords, bb, stats));
+    BOOST_CHECK_EQUAL(vertices.capacity(), 0);
+    std::remove(filename.c_str());
+}
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
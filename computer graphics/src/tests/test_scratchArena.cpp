@@ -0,0 +1,193 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <loop.hpp>
+#include <ScratchArena.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(test_scratchArena)
+
+BOOST_AUTO_TEST_CASE(test_arena_allocation)
+{
+    ScratchArena arena(1024);
+    BOOST_CHECK_EQUAL(arena.capacity(), 0);
+
+    auto* a = arena.allocate(100, 8);
+    auto* b = arena.allocate(10, 64);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(b) % 64, 0);
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), 1);
+    BOOST_CHECK_EQUAL(arena.capacity(), 1024);
+
+    // the last allocation is given back, the others only on reset
+    BOOST_CHECK(arena.allocate(16, 8) != nullptr);
+    const auto used = arena.used();
+    arena.deallocate(arena.allocate(200, 8), 200, 8);
+    BOOST_CHECK_EQUAL(arena.used(), used);
+    arena.deallocate(a, 100, 8);
+    BOOST_CHECK_EQUAL(arena.used(), used);
+
+    // a larger request needs a new block, the blocks are merged by the reset
+    BOOST_CHECK(arena.allocate(4096, 8) != nullptr);
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), 2);
+    arena.reset();
+    BOOST_CHECK_EQUAL(arena.used(), 0);
+    const auto capacity = arena.capacity();
+    BOOST_CHECK_GE(capacity, 1024 + 4096);
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), 3);
+
+    // then the same allocations do not need new blocks
+    BOOST_CHECK(arena.allocate(100, 8) != nullptr);
+    BOOST_CHECK(arena.allocate(4096, 8) != nullptr);
+    arena.reset();
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), 3);
+    BOOST_CHECK_EQUAL(arena.capacity(), capacity);
+    (void) b;
+
+    // it works with the std::pmr containers
+    std::pmr::vector<int> list({1, 2, 3}, &arena);
+    list.resize(1000, 4);
+    BOOST_CHECK_EQUAL(list[2], 3);
+    BOOST_CHECK_EQUAL(list.back(), 4);
+
+    arena.release();
+    BOOST_CHECK_EQUAL(arena.capacity(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_subdivision)
+{
+    // a tetrahedron subdivided twice
+    std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    std::vector<face> mesh{{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+    std::vector<vec3d> normals;
+    for(int level = 0; level < 2; ++level)
+    {
+        std::vector<point3d> destVert;
+        std::vector<face> destMesh;
+        loopSubdivision(vertices, mesh, destVert, destMesh, normals, 1);
+        vertices.swap(destVert);
+        mesh.swap(destMesh);
+    }
+
+    // the same result with the temporary data in an arena
+    ScratchArena arena(256);
+    std::vector<point3d> destVert;
+    std::vector<face> destMesh;
+    std::vector<vec3d> destNorm;
+    loopSubdivision(vertices, mesh, destVert, destMesh, destNorm, 2, &arena);
+    BOOST_CHECK_GT(arena.blockAllocations(), 1);
+
+    std::vector<point3d> expectedVert;
+    std::vector<face> expectedMesh;
+    std::vector<vec3d> expectedNorm;
+    loopSubdivision(vertices, mesh, expectedVert, expectedMesh, expectedNorm, 2);
+    BOOST_CHECK(destMesh == expectedMesh);
+    BOOST_REQUIRE_EQUAL(destVert.size(), expectedVert.size());
+    BOOST_CHECK_EQUAL(std::memcmp(destVert.data(), expectedVert.data(), destVert.size() * sizeof(point3d)), 0);
+    BOOST_CHECK_EQUAL(std::memcmp(destNorm.data(), expectedNorm.data(), destNorm.size() * sizeof(vec3d)), 0);
+
+    // subdividing again does not allocate any other block, and all the memory is given back
+    arena.reset();
+    const auto blocks = arena.blockAllocations();
+    loopSubdivision(vertices, mesh, destVert, destMesh, destNorm, 2, &arena);
+    BOOST_CHECK_EQUAL(arena.used(), 0);
+    arena.reset();
+    loopSubdivision(vertices, mesh, destVert, destMesh, destNorm, 2, &arena);
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), blocks);
+    BOOST_CHECK(destMesh == expectedMesh);
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_direct_subdivision)
+{
+    // a grid of 16 x 16 squares, subdivided three levels at once
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    const idxtype n{16};
+    for(idxtype i = 0; i <= n; ++i)
+    {
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), 0.f);
+    }
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype v = i * (n + 1) + j;
+            mesh.emplace_back(v, v + n + 1, v + 1);
+            mesh.emplace_back(v + 1, v + n + 1, v + n + 2);
+        }
+    }
+
+    std::vector<point3d> expectedVert;
+    std::vector<face> expectedMesh;
+    std::vector<vec3d> expectedNorm;
+    loopSubdivision(vertices, mesh, 3, expectedVert, expectedMesh, expectedNorm, 1);
+
+    // the buffers of the patches are taken from the arena too, so subdividing again allocates nothing
+    ScratchArena arena(256);
+    std::vector<point3d> destVert;
+    std::vector<face> destMesh;
+    std::vector<vec3d> destNorm;
+    BOOST_CHECK(loopSubdivision(vertices, mesh, 3, destVert, destMesh, destNorm, 1, &arena));
+    arena.reset();
+    const auto blocks = arena.blockAllocations();
+    BOOST_CHECK(loopSubdivision(vertices, mesh, 3, destVert, destMesh, destNorm, 1, &arena));
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), blocks);
+    BOOST_CHECK(destMesh == expectedMesh);
+    BOOST_REQUIRE_EQUAL(destVert.size(), expectedVert.size());
+    BOOST_CHECK_EQUAL(std::memcmp(destVert.data(), expectedVert.data(), destVert.size() * sizeof(point3d)), 0);
+
+    // a cancelled subdivision stops at once
+    const std::atomic<bool> cancel{true};
+    BOOST_CHECK(!loopSubdivision(vertices, mesh, 3, destVert, destMesh, destNorm, 1, &arena, &cancel));
+}
+
+BOOST_AUTO_TEST_CASE(test_arena_stencils)
+{
+    // a grid of 16 x 16 squares, whose stencils are built for two levels on several threads
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    const idxtype n{16};
+    for(idxtype i = 0; i <= n; ++i)
+    {
+        for(idxtype j = 0; j <= n; ++j)
+            vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), 0.f);
+    }
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype v = i * (n + 1) + j;
+            mesh.emplace_back(v, v + n + 1, v + 1);
+            mesh.emplace_back(v + 1, v + n + 1, v + n + 2);
+        }
+    }
+
+    // the intermediate meshes and the rows of the stencils are taken from the arena too, so building
+    // the stencils again allocates no other block
+    ScratchArena arena(256);
+    LoopStencils stencils;
+    stencils.build(vertices.size(), mesh, 2, 2, &arena);
+    arena.reset();
+    const auto blocks = arena.blockAllocations();
+    LoopStencils again;
+    again.build(vertices.size(), mesh, 2, 2, &arena);
+    BOOST_CHECK_EQUAL(arena.blockAllocations(), blocks);
+    BOOST_CHECK(again.mesh() == stencils.mesh());
+    BOOST_CHECK_EQUAL(again.numWeights(), stencils.numWeights());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,430 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <image.hpp>
+#include <Model.hpp>
+#include <SoftwareRasterizer.hpp>
+#include <ThreadPool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/// the size of the images rendered
+constexpr std::size_t IMAGE_SIZE{64};
+
+/**
+ * Count the pixels that are not the background
+ * @param[in] image the RGBA pixels
+ * @return the number of pixels drawn
+ */
+std::size_t coverage(const std::vector<unsigned char>& image)
+{
+    std::size_t count{0};
+    for(std::size_t i = 0; i < image.size(); i += 4)
+    {
+        if((image[i] != 128) || (image[i + 1] != 128) || (image[i + 2] != 191))
+            ++count;
+    }
+    return count;
+}
+
+/**
+ * Count the different colors of the pixels drawn
+ * @param[in] image the RGBA pixels
+ * @return the number of colors, the background excluded
+ */
+std::size_t countColors(const std::vector<unsigned char>& image)
+{
+    std::set<unsigned int> colors;
+    for(std::size_t i = 0; i < image.size(); i += 4)
+    {
+        colors.insert(image[i] | (image[i + 1] << 8u) | (image[i + 2] << 16u));
+    }
+    colors.erase(128u | (128u << 8u) | (191u << 16u));
+    return colors.size();
+}
+
+/**
+ * Return the color of a pixel
+ * @param[in] image the RGBA pixels
+ * @param[in] x the column
+ * @param[in] y the row, from the bottom
+ * @return the red, green and blue components
+ */
+std::vector<unsigned char> pixel(const std::vector<unsigned char>& image, std::size_t x, std::size_t y)
+{
+    const auto i = 4 * (y * IMAGE_SIZE + x);
+    return {image[i], image[i + 1], image[i + 2]};
+}
+
+/**
+ * Make the faces drawn with the ambient color of the material, without any lighting
+ * @param[in,out] rasterizer the renderer
+ */
+void unlit(SoftwareRasterizer& rasterizer)
+{
+    Light light;
+    light.sceneAmbient = v3f(1.f, 1.f, 1.f);
+    light.ambient = v3f(0.f, 0.f, 0.f);
+    light.diffuse = v3f(0.f, 0.f, 0.f);
+    light.specular = v3f(0.f, 0.f, 0.f);
+    rasterizer.setLight(light);
+}
+
+/**
+ * Set the color of the faces drawn without lighting, see unlit()
+ * @param[in,out] rasterizer the renderer
+ * @param[in] color the color
+ */
+void setColor(SoftwareRasterizer& rasterizer, const v3f& color)
+{
+    Material material;
+    material.ambient = color;
+    rasterizer.setMaterial(material);
+}
+
+/// a cube made of 12 triangles, with the normals of its vertices
+struct Cube
+{
+    std::vector<point3d> vertices{{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1},
+                                  {-1, -1, 1},  {1, -1, 1},  {1, 1, 1},  {-1, 1, 1}};
+    std::vector<face> mesh{{0, 2, 1}, {0, 3, 2}, {4, 5, 6}, {4, 6, 7}, {0, 1, 5}, {0, 5, 4},
+                           {2, 3, 7}, {2, 7, 6}, {1, 2, 6}, {1, 6, 5}, {0, 4, 7}, {0, 7, 3}};
+    std::vector<vec3d> normals{};
+
+    Cube()
+    {
+        for(const auto& v : vertices)
+        {
+            normals.push_back(v * (1.f / v.norm()));
+        }
+    }
+};
+
+/**
+ * Make a square in the plane z, facing the eye, made of a grid of triangles
+ * @param[in] size the half size of the square
+ * @param[in] z the depth of the square
+ * @param[in] cells the number of cells of the grid along each side
+ * @param[out] vertices the vertices
+ * @param[out] mesh the faces
+ */
+void makeSquare(float size, float z, std::size_t cells, std::vector<point3d>& vertices, std::vector<face>& mesh)
+{
+    vertices.clear();
+    mesh.clear();
+    // the sides of the square are the same whatever the number of cells
+    const auto coordinate = [size, cells](std::size_t i) { return -size + 2.f * size * static_cast<float>(i) / static_cast<float>(cells); };
+    for(std::size_t j = 0; j <= cells; ++j)
+    {
+        for(std::size_t i = 0; i <= cells; ++i)
+        {
+            vertices.emplace_back(coordinate(i), coordinate(j) + .0123f, z);
+        }
+    }
+    for(std::size_t j = 0; j < cells; ++j)
+    {
+        for(std::size_t i = 0; i < cells; ++i)
+        {
+            const auto v = static_cast<idxtype>(j * (cells + 1) + i);
+            const auto row = static_cast<idxtype>(cells + 1);
+            mesh.emplace_back(v, v + 1, v + row + 1);
+            mesh.emplace_back(v, v + row + 1, v + row);
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_softwareRasterizer)
+
+BOOST_AUTO_TEST_CASE(test_thread_pool)
+{
+    ThreadPool pool(4);
+    BOOST_CHECK_EQUAL(pool.size(), 4);
+
+    // each task is run once, batch after batch
+    for(const std::size_t numTasks : {0ul, 1ul, 3ul, 1000ul})
+    {
+        std::vector<std::atomic<int>> runs(numTasks);
+        pool.run(numTasks, [&runs](std::size_t task) { ++runs[task]; });
+        for(const auto& r : runs)
+        {
+            BOOST_CHECK_EQUAL(r.load(), 1);
+        }
+    }
+
+    // the exception of a task is rethrown once all the tasks have been run
+    std::atomic<int> count{0};
+    BOOST_CHECK_THROW(pool.run(100,
+                               [&count](std::size_t task) {
+                                   ++count;
+                                   if(task == 10)
+                                       throw std::runtime_error("failed");
+                               }),
+                      std::runtime_error);
+    BOOST_CHECK_EQUAL(count.load(), 100);
+
+    // and the pool is still usable
+    count = 0;
+    pool.run(10, [&count](std::size_t) { ++count; });
+    BOOST_CHECK_EQUAL(count.load(), 10);
+
+    ThreadPool single(1);
+    BOOST_CHECK_EQUAL(single.size(), 1);
+    count = 0;
+    single.run(10, [&count](std::size_t) { ++count; });
+    BOOST_CHECK_EQUAL(count.load(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_write_images)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto ppm = (directory / "test_softwareRasterizer.ppm").string();
+    const auto png = (directory / "test_softwareRasterizer.png").string();
+    const auto read = [](const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+
+    // 2x2 pixels, the bottom row first
+    const std::vector<unsigned char> rgba{1, 2, 3, 255, 4, 5, 6, 255, 7, 8, 9, 255, 10, 11, 12, 255};
+    BOOST_REQUIRE(writePpm(ppm, 2, 2, rgba));
+    BOOST_CHECK_EQUAL(read(ppm), (std::string("P6\n2 2\n255\n") + std::string{7, 8, 9, 10, 11, 12, 1, 2, 3, 4, 5, 6}));
+
+    BOOST_REQUIRE(writeImage(png, 2, 2, rgba));
+    const auto content = read(png);
+    // the signature, the header of 13 bytes, the data of 2 rows of 7 bytes in a single stored block and the end
+    BOOST_CHECK_EQUAL(content.substr(0, 8), "\x89PNG\r\n\x1a\n");
+    BOOST_CHECK_EQUAL(content.substr(12, 4), "IHDR");
+    BOOST_CHECK_EQUAL(content.size(), 8 + (12 + 13) + (12 + 2 + 5 + 14 + 4) + 12);
+    BOOST_CHECK_EQUAL(content.substr(content.size() - 8, 4), "IEND");
+    // the top row, after its filter
+    BOOST_CHECK_EQUAL(content.substr(8 + 25 + 8 + 2 + 5, 7), (std::string{0, 7, 8, 9, 10, 11, 12}));
+
+    // the size must match the pixels
+    BOOST_CHECK(!writePpm(ppm, 3, 2, rgba));
+    BOOST_CHECK(!writePng(png, 2, 3, rgba));
+    std::remove(ppm.c_str());
+    std::remove(png.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_rasterize_cube)
+{
+    SoftwareRasterizer rasterizer(IMAGE_SIZE, IMAGE_SIZE, 4);
+    BOOST_CHECK_EQUAL(rasterizer.width(), IMAGE_SIZE);
+    BOOST_CHECK_EQUAL(rasterizer.height(), IMAGE_SIZE);
+    BOOST_CHECK_EQUAL(coverage(rasterizer.image()), 0);
+    for(const auto d : rasterizer.depth())
+        BOOST_REQUIRE_EQUAL(d, 1.f);
+
+    Camera camera;
+    camera.angleX = 30.f;
+    camera.angleY = 40.f;
+    rasterizer.setCamera(camera);
+    const Cube cube;
+
+    // three sides are visible, with flat shading each triangle has a single color, lit at its last vertex
+    rasterizer.drawTriangles(cube.vertices, cube.mesh, cube.normals, {}, false);
+    const auto flat = rasterizer.image();
+    BOOST_CHECK_GT(coverage(flat), IMAGE_SIZE * IMAGE_SIZE / 10);
+    BOOST_CHECK_GE(countColors(flat), 3);
+    BOOST_CHECK_LE(countColors(flat), 6);
+    // the center is covered, in front of the far plane
+    BOOST_CHECK_LT(rasterizer.depth()[IMAGE_SIZE * IMAGE_SIZE / 2 + IMAGE_SIZE / 2], 1.f);
+    BOOST_CHECK_GT(rasterizer.depth()[IMAGE_SIZE * IMAGE_SIZE / 2 + IMAGE_SIZE / 2], 0.f);
+
+    // the colors are interpolated with smooth shading, on the same pixels
+    rasterizer.clear();
+    rasterizer.drawTriangles(cube.vertices, cube.mesh, cube.normals, {}, true);
+    const auto smooth = rasterizer.image();
+    BOOST_CHECK_EQUAL(coverage(smooth), coverage(flat));
+    BOOST_CHECK_GT(countColors(smooth), 6);
+
+    // the same image whatever the number of threads
+    SoftwareRasterizer single(IMAGE_SIZE, IMAGE_SIZE, 1);
+    single.setCamera(camera);
+    single.drawTriangles(cube.vertices, cube.mesh, cube.normals, {}, true);
+    BOOST_CHECK(single.image() == smooth);
+
+    // the back faces are culled: turned inside out only the far sides are visible
+    auto inverted = cube.mesh;
+    for(auto& f : inverted)
+        std::swap(f.v1, f.v2);
+    rasterizer.clear();
+    rasterizer.drawTriangles(cube.vertices, inverted, cube.normals, {}, false);
+    const auto inside = rasterizer.image();
+    BOOST_CHECK_EQUAL(coverage(inside), coverage(flat));
+    BOOST_CHECK(inside != flat);
+
+    // the wireframe alone covers less than the faces, with the normals over it
+    RenderingParameters params;
+    params.solid = false;
+    rasterizer.clear();
+    rasterizer.draw(cube.vertices, cube.mesh, cube.normals, params);
+    const auto wireframe = coverage(rasterizer.image());
+    BOOST_CHECK_GT(wireframe, 0);
+    BOOST_CHECK_LT(wireframe, coverage(flat));
+    rasterizer.drawNormalLines({{1, 1, 1}, {1.5f, 1.5f, 1.5f}});
+    BOOST_CHECK_GT(coverage(rasterizer.image()), wireframe);
+
+    // the wireframe is drawn over the faces
+    params.solid = true;
+    rasterizer.clear();
+    rasterizer.draw(cube.vertices, cube.mesh, cube.normals, params);
+    const auto solid = rasterizer.image();
+    BOOST_CHECK_GE(coverage(solid), coverage(flat));
+    BOOST_CHECK_GT(countColors(solid), countColors(flat));
+}
+
+BOOST_AUTO_TEST_CASE(test_depth_and_coverage)
+{
+    SoftwareRasterizer rasterizer(IMAGE_SIZE, IMAGE_SIZE, 3);
+    unlit(rasterizer);
+    std::vector<point3d> front, back, fine;
+    std::vector<face> frontMesh, backMesh, fineMesh;
+    makeSquare(1.f, .5f, 1, front, frontMesh);
+    makeSquare(1.5f, -.5f, 1, back, backMesh);
+
+    // the nearest face is visible whatever the order of the drawing
+    for(const bool frontFirst : {true, false})
+    {
+        rasterizer.clear();
+        for(const bool drawFront : {frontFirst, !frontFirst})
+        {
+            setColor(rasterizer, drawFront ? v3f(1.f, 0.f, 0.f) : v3f(0.f, 0.f, 1.f));
+            rasterizer.drawTriangles(drawFront ? front : back, drawFront ? frontMesh : backMesh, {}, {}, false);
+        }
+        const auto image = rasterizer.image();
+        BOOST_CHECK(pixel(image, IMAGE_SIZE / 2, IMAGE_SIZE / 2) == (std::vector<unsigned char>{255, 0, 0}));
+        BOOST_CHECK(pixel(image, IMAGE_SIZE / 2, IMAGE_SIZE / 5) == (std::vector<unsigned char>{0, 0, 255}));
+        BOOST_CHECK(pixel(image, 0, 0) == (std::vector<unsigned char>{128, 128, 191}));
+    }
+
+    // a square made of many triangles covers exactly the same pixels as two triangles: each pixel on a
+    // shared edge belongs to one of them
+    setColor(rasterizer, v3f(1.f, 1.f, 1.f));
+    rasterizer.clear();
+    rasterizer.drawTriangles(front, frontMesh, {}, {}, false);
+    const auto expected = rasterizer.image();
+    makeSquare(1.f, .5f, 13, fine, fineMesh);
+    rasterizer.clear();
+    rasterizer.drawTriangles(fine, fineMesh, {}, {}, false);
+    BOOST_CHECK(rasterizer.image() == expected);
+    BOOST_CHECK_EQUAL(countColors(expected), 1);
+
+    // seen from behind, the square is culled
+    for(auto& f : fineMesh)
+        std::swap(f.v1, f.v2);
+    rasterizer.clear();
+    rasterizer.drawTriangles(fine, fineMesh, {}, {}, false);
+    BOOST_CHECK_EQUAL(coverage(rasterizer.image()), 0);
+
+    // a large floor crossing the near plane is clipped: it covers the bottom of the image, not the top
+    Camera camera;
+    camera.distance = 0.f;
+    rasterizer.setCamera(camera);
+    const std::vector<point3d> floor{{-100, -1, -100}, {100, -1, -100}, {100, -1, 100}, {-100, -1, 100}};
+    const std::vector<face> floorMesh{{0, 3, 2}, {0, 2, 1}};
+    rasterizer.clear();
+    rasterizer.drawTriangles(floor, floorMesh, {}, {}, false);
+    const auto image = rasterizer.image();
+    BOOST_CHECK(pixel(image, 0, 0) == (std::vector<unsigned char>{255, 255, 255}));
+    BOOST_CHECK(pixel(image, IMAGE_SIZE - 1, 0) == (std::vector<unsigned char>{255, 255, 255}));
+    BOOST_CHECK(pixel(image, IMAGE_SIZE / 2, IMAGE_SIZE - 1) == (std::vector<unsigned char>{128, 128, 191}));
+}
+
+BOOST_AUTO_TEST_CASE(test_rasterize_lines)
+{
+    SoftwareRasterizer rasterizer(IMAGE_SIZE, IMAGE_SIZE, 2);
+    // a horizontal segment across the image, then a thicker one
+    const std::vector<point3d> segment{{-10, .1f, 0}, {10, .1f, 0}};
+    rasterizer.drawLines(segment, v3f(1.f, 0.f, 0.f), 1.f);
+    BOOST_CHECK_EQUAL(coverage(rasterizer.image()), IMAGE_SIZE);
+    rasterizer.clear();
+    rasterizer.drawLines(segment, v3f(1.f, 0.f, 0.f), 2.f);
+    BOOST_CHECK_EQUAL(coverage(rasterizer.image()), 2 * IMAGE_SIZE);
+
+    // hidden behind a face
+    unlit(rasterizer);
+    std::vector<point3d> square;
+    std::vector<face> mesh;
+    makeSquare(3.f, .5f, 1, square, mesh);
+    rasterizer.clear();
+    rasterizer.drawTriangles(square, mesh, {}, {}, false);
+    const auto covered = rasterizer.image();
+    rasterizer.drawLines(segment, v3f(1.f, 0.f, 0.f), 1.f);
+    BOOST_CHECK(rasterizer.image() == covered);
+
+    // and resized
+    rasterizer.resize(2 * IMAGE_SIZE, IMAGE_SIZE);
+    BOOST_CHECK_EQUAL(rasterizer.width(), 2 * IMAGE_SIZE);
+    rasterizer.drawLines(segment, v3f(1.f, 0.f, 0.f), 1.f);
+    BOOST_CHECK_EQUAL(coverage(rasterizer.image()), 2 * IMAGE_SIZE);
+    rasterizer.resize(0, SoftwareRasterizer::MAX_SIZE + 1);
+    BOOST_CHECK_EQUAL(rasterizer.width(), 1);
+    BOOST_CHECK_EQUAL(rasterizer.height(), SoftwareRasterizer::MAX_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(test_rasterize_subdivision)
+{
+    const auto filename = (std::filesystem::temp_directory_path() / "test_rasterize_subdivision.obj").string();
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << "v -1 -1 -1\nv 1 -1 -1\nv -1 1 -1\nv -1 -1 1\nf 1 3 2\nf 1 2 4\nf 2 3 4\nf 3 1 4\n";
+    }
+    LoadParameters loadParams;
+    loadParams.useCache = false;
+    Model model;
+    BOOST_REQUIRE(model.load(filename, loadParams));
+
+    SoftwareRasterizer rasterizer(IMAGE_SIZE, IMAGE_SIZE, 1);
+    Camera camera;
+    camera.angleX = 20.f;
+    camera.angleY = 30.f;
+    rasterizer.setCamera(camera);
+    RenderingParameters params;
+    params.smooth = true;
+    params.wireframe = false;
+    model.rasterize(rasterizer, params);
+    const auto original = rasterizer.image();
+
+    // the first rendering requests the level, which is displayed once computed
+    params.subdivision = true;
+    params.subdivLevel = 3;
+    rasterizer.clear();
+    model.rasterize(rasterizer, params);
+    model.waitSubdivision();
+    BOOST_CHECK(!model.subdividing());
+    BOOST_CHECK_EQUAL(model.subdivisionStatistics().levels, 3);
+    rasterizer.clear();
+    model.rasterize(rasterizer, params);
+    const auto subdivided = rasterizer.image();
+
+    // the subdivision shrinks the tetrahedron
+    BOOST_CHECK_GT(coverage(subdivided), 0);
+    BOOST_CHECK_LT(coverage(subdivided), coverage(original));
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
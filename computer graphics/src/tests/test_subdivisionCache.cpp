@@ -0,0 +1,147 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <SubdivisionCache.hpp>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+/// a level with the given number of vertices and no faces, ie 24 bytes per vertex
+std::shared_ptr<const SubdivisionLevel> makeLevel(std::size_t numVertices)
+{
+    auto level = std::make_shared<SubdivisionLevel>();
+    level->vertices.resize(numVertices);
+    level->normals.resize(numVertices);
+    return level;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(test_subdivisionCache)
+
+BOOST_AUTO_TEST_CASE(test_lru_eviction)
+{
+    SubdivisionCache cache(300);
+    BOOST_CHECK_EQUAL(makeLevel(10)->bytes(), 240);
+
+    BOOST_CHECK(cache.find(1) == nullptr);
+    cache.insert(1, makeLevel(4));
+    cache.insert(2, makeLevel(4));
+    cache.insert(3, makeLevel(4));
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 3);
+    BOOST_CHECK_EQUAL(cache.statistics().residentBytes, 3 * 96);
+
+    // level 1 becomes the most recently used, hence level 2 is evicted by the next insertion
+    const auto level1 = cache.find(1);
+    BOOST_REQUIRE(level1 != nullptr);
+    BOOST_CHECK_EQUAL(level1->vertices.size(), 4);
+    cache.insert(4, makeLevel(1));
+    BOOST_CHECK(cache.find(2) == nullptr);
+    BOOST_CHECK(cache.find(1) != nullptr);
+    BOOST_CHECK(cache.find(3) != nullptr);
+    BOOST_CHECK(cache.find(4) != nullptr);
+    BOOST_CHECK_EQUAL(cache.statistics().hits, 4);
+    BOOST_CHECK_EQUAL(cache.statistics().misses, 2);
+    BOOST_CHECK_EQUAL(cache.statistics().evictions, 1);
+    BOOST_CHECK_EQUAL(cache.statistics().residentBytes, 2 * 96 + 24);
+
+    // replacing a level does not count it twice
+    cache.insert(4, makeLevel(2));
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 3);
+    BOOST_CHECK_EQUAL(cache.statistics().residentBytes, 2 * 96 + 48);
+
+    // a smaller budget evicts the least recently used levels (1, then 3)
+    cache.setBudget(100);
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 1);
+    BOOST_CHECK(cache.find(4) != nullptr);
+
+    // a level larger than the budget is not kept and does not evict the others, but it stays valid for its owner
+    auto large = makeLevel(100);
+    const auto evictions = cache.statistics().evictions;
+    cache.insert(2, large);
+    BOOST_CHECK(cache.find(2) == nullptr);
+    BOOST_CHECK(cache.find(4) != nullptr);
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 1);
+    BOOST_CHECK_EQUAL(cache.statistics().evictions, evictions);
+    BOOST_CHECK_EQUAL(large->vertices.size(), 100);
+    BOOST_CHECK_LE(cache.statistics().residentBytes, cache.budget());
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 0);
+    BOOST_CHECK_EQUAL(cache.statistics().residentBytes, 0);
+    BOOST_CHECK_GT(cache.statistics().hits, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_closest_below)
+{
+    SubdivisionCache cache;
+    unsigned short found{7};
+    BOOST_CHECK(cache.closestBelow(3, found) == nullptr);
+    BOOST_CHECK_EQUAL(found, 0);
+
+    cache.insert(1, makeLevel(1));
+    cache.insert(4, makeLevel(4));
+    cache.insert(2, makeLevel(2));
+    const auto closest = cache.closestBelow(4, found);
+    BOOST_CHECK_EQUAL(found, 2);
+    BOOST_REQUIRE(closest != nullptr);
+    BOOST_CHECK_EQUAL(closest->vertices.size(), 2);
+    BOOST_CHECK(cache.closestBelow(1, found) == nullptr);
+    BOOST_CHECK_EQUAL(found, 0);
+    // it does not count as a hit or a miss
+    BOOST_CHECK_EQUAL(cache.statistics().hits + cache.statistics().misses, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_update)
+{
+    SubdivisionCache cache;
+    cache.insert(3, makeLevel(3));
+    cache.insert(1, makeLevel(1));
+    cache.insert(2, makeLevel(2));
+
+    // the levels are given by increasing level, level 2 grows and level 3 is removed
+    std::vector<unsigned short> seen;
+    cache.update([&seen](unsigned short level, const std::shared_ptr<const SubdivisionLevel>& data) {
+        seen.push_back(level);
+        BOOST_CHECK_EQUAL(data->vertices.size(), level);
+        return (level == 3) ? nullptr : makeLevel(level == 2 ? 5 : 1);
+    });
+    BOOST_CHECK((seen == std::vector<unsigned short>{1, 2, 3}));
+    BOOST_CHECK_EQUAL(cache.statistics().levels, 2);
+    BOOST_CHECK_EQUAL(cache.statistics().residentBytes, 6 * 24);
+    BOOST_CHECK_EQUAL(cache.statistics().hits + cache.statistics().misses, 0);
+
+    // the order of use is kept: level 1 is the least recently used
+    cache.setBudget(5 * 24);
+    BOOST_CHECK(cache.find(1) == nullptr);
+    const auto level2 = cache.find(2);
+    BOOST_REQUIRE(level2 != nullptr);
+    BOOST_CHECK_EQUAL(level2->vertices.size(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_subdivided_bytes)
+{
+    // a tetrahedron: 4 vertices and 4 faces, then 10 and 16, then 34 and 64
+    SubdivisionLevel tetrahedron;
+    tetrahedron.vertices.resize(4);
+    tetrahedron.mesh.resize(4);
+    BOOST_CHECK_EQUAL(tetrahedron.subdividedBytes(1), 16 * sizeof(face) + 10 * (sizeof(point3d) + sizeof(vec3d)));
+    BOOST_CHECK_EQUAL(tetrahedron.subdividedBytes(2), 64 * sizeof(face) + 34 * (sizeof(point3d) + sizeof(vec3d)));
+    // it saturates instead of overflowing
+    BOOST_CHECK_EQUAL(tetrahedron.subdividedBytes(40), std::numeric_limits<std::size_t>::max());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,165 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <loop.hpp>
+#include <SubdivisionWorker.hpp>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// a tetrahedron
+std::shared_ptr<const SubdivisionLevel> makeTetrahedron()
+{
+    auto level = std::make_shared<SubdivisionLevel>();
+    level->vertices = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    level->mesh = {{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}};
+    return level;
+}
+
+/**
+ * Return a grid of n x n squares, each split in two triangles
+ * @param[in] n the number of squares on each side
+ * @return the grid
+ */
+std::shared_ptr<const SubdivisionLevel> makeGrid(idxtype n)
+{
+    auto level = std::make_shared<SubdivisionLevel>();
+    for(idxtype i = 0; i <= n; ++i)
+        for(idxtype j = 0; j <= n; ++j)
+            level->vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), 0.f);
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const idxtype a = i * (n + 1) + j;
+            level->mesh.emplace_back(a, a + 1, a + n + 2);
+            level->mesh.emplace_back(a, a + n + 2, a + n + 1);
+        }
+    }
+    return level;
+}
+
+/**
+ * Poll the worker until the last request is complete
+ * @param[in,out] worker the worker
+ * @return all the levels taken
+ */
+std::vector<SubdivisionWorker::Result> waitAndTake(SubdivisionWorker& worker)
+{
+    std::vector<SubdivisionWorker::Result> results;
+    while(worker.busy())
+    {
+        for(auto& r : worker.take())
+            results.push_back(std::move(r));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return results;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(test_subdivisionWorker)
+
+BOOST_AUTO_TEST_CASE(test_background_subdivision)
+{
+    const auto tetrahedron = makeTetrahedron();
+    SubdivisionWorker worker;
+    BOOST_CHECK(!worker.busy());
+    BOOST_CHECK(worker.take().empty());
+    BOOST_CHECK_EQUAL(worker.progress().targetLevel, 0);
+
+    worker.request(2, 0, tetrahedron, 1);
+    const auto results = waitAndTake(worker);
+    BOOST_REQUIRE_EQUAL(results.size(), 2);
+    BOOST_CHECK_EQUAL(results[0].first, 1);
+    BOOST_CHECK_EQUAL(results[1].first, 2);
+
+    // the same levels as the subdivision in the calling thread
+    SubdivisionLevel level1, level2;
+    loopSubdivision(tetrahedron->vertices, tetrahedron->mesh, level1.vertices, level1.mesh, level1.normals, 1);
+    loopSubdivision(level1.vertices, level1.mesh, level2.vertices, level2.mesh, level2.normals, 1);
+    BOOST_CHECK(results[0].second->mesh == level1.mesh);
+    BOOST_CHECK(results[1].second->mesh == level2.mesh);
+    BOOST_REQUIRE_EQUAL(results[1].second->vertices.size(), level2.vertices.size());
+    BOOST_CHECK_EQUAL(results[1].second->vertices.back().x, level2.vertices.back().x);
+
+    // start from an intermediate level
+    worker.request(3, 2, results[1].second, 1);
+    const auto next = waitAndTake(worker);
+    BOOST_REQUIRE_EQUAL(next.size(), 1);
+    BOOST_CHECK_EQUAL(next[0].first, 3);
+    BOOST_CHECK_EQUAL(next[0].second->mesh.size(), 4 * level2.mesh.size());
+
+    // a direct request gives only the requested level
+    worker.request(3, 0, tetrahedron, 1, true);
+    const auto direct = waitAndTake(worker);
+    BOOST_REQUIRE_EQUAL(direct.size(), 1);
+    BOOST_CHECK_EQUAL(direct[0].first, 3);
+    BOOST_CHECK_EQUAL(direct[0].second->mesh.size(), next[0].second->mesh.size());
+    BOOST_CHECK_EQUAL(direct[0].second->vertices.size(), next[0].second->vertices.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_subdivision)
+{
+    const auto tetrahedron = makeTetrahedron();
+    SubdivisionWorker worker;
+
+    // a newer request cancels the previous one, whose levels are discarded
+    worker.request(8, 0, tetrahedron);
+    worker.request(1, 0, tetrahedron);
+    const auto results = waitAndTake(worker);
+    BOOST_REQUIRE_EQUAL(results.size(), 1);
+    BOOST_CHECK_EQUAL(results[0].first, 1);
+
+    worker.request(8, 0, tetrahedron);
+    worker.cancel();
+    BOOST_CHECK(!worker.busy());
+    BOOST_CHECK(worker.take().empty());
+
+    // the destructor cancels a long subdivision without waiting for the level being computed,
+    // eg when the model is replaced by the thread running the render loop
+    auto other = std::make_unique<SubdivisionWorker>();
+    other->request(3, 0, makeGrid(300), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto begin = std::chrono::steady_clock::now();
+    other.reset();
+    BOOST_CHECK_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(), .05);
+}
+
+BOOST_AUTO_TEST_CASE(test_cancel_direct_subdivision)
+{
+    const auto grid = makeGrid(300);
+    SubdivisionWorker worker;
+
+    // a direct request stops between two patches, so a newer one does not wait for the whole level
+    worker.request(3, 0, grid, 1, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    worker.request(1, 0, makeTetrahedron(), 1, true);
+    const auto results = waitAndTake(worker);
+    BOOST_REQUIRE_EQUAL(results.size(), 1);
+    BOOST_CHECK_EQUAL(results[0].first, 1);
+    BOOST_CHECK_EQUAL(results[0].second->mesh.size(), 16);
+
+    // and neither does the destructor
+    auto other = std::make_unique<SubdivisionWorker>();
+    other->request(3, 0, grid, 1, true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto begin = std::chrono::steady_clock::now();
+    other.reset();
+    BOOST_CHECK_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(), .05);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#define BOOST_TEST_MODULE testRenderer
+
+#ifndef BOOST_TEST_DYN_LINK
+#define BOOST_TEST_DYN_LINK
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <core.hpp>
+#include <weld.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(test_weld)
+
+BOOST_AUTO_TEST_CASE(test_weld_square)
+{
+    // a square made of two triangles that do not share their vertices, one of them slightly moved
+    std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 0, 0}, {1, 1.00001f, 0}, {0, 1, 0}};
+    std::vector<face> mesh{{0, 1, 2}, {3, 4, 5}};
+
+    auto exact = vertices;
+    auto exactMesh = mesh;
+    const auto exactStats = weldVertices(exact, exactMesh, 0.f);
+    BOOST_CHECK_EQUAL(exactStats.mergedVertices, 1);
+    BOOST_CHECK_EQUAL(exact.size(), 5);
+    BOOST_CHECK_EQUAL(exactMesh[1], face(0, 3, 4));
+
+    const auto stats = weldVertices(vertices, mesh, 0.001f);
+    BOOST_CHECK_EQUAL(stats.mergedVertices, 2);
+    BOOST_CHECK_EQUAL(stats.removedFaces, 0);
+    BOOST_REQUIRE_EQUAL(vertices.size(), 4);
+    // the first vertex of each group is kept
+    BOOST_CHECK_EQUAL(vertices[2].y, 1.f);
+    BOOST_CHECK_EQUAL(vertices[3].y, 1.f);
+    BOOST_REQUIRE_EQUAL(mesh.size(), 2);
+    BOOST_CHECK_EQUAL(mesh[0], face(0, 1, 2));
+    BOOST_CHECK_EQUAL(mesh[1], face(0, 2, 3));
+}
+
+BOOST_AUTO_TEST_CASE(test_weld_degenerate)
+{
+    // the second triangle collapses on an edge
+    std::vector<point3d> vertices{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 0.0001f, 0}};
+    std::vector<face> mesh{{0, 1, 2}, {0, 1, 3}, {3, 2, 0}};
+    const auto stats = weldVertices(vertices, mesh, 0.01f);
+    BOOST_CHECK_EQUAL(stats.mergedVertices, 1);
+    BOOST_CHECK_EQUAL(stats.removedFaces, 1);
+    BOOST_REQUIRE_EQUAL(mesh.size(), 2);
+    BOOST_CHECK_EQUAL(mesh[1], face(1, 2, 0));
+}
+
+BOOST_AUTO_TEST_CASE(test_weld_grid)
+{
+    // a grid whose quads have their own 4 vertices, the result must not depend on the number of threads
+    const idxtype n{150};
+    std::vector<point3d> vertices;
+    std::vector<face> mesh;
+    for(idxtype i = 0; i < n; ++i)
+    {
+        for(idxtype j = 0; j < n; ++j)
+        {
+            const auto v = static_cast<idxtype>(vertices.size());
+            const auto x = static_cast<float>(i) * 0.1f;
+            const auto y = static_cast<float>(j) * 0.1f;
+            vertices.emplace_back(x, y, 0.f);
+            vertices.emplace_back(x + 0.1f, y, 0.f);
+            vertices.emplace_back(x + 0.1f, y + 0.1f, 0.f);
+            vertices.emplace_back(x, y + 0.1f, 0.f);
+            mesh.emplace_back(v, v + 1, v + 2);
+            mesh.emplace_back(v, v + 2, v + 3);
+        }
+    }
+
+    auto vertices1 = vertices;
+    auto mesh1 = mesh;
+    const auto stats1 = weldVertices(vertices1, mesh1, 0.001f, 1);
+    const auto stats4 = weldVertices(vertices, mesh, 0.001f, 4);
+    BOOST_CHECK_EQUAL(vertices.size(), (n + 1) * (n + 1));
+    BOOST_CHECK_EQUAL(stats4.mergedVertices, 4 * n * n - (n + 1) * (n + 1));
+    BOOST_CHECK_EQUAL(stats1.mergedVertices, stats4.mergedVertices);
+    BOOST_CHECK(mesh1 == mesh);
+    BOOST_REQUIRE_EQUAL(vertices1.size(), vertices.size());
+    for(std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(vertices1[i].x, vertices[i].x);
+        BOOST_REQUIRE_EQUAL(vertices1[i].y, vertices[i].y);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
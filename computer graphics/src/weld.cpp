@@ -0,0 +1,234 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "weld.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace
+{
+
+/// the smallest cell size, relative to the size of the model, to keep the cell coordinates in range
+constexpr double MIN_RELATIVE_CELL{1e-9};
+/// the size of the cells wrt epsilon: with larger cells the neighborhood of a vertex spans the
+/// adjacent cells less often, hence fewer cells are visited
+constexpr double CELL_EPSILONS{4};
+
+/**
+ * A uniform grid whose cells are stored in a hash table: the vertices are bucketed by the hash
+ * of the coordinates of their cell, different cells may share the same bucket.
+ */
+class SpatialHashGrid
+{
+public:
+    /**
+     * Build the grid
+     * @param[in] vertices the vertices
+     * @param[in] cellSize the size of the cells
+     * @param[in] origin the origin of the grid
+     * @param[in] threads the number of threads to use
+     */
+    SpatialHashGrid(const std::vector<point3d>& vertices, double cellSize, const point3d& origin, unsigned int threads)
+        : _cellSize(cellSize), _origin(origin)
+    {
+        std::size_t numBuckets{1};
+        while(numBuckets < 2 * vertices.size())
+            numBuckets <<= 1u;
+        _mask = numBuckets - 1;
+
+        // counting sort of the vertices by bucket, each bucket lists its vertices in increasing order
+        std::vector<std::size_t> bucket(vertices.size());
+        parallelFor(
+            vertices.size(),
+            [&](std::size_t i) {
+                std::int64_t c[3];
+                cell(vertices[i], c);
+                bucket[i] = bucketOf(c[0], c[1], c[2]);
+            },
+            threads);
+        _offsets.assign(numBuckets + 1, 0);
+        for(const auto b : bucket)
+            ++_offsets[b + 1];
+        for(std::size_t b = 0; b < numBuckets; ++b)
+            _offsets[b + 1] += _offsets[b];
+        _vertices.resize(vertices.size());
+        auto next = _offsets;
+        for(std::size_t i = 0; i < vertices.size(); ++i)
+            _vertices[next[bucket[i]]++] = static_cast<idxtype>(i);
+    }
+
+    /**
+     * Compute the coordinates of the cell containing a point
+     * @param[in] p the point
+     * @param[out] c the coordinates of the cell
+     */
+    void cell(const point3d& p, std::int64_t c[3]) const
+    {
+        double local[3];
+        cell(p, c, local);
+    }
+
+    /**
+     * Compute the coordinates of the cell containing a point and the position of the point in the cell
+     * @param[in] p the point
+     * @param[out] c the coordinates of the cell
+     * @param[out] local the position of the point relative to the corner of the cell, in [0, cell size)
+     */
+    void cell(const point3d& p, std::int64_t c[3], double local[3]) const
+    {
+        const double coords[3] = {static_cast<double>(p.x) - static_cast<double>(_origin.x),
+                                  static_cast<double>(p.y) - static_cast<double>(_origin.y),
+                                  static_cast<double>(p.z) - static_cast<double>(_origin.z)};
+        for(std::size_t k = 0; k < 3; ++k)
+        {
+            const auto cellCoord = std::floor(coords[k] / _cellSize);
+            c[k] = static_cast<std::int64_t>(cellCoord);
+            local[k] = coords[k] - cellCoord * _cellSize;
+        }
+    }
+
+    /**
+     * Return the size of the cells
+     * @return the size of the cells
+     */
+    [[nodiscard]] double cellSize() const { return _cellSize; }
+
+    /**
+     * Return the bucket of a cell
+     * @param[in] x the first coordinate of the cell
+     * @param[in] y the second coordinate of the cell
+     * @param[in] z the third coordinate of the cell
+     * @return the bucket
+     */
+    [[nodiscard]] std::size_t bucketOf(std::int64_t x, std::int64_t y, std::int64_t z) const
+    {
+        auto h = mix64(static_cast<std::uint64_t>(x));
+        h = mix64(h ^ static_cast<std::uint64_t>(y));
+        h = mix64(h ^ static_cast<std::uint64_t>(z));
+        return static_cast<std::size_t>(h) & _mask;
+    }
+
+    /**
+     * Call fn(v) for each vertex v in the given bucket, in increasing order
+     * @param[in] b the bucket
+     * @param[in] fn the function
+     */
+    template <typename Function>
+    void forEach(std::size_t b, Function&& fn) const
+    {
+        for(auto k = _offsets[b]; k < _offsets[b + 1]; ++k)
+            fn(_vertices[k]);
+    }
+
+private:
+    /// the size of the cells
+    double _cellSize{1};
+    /// the origin of the grid
+    point3d _origin{};
+    /// the number of buckets minus one (it is a power of 2)
+    std::size_t _mask{0};
+    /// the first vertex of each bucket in _vertices
+    std::vector<std::size_t> _offsets{};
+    /// the vertices sorted by bucket
+    std::vector<idxtype> _vertices{};
+};
+
+}  // namespace
+
+WeldStatistics weldVertices(std::vector<point3d>& vertices, std::vector<face>& mesh, float epsilon, unsigned int threads)
+{
+    WeldStatistics stats;
+    if(vertices.empty())
+        return stats;
+
+    // the cells must not be too small wrt the size of the model, or their coordinates would overflow
+    point3d pmin = vertices[0];
+    point3d pmax = vertices[0];
+    for(const auto& p : vertices)
+    {
+        pmin.min(p);
+        pmax.max(p);
+    }
+    const auto extent = static_cast<double>((pmax - pmin).max());
+    const auto cellSize = std::max({CELL_EPSILONS * static_cast<double>(epsilon), extent * MIN_RELATIVE_CELL,
+                                    static_cast<double>(std::numeric_limits<float>::min())});
+    const SpatialHashGrid grid(vertices, cellSize, pmin, threads);
+
+    // the first vertex within epsilon from each vertex, looking in its cell and in the adjacent
+    // cells closer than epsilon (only along the axes where the vertex is near the border)
+    const auto epsilon2 = static_cast<double>(epsilon) * static_cast<double>(epsilon);
+    const auto range = [&](double local, std::int64_t& from, std::int64_t& to) {
+        from = (local <= static_cast<double>(epsilon)) ? -1 : 0;
+        to = (local >= grid.cellSize() - static_cast<double>(epsilon)) ? 1 : 0;
+    };
+    std::vector<idxtype> representative(vertices.size());
+    parallelFor(
+        vertices.size(),
+        [&](std::size_t i) {
+            const auto& p = vertices[i];
+            auto first = static_cast<idxtype>(i);
+            std::int64_t c[3];
+            double local[3];
+            grid.cell(p, c, local);
+            std::int64_t from[3];
+            std::int64_t to[3];
+            for(std::size_t k = 0; k < 3; ++k)
+                range(local[k], from[k], to[k]);
+            for(auto dx = from[0]; dx <= to[0]; ++dx)
+                for(auto dy = from[1]; dy <= to[1]; ++dy)
+                    for(auto dz = from[2]; dz <= to[2]; ++dz)
+                    {
+                        grid.forEach(grid.bucketOf(c[0] + dx, c[1] + dy, c[2] + dz), [&](idxtype j) {
+                            if(j >= first)
+                                return;
+                            const auto ddx = static_cast<double>(vertices[j].x) - static_cast<double>(p.x);
+                            const auto ddy = static_cast<double>(vertices[j].y) - static_cast<double>(p.y);
+                            const auto ddz = static_cast<double>(vertices[j].z) - static_cast<double>(p.z);
+                            if(ddx * ddx + ddy * ddy + ddz * ddz <= epsilon2)
+                                first = j;
+                        });
+                    }
+            representative[i] = first;
+        },
+        threads);
+
+    // follow the chains (the representative always comes first) and compact the remaining vertices
+    std::vector<idxtype> newIndex(vertices.size());
+    idxtype numVertices{0};
+    for(std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        if(representative[i] == i)
+        {
+            vertices[numVertices] = vertices[i];
+            newIndex[i] = numVertices++;
+        }
+        else
+        {
+            representative[i] = representative[representative[i]];
+            newIndex[i] = newIndex[representative[i]];
+        }
+    }
+    stats.mergedVertices = vertices.size() - numVertices;
+    vertices.resize(numVertices);
+
+    // remap the faces and remove the degenerate ones
+    parallelFor(
+        mesh.size(),
+        [&](std::size_t f) {
+            auto& t = mesh[f];
+            t = face(newIndex[t.v1], newIndex[t.v2], newIndex[t.v3]);
+        },
+        threads);
+    const auto numFaces = mesh.size();
+    mesh.erase(std::remove_if(mesh.begin(), mesh.end(), [](const face& t) { return (t.v1 == t.v2) || (t.v2 == t.v3) || (t.v3 == t.v1); }),
+               mesh.end());
+    stats.removedFaces = numFaces - mesh.size();
+    return stats;
+}
@@ -0,0 +1,42 @@
+/**
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "core.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Some statistics about the welding of the vertices of a model
+ */
+struct WeldStatistics
+{
+    /// number of vertices merged into another one, ie removed
+    std::size_t mergedVertices{0};
+    /// number of faces removed because degenerate after the merge (ie with two equal indices)
+    std::size_t removedFaces{0};
+
+    WeldStatistics() = default;
+};
+
+/**
+ * Merge the vertices that are closer than epsilon, eg the duplicated vertices along the seams of
+ * a model made of separate parts. Each vertex is merged into the first vertex (in the order of the
+ * list) within epsilon from it, following the chain if that vertex has been merged in turn. The
+ * vertices are looked up in a spatial hash grid with cells a few times epsilon, hence it takes linear
+ * expected time; the search of the neighbors and the remapping of the faces run in parallel.
+ * The order of the remaining vertices and faces is preserved.
+ *
+ * @param[in,out] vertices the list of vertices
+ * @param[in,out] mesh the list of faces, remapped to the remaining vertices, without the degenerate ones
+ * @param[in] epsilon the maximum distance between two merged vertices, 0 merges only the vertices
+ * with the same coordinates
+ * @param[in] threads the number of threads to use, 0 means as many as the hardware threads
+ * @return the number of merged vertices and of removed faces
+ */
+WeldStatistics weldVertices(std::vector<point3d>& vertices, std::vector<face>& mesh, float epsilon, unsigned int threads = 0);